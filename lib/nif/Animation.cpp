@@ -108,25 +108,21 @@ void NiBSplineData::Get(NiStream& stream) {
 
 	stream >> numFloatControlPoints;
 	floatControlPoints.resize(numFloatControlPoints);
-	for (int i = 0; i < numFloatControlPoints; i++)
-		stream >> floatControlPoints[i];
+	stream.readArray(floatControlPoints.data(), numFloatControlPoints);
 
 	stream >> numShortControlPoints;
 	shortControlPoints.resize(numShortControlPoints);
-	for (int i = 0; i < numShortControlPoints; i++)
-		stream >> shortControlPoints[i];
+	stream.readArray(shortControlPoints.data(), numShortControlPoints);
 }
 
 void NiBSplineData::Put(NiStream& stream) {
 	NiObject::Put(stream);
 
 	stream << numFloatControlPoints;
-	for (int i = 0; i < numFloatControlPoints; i++)
-		stream << floatControlPoints[i];
+	stream.writeArray(floatControlPoints.data(), numFloatControlPoints);
 
 	stream << numShortControlPoints;
-	for (int i = 0; i < numShortControlPoints; i++)
-		stream << shortControlPoints[i];
+	stream.writeArray(shortControlPoints.data(), numShortControlPoints);
 }
 
 
@@ -167,8 +163,8 @@ void NiTimeController::Put(NiStream& stream) {
 	targetRef.Put(stream);
 }
 
-void NiTimeController::GetChildRefs(std::set<Ref*>& refs) {
-	NiObject::GetChildRefs(refs);
+void NiTimeController::VisitChildRefs(RefSink<Ref>& refs) {
+	NiObject::VisitChildRefs(refs);
 
 	refs.insert(&nextControllerRef);
 }
@@ -179,8 +175,8 @@ void NiTimeController::GetChildIndices(std::vector<int>& indices) {
 	indices.push_back(nextControllerRef.GetIndex());
 }
 
-void NiTimeController::GetPtrs(std::set<Ref*>& ptrs) {
-	NiObject::GetPtrs(ptrs);
+void NiTimeController::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiObject::VisitPtrs(ptrs);
 
 	ptrs.insert(&targetRef);
 }
@@ -200,8 +196,8 @@ void NiLookAtController::Put(NiStream& stream) {
 	lookAtNodePtr.Put(stream);
 }
 
-void NiLookAtController::GetPtrs(std::set<Ref*>& ptrs) {
-	NiTimeController::GetPtrs(ptrs);
+void NiLookAtController::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiTimeController::VisitPtrs(ptrs);
 
 	ptrs.insert(&lookAtNodePtr);
 }
@@ -231,8 +227,8 @@ void NiPathController::Put(NiStream& stream) {
 	floatDataRef.Put(stream);
 }
 
-void NiPathController::GetChildRefs(std::set<Ref*>& refs) {
-	NiTimeController::GetChildRefs(refs);
+void NiPathController::VisitChildRefs(RefSink<Ref>& refs) {
+	NiTimeController::VisitChildRefs(refs);
 
 	refs.insert(&posDataRef);
 	refs.insert(&floatDataRef);
@@ -279,8 +275,8 @@ void NiUVController::Put(NiStream& stream) {
 	dataRef.Put(stream);
 }
 
-void NiUVController::GetChildRefs(std::set<Ref*>& refs) {
-	NiTimeController::GetChildRefs(refs);
+void NiUVController::VisitChildRefs(RefSink<Ref>& refs) {
+	NiTimeController::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -304,8 +300,8 @@ void BSFrustumFOVController::Put(NiStream& stream) {
 	interpolatorRef.Put(stream);
 }
 
-void BSFrustumFOVController::GetChildRefs(std::set<Ref*>& refs) {
-	NiTimeController::GetChildRefs(refs);
+void BSFrustumFOVController::VisitChildRefs(RefSink<Ref>& refs) {
+	NiTimeController::VisitChildRefs(refs);
 
 	refs.insert(&interpolatorRef);
 }
@@ -394,8 +390,8 @@ void BSProceduralLightningController::Put(NiStream& stream) {
 	shaderPropertyRef.Put(stream);
 }
 
-void BSProceduralLightningController::GetChildRefs(std::set<Ref*>& refs) {
-	NiTimeController::GetChildRefs(refs);
+void BSProceduralLightningController::VisitChildRefs(RefSink<Ref>& refs) {
+	NiTimeController::VisitChildRefs(refs);
 
 	refs.insert(&generationInterpRef);
 	refs.insert(&mutationInterpRef);
@@ -448,8 +444,8 @@ void NiBoneLODController::Put(NiStream& stream) {
 		boneArrays[i].Put(stream);
 }
 
-void NiBoneLODController::GetPtrs(std::set<Ref*>& ptrs) {
-	NiTimeController::GetPtrs(ptrs);
+void NiBoneLODController::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiTimeController::VisitPtrs(ptrs);
 
 	for (int i = 0; i < boneArraysSize; i++)
 		boneArrays[i].GetIndexPtrs(ptrs);
@@ -479,11 +475,11 @@ void NiMorphData::Put(NiStream& stream) {
 		morphs[i].Put(stream, numVertices);
 }
 
-void NiMorphData::GetStringRefs(std::set<StringRef*>& refs) {
-	NiObject::GetStringRefs(refs);
+void NiMorphData::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiObject::VisitStringRefs(refs);
 
 	for (auto &m : morphs)
-		m.GetStringRefs(refs);
+		m.VisitStringRefs(refs);
 }
 
 
@@ -512,13 +508,13 @@ void NiGeomMorpherController::Put(NiStream& stream) {
 		interpWeights[i].Put(stream);
 }
 
-void NiGeomMorpherController::GetChildRefs(std::set<Ref*>& refs) {
-	NiInterpController::GetChildRefs(refs);
+void NiGeomMorpherController::VisitChildRefs(RefSink<Ref>& refs) {
+	NiInterpController::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 
 	for (auto &m : interpWeights)
-		m.GetChildRefs(refs);
+		m.VisitChildRefs(refs);
 }
 
 void NiGeomMorpherController::GetChildIndices(std::vector<int>& indices) {
@@ -545,8 +541,8 @@ void NiSingleInterpController::Put(NiStream& stream) {
 		interpolatorRef.Put(stream);
 }
 
-void NiSingleInterpController::GetChildRefs(std::set<Ref*>& refs) {
-	NiInterpController::GetChildRefs(refs);
+void NiSingleInterpController::VisitChildRefs(RefSink<Ref>& refs) {
+	NiInterpController::VisitChildRefs(refs);
 
 	refs.insert(&interpolatorRef);
 }
@@ -570,8 +566,8 @@ void NiRollController::Put(NiStream& stream) {
 	dataRef.Put(stream);
 }
 
-void NiRollController::GetChildRefs(std::set<Ref*>& refs) {
-	NiSingleInterpController::GetChildRefs(refs);
+void NiRollController::VisitChildRefs(RefSink<Ref>& refs) {
+	NiSingleInterpController::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -608,8 +604,8 @@ void NiFloatExtraDataController::Put(NiStream& stream) {
 	extraData.Put(stream);
 }
 
-void NiFloatExtraDataController::GetStringRefs(std::set<StringRef*>& refs) {
-	NiExtraDataController::GetStringRefs(refs);
+void NiFloatExtraDataController::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiExtraDataController::VisitStringRefs(refs);
 
 	refs.insert(&extraData);
 }
@@ -651,8 +647,8 @@ void NiFlipController::Put(NiStream& stream) {
 	sourceRefs.Put(stream);
 }
 
-void NiFlipController::GetChildRefs(std::set<Ref*>& refs) {
-	NiFloatInterpController::GetChildRefs(refs);
+void NiFlipController::VisitChildRefs(RefSink<Ref>& refs) {
+	NiFloatInterpController::VisitChildRefs(refs);
 
 	sourceRefs.GetIndexPtrs(refs);
 }
@@ -763,8 +759,8 @@ void NiMultiTargetTransformController::Put(NiStream& stream) {
 	targetRefs.Put(stream);
 }
 
-void NiMultiTargetTransformController::GetPtrs(std::set<Ref*>& ptrs) {
-	NiInterpController::GetPtrs(ptrs);
+void NiMultiTargetTransformController::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiInterpController::VisitPtrs(ptrs);
 
 	targetRefs.GetIndexPtrs(ptrs);
 }
@@ -786,8 +782,8 @@ void NiPSysModifierCtlr::Put(NiStream& stream) {
 	modifierName.Put(stream);
 }
 
-void NiPSysModifierCtlr::GetStringRefs(std::set<StringRef*>& refs) {
-	NiSingleInterpController::GetStringRefs(refs);
+void NiPSysModifierCtlr::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiSingleInterpController::VisitStringRefs(refs);
 
 	refs.insert(&modifierName);
 }
@@ -805,8 +801,8 @@ void NiPSysEmitterCtlr::Put(NiStream& stream) {
 	visInterpolatorRef.Put(stream);
 }
 
-void NiPSysEmitterCtlr::GetChildRefs(std::set<Ref*>& refs) {
-	NiPSysModifierCtlr::GetChildRefs(refs);
+void NiPSysEmitterCtlr::VisitChildRefs(RefSink<Ref>& refs) {
+	NiPSysModifierCtlr::VisitChildRefs(refs);
 
 	refs.insert(&visInterpolatorRef);
 }
@@ -832,8 +828,8 @@ void BSPSysMultiTargetEmitterCtlr::Put(NiStream& stream) {
 	masterParticleSystemRef.Put(stream);
 }
 
-void BSPSysMultiTargetEmitterCtlr::GetPtrs(std::set<Ref*>& ptrs) {
-	NiPSysEmitterCtlr::GetPtrs(ptrs);
+void BSPSysMultiTargetEmitterCtlr::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiPSysEmitterCtlr::VisitPtrs(ptrs);
 
 	ptrs.insert(&masterParticleSystemRef);
 }
@@ -857,8 +853,8 @@ void NiBSplineInterpolator::Put(NiStream& stream) {
 	basisDataRef.Put(stream);
 }
 
-void NiBSplineInterpolator::GetChildRefs(std::set<Ref*>& refs) {
-	NiInterpolator::GetChildRefs(refs);
+void NiBSplineInterpolator::VisitChildRefs(RefSink<Ref>& refs) {
+	NiInterpolator::VisitChildRefs(refs);
 
 	refs.insert(&splineDataRef);
 	refs.insert(&basisDataRef);
@@ -1030,8 +1026,8 @@ void NiBoolInterpolator::Put(NiStream& stream) {
 	dataRef.Put(stream);
 }
 
-void NiBoolInterpolator::GetChildRefs(std::set<Ref*>& refs) {
-	NiKeyBasedInterpolator::GetChildRefs(refs);
+void NiBoolInterpolator::VisitChildRefs(RefSink<Ref>& refs) {
+	NiKeyBasedInterpolator::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -1057,8 +1053,8 @@ void NiFloatInterpolator::Put(NiStream& stream) {
 	dataRef.Put(stream);
 }
 
-void NiFloatInterpolator::GetChildRefs(std::set<Ref*>& refs) {
-	NiKeyBasedInterpolator::GetChildRefs(refs);
+void NiFloatInterpolator::VisitChildRefs(RefSink<Ref>& refs) {
+	NiKeyBasedInterpolator::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -1088,8 +1084,8 @@ void NiTransformInterpolator::Put(NiStream& stream) {
 	dataRef.Put(stream);
 }
 
-void NiTransformInterpolator::GetChildRefs(std::set<Ref*>& refs) {
-	NiKeyBasedInterpolator::GetChildRefs(refs);
+void NiTransformInterpolator::VisitChildRefs(RefSink<Ref>& refs) {
+	NiKeyBasedInterpolator::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -1115,8 +1111,8 @@ void NiPoint3Interpolator::Put(NiStream& stream) {
 	dataRef.Put(stream);
 }
 
-void NiPoint3Interpolator::GetChildRefs(std::set<Ref*>& refs) {
-	NiKeyBasedInterpolator::GetChildRefs(refs);
+void NiPoint3Interpolator::VisitChildRefs(RefSink<Ref>& refs) {
+	NiKeyBasedInterpolator::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -1152,8 +1148,8 @@ void NiPathInterpolator::Put(NiStream& stream) {
 	percentDataRef.Put(stream);
 }
 
-void NiPathInterpolator::GetChildRefs(std::set<Ref*>& refs) {
-	NiKeyBasedInterpolator::GetChildRefs(refs);
+void NiPathInterpolator::VisitChildRefs(RefSink<Ref>& refs) {
+	NiKeyBasedInterpolator::VisitChildRefs(refs);
 
 	refs.insert(&pathDataRef);
 	refs.insert(&percentDataRef);
@@ -1191,14 +1187,14 @@ void NiLookAtInterpolator::Put(NiStream& stream) {
 	scaleInterpRef.Put(stream);
 }
 
-void NiLookAtInterpolator::GetStringRefs(std::set<StringRef*>& refs) {
-	NiInterpolator::GetStringRefs(refs);
+void NiLookAtInterpolator::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiInterpolator::VisitStringRefs(refs);
 
 	refs.insert(&lookAtName);
 }
 
-void NiLookAtInterpolator::GetChildRefs(std::set<Ref*>& refs) {
-	NiInterpolator::GetChildRefs(refs);
+void NiLookAtInterpolator::VisitChildRefs(RefSink<Ref>& refs) {
+	NiInterpolator::VisitChildRefs(refs);
 
 	refs.insert(&translateInterpRef);
 	refs.insert(&rollInterpRef);
@@ -1213,8 +1209,8 @@ void NiLookAtInterpolator::GetChildIndices(std::vector<int>& indices) {
 	indices.push_back(scaleInterpRef.GetIndex());
 }
 
-void NiLookAtInterpolator::GetPtrs(std::set<Ref*>& ptrs) {
-	NiInterpolator::GetPtrs(ptrs);
+void NiLookAtInterpolator::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiInterpolator::VisitPtrs(ptrs);
 
 	ptrs.insert(&lookAtRef);
 }
@@ -1241,15 +1237,15 @@ void BSTreadTransfInterpolator::Put(NiStream& stream) {
 	dataRef.Put(stream);
 }
 
-void BSTreadTransfInterpolator::GetStringRefs(std::set<StringRef*>& refs) {
-	NiInterpolator::GetStringRefs(refs);
+void BSTreadTransfInterpolator::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiInterpolator::VisitStringRefs(refs);
 
 	for (int i = 0; i < numTreadTransforms; i++)
-		treadTransforms[i].GetStringRefs(refs);
+		treadTransforms[i].VisitStringRefs(refs);
 }
 
-void BSTreadTransfInterpolator::GetChildRefs(std::set<Ref*>& refs) {
-	NiInterpolator::GetChildRefs(refs);
+void BSTreadTransfInterpolator::VisitChildRefs(RefSink<Ref>& refs) {
+	NiInterpolator::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -1320,8 +1316,8 @@ void NiSequence::Put(NiStream& stream) {
 	}
 }
 
-void NiSequence::GetStringRefs(std::set<StringRef*>& refs) {
-	NiObject::GetStringRefs(refs);
+void NiSequence::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiObject::VisitStringRefs(refs);
 
 	refs.insert(&name);
 
@@ -1334,8 +1330,8 @@ void NiSequence::GetStringRefs(std::set<StringRef*>& refs) {
 	}
 }
 
-void NiSequence::GetChildRefs(std::set<Ref*>& refs) {
-	NiObject::GetChildRefs(refs);
+void NiSequence::VisitChildRefs(RefSink<Ref>& refs) {
+	NiObject::VisitChildRefs(refs);
 
 	for (int i = 0; i < numControlledBlocks; i++) {
 		refs.insert(&controlledBlocks[i].interpolatorRef);
@@ -1396,8 +1392,8 @@ void BSAnimNotes::Put(NiStream& stream) {
 	animNoteRefs.Put(stream);
 }
 
-void BSAnimNotes::GetChildRefs(std::set<Ref*>& refs) {
-	NiObject::GetChildRefs(refs);
+void BSAnimNotes::VisitChildRefs(RefSink<Ref>& refs) {
+	NiObject::VisitChildRefs(refs);
 
 	animNoteRefs.GetIndexPtrs(refs);
 }
@@ -1449,14 +1445,14 @@ void NiControllerSequence::Put(NiStream& stream) {
 		animNotesRefs.Put(stream);
 }
 
-void NiControllerSequence::GetStringRefs(std::set<StringRef*>& refs) {
-	NiSequence::GetStringRefs(refs);
+void NiControllerSequence::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiSequence::VisitStringRefs(refs);
 
 	refs.insert(&accumRootName);
 }
 
-void NiControllerSequence::GetChildRefs(std::set<Ref*>& refs) {
-	NiSequence::GetChildRefs(refs);
+void NiControllerSequence::VisitChildRefs(RefSink<Ref>& refs) {
+	NiSequence::VisitChildRefs(refs);
 
 	refs.insert(&textKeyRef);
 	refs.insert(&animNotesRef);
@@ -1471,8 +1467,8 @@ void NiControllerSequence::GetChildIndices(std::vector<int>& indices) {
 	animNotesRefs.GetIndices(indices);
 }
 
-void NiControllerSequence::GetPtrs(std::set<Ref*>& ptrs) {
-	NiSequence::GetPtrs(ptrs);
+void NiControllerSequence::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiSequence::VisitPtrs(ptrs);
 
 	ptrs.insert(&managerRef);
 }
@@ -1508,8 +1504,8 @@ void NiControllerManager::Put(NiStream& stream) {
 	objectPaletteRef.Put(stream);
 }
 
-void NiControllerManager::GetChildRefs(std::set<Ref*>& refs) {
-	NiTimeController::GetChildRefs(refs);
+void NiControllerManager::VisitChildRefs(RefSink<Ref>& refs) {
+	NiTimeController::VisitChildRefs(refs);
 
 	controllerSequenceRefs.GetIndexPtrs(refs);
 	refs.insert(&objectPaletteRef);
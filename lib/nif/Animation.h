@@ -119,7 +119,7 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 };
 
@@ -272,7 +272,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiBoolInterpolator* Clone() { return new NiBoolInterpolator(*this); }
 
@@ -299,7 +299,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiFloatInterpolator* Clone() { return new NiFloatInterpolator(*this); }
 
@@ -320,7 +320,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiTransformInterpolator* Clone() { return new NiTransformInterpolator(*this); }
 
@@ -347,7 +347,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiPoint3Interpolator* Clone() { return new NiPoint3Interpolator(*this); }
 
@@ -372,7 +372,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiPathInterpolator* Clone() { return new NiPathInterpolator(*this); }
 };
@@ -404,10 +404,10 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	NiLookAtInterpolator* Clone() { return new NiLookAtInterpolator(*this); }
 };
 
@@ -434,7 +434,7 @@ struct BSTreadTransform {
 		stream << transform2;
 	}
 
-	void GetStringRefs(std::set<StringRef*>& refs) {
+	void VisitStringRefs(RefSink<StringRef>& refs) {
 		refs.insert(&name);
 	}
 };
@@ -451,8 +451,8 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	BSTreadTransfInterpolator* Clone() { return new BSTreadTransfInterpolator(*this); }
 };
@@ -472,9 +472,9 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 
 	int GetNextControllerRef() { return nextControllerRef.GetIndex(); }
 	void SetNextControllerRef(int ctlrRef) { nextControllerRef.SetIndex(ctlrRef); }
@@ -494,7 +494,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	NiLookAtController* Clone() { return new NiLookAtController(*this); }
 };
 
@@ -514,7 +514,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiPathController* Clone() { return new NiPathController(*this); }
 };
@@ -554,7 +554,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiUVController* Clone() { return new NiUVController(*this); }
 };
@@ -569,7 +569,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	BSFrustumFOVController* Clone() { return new BSFrustumFOVController(*this); }
 
@@ -627,7 +627,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	BSProceduralLightningController* Clone() { return new BSProceduralLightningController(*this); }
 
@@ -675,7 +675,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	NiBoneLODController* Clone() { return new NiBoneLODController(*this); }
 };
 
@@ -704,7 +704,7 @@ struct Morph {
 			stream << vectors[i];
 	}
 
-	void GetStringRefs(std::set<StringRef*>& refs) {
+	void VisitStringRefs(RefSink<StringRef>& refs) {
 		refs.insert(&frameName);
 	}
 };
@@ -722,7 +722,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
 
 	NiMorphData* Clone() { return new NiMorphData(*this); }
 };
@@ -744,7 +744,7 @@ struct MorphWeight {
 		stream << weight;
 	}
 
-	void GetChildRefs(std::set<Ref*>& refs) {
+	void VisitChildRefs(RefSink<Ref>& refs) {
 		refs.insert(&interpRef);
 	}
 
@@ -768,7 +768,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 
 	NiGeomMorpherController* Clone() { return new NiGeomMorpherController(*this); }
@@ -781,7 +781,7 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 
 	int GetInterpolatorRef() { return interpolatorRef.GetIndex(); }
@@ -798,7 +798,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 
 	NiRollController* Clone() { return new NiRollController(*this); }
@@ -849,7 +849,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
 	NiFloatExtraDataController* Clone() { return new NiFloatExtraDataController(*this); }
 };
 
@@ -918,7 +918,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 
 	NiFlipController* Clone() { return new NiFlipController(*this); }
@@ -1099,7 +1099,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	NiMultiTargetTransformController* Clone() { return new NiMultiTargetTransformController(*this); }
 
 	BlockRefShortArray<NiAVObject>& GetTargets();
@@ -1112,7 +1112,7 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
 };
 
 class NiPSysModifierBoolCtlr : public NiPSysModifierCtlr {
@@ -1283,7 +1283,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiPSysEmitterCtlr* Clone() { return new NiPSysEmitterCtlr(*this); }
 };
@@ -1301,7 +1301,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	BSPSysMultiTargetEmitterCtlr* Clone() { return new BSPSysMultiTargetEmitterCtlr(*this); }
 };
 
@@ -1345,8 +1345,8 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiSequence* Clone() { return new NiSequence(*this); }
 };
@@ -1392,7 +1392,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 
 	BSAnimNotes* Clone() { return new BSAnimNotes(*this); }
@@ -1422,10 +1422,10 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	NiControllerSequence* Clone() { return new NiControllerSequence(*this); }
 
 	int GetAnimNotesRef();
@@ -1448,7 +1448,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiControllerManager* Clone() { return new NiControllerManager(*this); }
 
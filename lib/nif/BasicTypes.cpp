@@ -4,6 +4,9 @@ See the included LICENSE file
 */
 
 #include "BasicTypes.h"
+#include "Nodes.h"
+#include "Factory.h"
+#include "utils/ParallelFor.h"
 #include <regex>
 
 static const std::string NIF_GAMEBRYO = "Gamebryo File Format";
@@ -132,6 +135,471 @@ void NiHeader::Clear() {
 	blockTypeIndices.clear();
 	blockSizes.clear();
 	strings.clear();
+	stringIndex.ids.clear();
+	stringIndex.valid = false;
+
+	blockIndices.clear();
+	blockTypeBlocks.clear();
+	incomingRefs.clear();
+	outgoingRefs.clear();
+	numLazyBlocks = 0;
+	blockResource = nullptr;
+	keepBlockSources = false;
+	trackBlockAccess = false;
+	DropBlockSources();
+	InvalidateContentIndices();
+}
+
+void NiHeader::RebuildBlockIndices() {
+	blockIndices.clear();
+	blockTypeBlocks.clear();
+	blockTypeBlocks.resize(blockTypes.size());
+	InvalidateContentIndices();
+
+	if (!blocks)
+		return;
+
+	blockIndices.reserve(blocks->size());
+	for (size_t i = 0; i < blocks->size(); i++) {
+		blockIndices[(*blocks)[i].get()] = i;
+		if (i < blockTypeIndices.size())
+			AddTypeBlock(blockTypeIndices[i], i, (*blocks)[i].get());
+	}
+}
+
+void NiHeader::InvalidateContentIndices() {
+	nameIndexValid = false;
+	parentIndexValid = false;
+	refIndexValid = false;
+}
+
+void NiHeader::AddTypeBlock(const ushort blockTypeId, const int blockId, NiObject* block) {
+	if (blockTypeId >= blockTypeBlocks.size())
+		blockTypeBlocks.resize(blockTypeId + 1);
+
+	auto& typeBlocks = dynamic_cast<NiUnknown*>(block) ? blockTypeBlocks[blockTypeId].unknown : blockTypeBlocks[blockTypeId].known;
+	typeBlocks.insert(std::lower_bound(typeBlocks.begin(), typeBlocks.end(), blockId), blockId);
+}
+
+void NiHeader::RemoveTypeBlock(const ushort blockTypeId, const int blockId) {
+	if (blockTypeId >= blockTypeBlocks.size())
+		return;
+
+	for (auto typeBlocks : { &blockTypeBlocks[blockTypeId].known, &blockTypeBlocks[blockTypeId].unknown }) {
+		auto it = std::lower_bound(typeBlocks->begin(), typeBlocks->end(), blockId);
+		if (it != typeBlocks->end() && *it == blockId) {
+			typeBlocks->erase(it);
+			return;
+		}
+	}
+}
+
+bool NiHeader::HasTypeBlocks(const ushort blockTypeId) {
+	if (blockTypeId >= blockTypeBlocks.size())
+		return false;
+
+	return !blockTypeBlocks[blockTypeId].known.empty() || !blockTypeBlocks[blockTypeId].unknown.empty();
+}
+
+void NiHeader::RemoveBlockType(const ushort blockTypeId) {
+	if (blockTypeId < blockTypeBlocks.size())
+		blockTypeBlocks.erase(blockTypeBlocks.begin() + blockTypeId);
+}
+
+NiObject* NiHeader::LoadBlock(const int blockId) {
+	NiObject* block = (*blocks)[blockId].get();
+	if (numLazyBlocks == 0)
+		return block;
+
+	auto lazy = dynamic_cast<NiLazyBlock*>(block);
+	if (!lazy)
+		return block;
+
+	auto decoded = lazy->Decode(version, blockResource);
+	if (!decoded)
+		return block;
+
+	FillStringRefs(decoded.get());
+	SetDecodedBlock(blockId, std::move(decoded));
+
+	return (*blocks)[blockId].get();
+}
+
+void NiHeader::SetDecodedBlock(const int blockId, std::shared_ptr<NiObject> decoded) {
+	blockIndices.erase((*blocks)[blockId].get());
+	blockIndices[decoded.get()] = blockId;
+
+	if (keepBlockSources) {
+		blockSources.resize(numBlocks);
+		blockSources[blockId] = std::move((*blocks)[blockId]);
+		numBlockSources++;
+	}
+
+	(*blocks)[blockId] = std::move(decoded);
+	numLazyBlocks--;
+}
+
+NiObject* NiHeader::AccessBlock(const int blockId) {
+	NiObject* block = LoadBlock(blockId);
+	if (trackBlockAccess)
+		SetBlockModified(blockId);
+
+	return block;
+}
+
+bool NiHeader::IsBlockModified(const int blockId) {
+	if (blockId < 0 || (uint)blockId >= numBlocks)
+		return false;
+
+	NiObject* block = (*blocks)[blockId].get();
+	if (numLazyBlocks > 0 && dynamic_cast<NiLazyBlock*>(block))
+		return false;
+
+	return (size_t)blockId >= blockSources.size() || !blockSources[blockId] || block->IsEdited();
+}
+
+void NiHeader::SetBlockModified(const int blockId) {
+	if (blockId >= 0 && (size_t)blockId < blockSources.size() && blockSources[blockId]) {
+		blockSources[blockId].reset();
+		numBlockSources--;
+	}
+}
+
+NiObject* NiHeader::GetBlockSource(const int blockId) {
+	if (blockId >= 0 && (size_t)blockId < blockSources.size())
+		return blockSources[blockId].get();
+
+	return nullptr;
+}
+
+void NiHeader::DropBlockSources() {
+	blockSources.clear();
+	numBlockSources = 0;
+}
+
+bool NiHeader::LoadAllBlocks() {
+	if (!blocks)
+		return true;
+
+	for (uint i = 0; i < numBlocks && numLazyBlocks > 0; i++)
+		LoadBlock(i);
+
+	return numLazyBlocks == 0;
+}
+
+bool NiHeader::LoadAllBlocks(const uint numThreads, const std::vector<std::pmr::memory_resource*>& threadResources) {
+	if (!blocks || numLazyBlocks == 0)
+		return true;
+
+	if (numThreads == 1)
+		return LoadAllBlocks();
+
+	// Blocks only refer to each other by index, so they decode independently
+	std::vector<std::shared_ptr<NiObject>> decoded(numBlocks);
+	ParallelFor(numBlocks, numThreads, [&](const size_t i, const uint threadId) {
+		auto lazy = dynamic_cast<NiLazyBlock*>((*blocks)[i].get());
+		if (!lazy)
+			return;
+
+		// Memory resources aren't thread-safe, so every thread decodes into its own
+		std::pmr::memory_resource* resource = threadId < threadResources.size() ? threadResources[threadId] : nullptr;
+		decoded[i] = lazy->Decode(version, resource);
+		if (decoded[i])
+			FillStringRefs(decoded[i].get());
+	});
+
+	for (uint i = 0; i < numBlocks; i++)
+		if (decoded[i])
+			SetDecodedBlock(i, std::move(decoded[i]));
+
+	// Blocks that failed to decode are still lazy
+	return numLazyBlocks == 0;
+}
+
+void NiHeader::BuildNameIndex() {
+	nameIndex.clear();
+
+	// Only blocks of named types get decoded
+	for (auto& id : GetBlockIDsOfType<NiObjectNET>()) {
+		auto named = dynamic_cast<NiObjectNET*>(LoadBlock(id));
+		if (named)
+			nameIndex[named->GetName()].push_back(id);
+	}
+
+	nameIndexValid = true;
+}
+
+void NiHeader::BuildParentIndex() {
+	parentIndex.clear();
+
+	// Only nodes get decoded, the first parent in block order wins
+	for (auto& id : GetBlockIDsOfType<NiNode>()) {
+		auto node = dynamic_cast<NiNode*>(LoadBlock(id));
+		if (node) {
+			for (auto& child : node->GetChildren())
+				parentIndex.emplace(child.GetIndex(), id);
+		}
+	}
+
+	parentIndexValid = true;
+}
+
+bool NiHeader::ReferenceIndexCurrent() {
+	return refIndexEnabled && refIndexValid;
+}
+
+void NiHeader::BuildReferenceIndex() {
+	LoadAllBlocks();
+	incomingRefs.clear();
+	outgoingRefs.clear();
+	incomingRefs.resize(numBlocks);
+	outgoingRefs.resize(numBlocks);
+
+	std::vector<Ref*> refs;
+	for (uint i = 0; i < numBlocks; i++) {
+		refs.clear();
+		(*blocks)[i]->GetRefs(refs);
+
+		for (auto &ref : refs)
+			AddIndexedRef(i, ref->GetIndex());
+	}
+
+	refIndexValid = true;
+}
+
+void NiHeader::UpdateReferenceIndex(const int blockId) {
+	auto& outgoing = outgoingRefs[blockId];
+	for (auto &index : outgoing) {
+		auto& incoming = incomingRefs[index];
+		auto it = std::find(incoming.begin(), incoming.end(), blockId);
+		if (it != incoming.end())
+			incoming.erase(it);
+	}
+
+	outgoing.clear();
+
+	std::vector<Ref*> refs;
+	(*blocks)[blockId]->GetRefs(refs);
+
+	for (auto &ref : refs)
+		AddIndexedRef(blockId, ref->GetIndex());
+}
+
+void NiHeader::AddIndexedRef(const int holderId, const int index) {
+	if (index < 0 || (uint)index >= numBlocks)
+		return;
+
+	incomingRefs[index].push_back(holderId);
+	outgoingRefs[holderId].push_back(index);
+}
+
+void NiHeader::RemoveIndexedRef(const int holderId, const int index) {
+	if (index < 0 || (uint)index >= numBlocks)
+		return;
+
+	auto& incoming = incomingRefs[index];
+	auto in = std::find(incoming.begin(), incoming.end(), holderId);
+	if (in != incoming.end())
+		incoming.erase(in);
+
+	auto& outgoing = outgoingRefs[holderId];
+	auto out = std::find(outgoing.begin(), outgoing.end(), index);
+	if (out != outgoing.end())
+		outgoing.erase(out);
+}
+
+void NiHeader::RemapReferenceIndex(const std::vector<uint>& newIndices, const uint newNumBlocks) {
+	std::vector<std::vector<int>> newIncoming(newNumBlocks);
+	std::vector<std::vector<int>> newOutgoing(newNumBlocks);
+
+	auto remap = [&](const std::vector<int>& from, std::vector<int>& to) {
+		to.reserve(from.size());
+		for (auto &id : from)
+			if (newIndices[id] != 0xFFFFFFFF)
+				to.push_back(newIndices[id]);
+	};
+
+	for (size_t i = 0; i < newIndices.size() && i < incomingRefs.size(); i++) {
+		uint newId = newIndices[i];
+		if (newId == 0xFFFFFFFF)
+			continue;
+
+		remap(incomingRefs[i], newIncoming[newId]);
+		remap(outgoingRefs[i], newOutgoing[newId]);
+	}
+
+	incomingRefs.swap(newIncoming);
+	outgoingRefs.swap(newOutgoing);
+}
+
+const std::vector<int>& NiHeader::GetIncomingRefs(const int blockId) {
+	if (!refIndexValid)
+		BuildReferenceIndex();
+
+	return incomingRefs[blockId];
+}
+
+void NiHeader::SetReferenceIndex(const bool enable) {
+	refIndexEnabled = enable;
+	refIndexValid = false;
+	incomingRefs.clear();
+	outgoingRefs.clear();
+
+	if (enable && blocks)
+		BuildReferenceIndex();
+}
+
+std::vector<int> NiHeader::GetReferencingBlocks(const int blockId) {
+	std::vector<int> ids;
+	if (!blocks || blockId < 0 || (uint)blockId >= numBlocks)
+		return ids;
+
+	if (refIndexEnabled) {
+		ids = GetIncomingRefs(blockId);
+		std::sort(ids.begin(), ids.end());
+		return ids;
+	}
+
+	LoadAllBlocks();
+
+	std::vector<Ref*> refs;
+	for (uint i = 0; i < numBlocks; i++) {
+		refs.clear();
+		(*blocks)[i]->GetRefs(refs);
+
+		for (auto &ref : refs)
+			if (ref->GetIndex() == blockId)
+				ids.push_back(i);
+	}
+
+	return ids;
+}
+
+void NiHeader::SetBlockRef(const int holderId, Ref& ref, const int index) {
+	int oldIndex = ref.GetIndex();
+	ref.SetIndex(index);
+	SetBlockModified(holderId);
+
+	if (ReferenceIndexCurrent() && holderId >= 0 && (uint)holderId < numBlocks) {
+		RemoveIndexedRef(holderId, oldIndex);
+		AddIndexedRef(holderId, index);
+	}
+}
+
+void NiHeader::AddBlockRef(const int holderId, RefArray& refs, const int index) {
+	refs.AddBlockRef(index);
+	SetBlockModified(holderId);
+
+	if (ReferenceIndexCurrent() && holderId >= 0 && (uint)holderId < numBlocks)
+		AddIndexedRef(holderId, index);
+}
+
+void NiHeader::RemoveBlockRef(const int holderId, RefArray& refs, const int refId) {
+	int oldIndex = refs.GetBlockRef(refId);
+	refs.RemoveBlockRef(refId);
+	SetBlockModified(holderId);
+
+	if (ReferenceIndexCurrent() && holderId >= 0 && (uint)holderId < numBlocks)
+		RemoveIndexedRef(holderId, oldIndex);
+}
+
+void NiHeader::BlockReferencesEdited(const int blockId) {
+	SetBlockModified(blockId);
+
+	if (ReferenceIndexCurrent() && blockId >= 0 && (uint)blockId < numBlocks)
+		UpdateReferenceIndex(blockId);
+}
+
+void NiHeader::InvalidateReferenceIndex() {
+	refIndexValid = false;
+}
+
+std::vector<int> NiHeader::GetBlockIDsByName(const std::string& name) {
+	std::vector<int> ids;
+	if (!blocks)
+		return ids;
+
+	if (!nameIndexValid)
+		BuildNameIndex();
+
+	auto it = nameIndex.find(name);
+	if (it != nameIndex.end())
+		ids = it->second;
+
+	return ids;
+}
+
+void NiHeader::SetBlockName(const int blockId, const std::string& name) {
+	auto named = LoadBlock<NiObjectNET>(blockId);
+	if (!named)
+		return;
+
+	if (nameIndexValid) {
+		auto it = nameIndex.find(named->GetName());
+		if (it != nameIndex.end()) {
+			auto& oldIds = it->second;
+			oldIds.erase(std::remove(oldIds.begin(), oldIds.end(), blockId), oldIds.end());
+			if (oldIds.empty())
+				nameIndex.erase(it);
+		}
+
+		auto& newIds = nameIndex[name];
+		newIds.insert(std::lower_bound(newIds.begin(), newIds.end(), blockId), blockId);
+	}
+
+	named->SetName(name);
+	SetBlockModified(blockId);
+}
+
+void NiHeader::InvalidateNameIndex() {
+	nameIndexValid = false;
+}
+
+int NiHeader::GetParentID(const int blockId) {
+	if (!blocks || blockId < 0 || (uint)blockId >= numBlocks)
+		return 0xFFFFFFFF;
+
+	// Reading the children doesn't count as an access that modifies the node
+	auto isParent = [&](const int parentId) {
+		auto node = dynamic_cast<NiNode*>(LoadBlock(parentId));
+		if (!node)
+			return false;
+
+		for (auto& child : node->GetChildren())
+			if (child.GetIndex() == blockId)
+				return true;
+
+		return false;
+	};
+
+	if (refIndexEnabled) {
+		int parentId = 0xFFFFFFFF;
+		for (auto &holder : GetIncomingRefs(blockId))
+			if ((parentId < 0 || holder < parentId) && isParent(holder))
+				parentId = holder;
+
+		return parentId;
+	}
+
+	if (!parentIndexValid)
+		BuildParentIndex();
+
+	// Child lists can be edited directly, so verify the cached parent
+	auto it = parentIndex.find(blockId);
+	if (it != parentIndex.end() && isParent(it->second))
+		return it->second;
+
+	for (auto& id : GetBlockIDsOfType<NiNode>()) {
+		if (isParent(id)) {
+			parentIndexValid = false;
+			return id;
+		}
+	}
+
+	if (it != parentIndex.end())
+		parentIndexValid = false;
+
+	return 0xFFFFFFFF;
 }
 
 std::string NiHeader::GetCreatorInfo() {
@@ -181,28 +649,167 @@ void NiHeader::DeleteBlock(int blockId) {
 	if (blockId == 0xFFFFFFFF)
 		return;
 
+	LoadAllBlocks();
+	DropBlockSources();
+
+	bool refIndexCurrent = ReferenceIndexCurrent();
+
 	ushort blockTypeId = blockTypeIndices[blockId];
-	int blockTypeRefCount = 0;
-	for (int i = 0; i < blockTypeIndices.size(); i++)
-		if (blockTypeIndices[i] == blockTypeId)
-			blockTypeRefCount++;
+	RemoveTypeBlock(blockTypeId, blockId);
 
-	if (blockTypeRefCount < 2) {
+	if (!HasTypeBlocks(blockTypeId)) {
 		blockTypes.erase(blockTypes.begin() + blockTypeId);
+		RemoveBlockType(blockTypeId);
 		numBlockTypes--;
-		for (int i = 0; i < blockTypeIndices.size(); i++)
+		for (size_t i = 0; i < blockTypeIndices.size(); i++)
 			if (blockTypeIndices[i] > blockTypeId)
 				blockTypeIndices[i]--;
 	}
 
+	blockIndices.erase((*blocks)[blockId].get());
 	blocks->erase(blocks->begin() + blockId);
 	numBlocks--;
 	blockTypeIndices.erase(blockTypeIndices.begin() + blockId);
 	blockSizes.erase(blockSizes.begin() + blockId);
 
+	for (auto &bi : blockIndices)
+		if (bi.second > blockId)
+			bi.second--;
+
+	for (auto &typeBlocks : blockTypeBlocks) {
+		for (auto it = std::upper_bound(typeBlocks.known.begin(), typeBlocks.known.end(), blockId); it != typeBlocks.known.end(); ++it)
+			(*it)--;
+
+		for (auto it = std::upper_bound(typeBlocks.unknown.begin(), typeBlocks.unknown.end(), blockId); it != typeBlocks.unknown.end(); ++it)
+			(*it)--;
+	}
+
+	InvalidateContentIndices();
+
+	// Shift the reference index along with the blocks instead of rebuilding it
+	if (refIndexCurrent) {
+		std::vector<uint> newIndices(numBlocks + 1);
+		for (uint i = 0; i <= numBlocks; i++) {
+			if (i == (uint)blockId)
+				newIndices[i] = 0xFFFFFFFF;
+			else
+				newIndices[i] = i < (uint)blockId ? i : i - 1;
+		}
+
+		RemapReferenceIndex(newIndices, numBlocks);
+		refIndexValid = true;
+	}
+
 	// Next tell all the blocks that the deletion happened
+	std::vector<Ref*> refs;
 	for (auto &b : (*blocks))
-		BlockDeleted(b.get(), blockId);
+		BlockDeleted(b.get(), blockId, refs);
+}
+
+void NiHeader::DeleteBlocks(const std::set<int>& blockIds) {
+	if (!blocks || blockIds.empty())
+		return;
+
+	LoadAllBlocks();
+	DropBlockSources();
+
+	std::vector<bool> deleted(numBlocks);
+	for (auto &id : blockIds)
+		if (id >= 0 && (uint)id < numBlocks)
+			deleted[id] = true;
+
+	bool refIndexCurrent = ReferenceIndexCurrent();
+
+	// Map old to new indices, deleted blocks map to 0xFFFFFFFF
+	std::vector<uint> newIndices(numBlocks);
+	uint numDeleted = 0;
+	for (uint i = 0; i < numBlocks; i++) {
+		if (deleted[i]) {
+			newIndices[i] = 0xFFFFFFFF;
+			numDeleted++;
+		}
+		else
+			newIndices[i] = i - numDeleted;
+	}
+
+	if (numDeleted == 0)
+		return;
+
+	// Remove block types that lose their last block
+	std::vector<int> typeBlockCount(numBlockTypes);
+	std::vector<bool> typeDeleted(numBlockTypes);
+	for (uint i = 0; i < numBlocks; i++) {
+		ushort typeId = blockTypeIndices[i];
+		if (typeId >= numBlockTypes)
+			continue;
+
+		if (deleted[i])
+			typeDeleted[typeId] = true;
+		else
+			typeBlockCount[typeId]++;
+	}
+
+	std::vector<ushort> newTypeIndices(numBlockTypes);
+	ushort newTypeIndex = 0;
+	for (ushort t = 0; t < numBlockTypes; t++) {
+		newTypeIndices[t] = newTypeIndex;
+		if (typeDeleted[t] && typeBlockCount[t] == 0)
+			continue;
+
+		if (newTypeIndex != t)
+			blockTypes[newTypeIndex] = std::move(blockTypes[t]);
+
+		newTypeIndex++;
+	}
+
+	blockTypes.resize(newTypeIndex);
+	numBlockTypes = newTypeIndex;
+
+	// Compact the remaining blocks and rewrite their references
+	std::vector<Ref*> refs;
+	uint w = 0;
+	for (uint i = 0; i < numBlocks; i++) {
+		if (deleted[i])
+			continue;
+
+		auto& block = (*blocks)[i];
+
+		refs.clear();
+		block->GetRefs(refs);
+
+		for (auto &r : refs) {
+			int index = r->GetIndex();
+			if (index < 0)
+				continue;
+
+			if ((uint)index >= numBlocks)
+				r->SetIndex(index - numDeleted);
+			else if (deleted[index])
+				r->Clear();
+			else
+				r->SetIndex(newIndices[index]);
+		}
+
+		ushort typeId = blockTypeIndices[i];
+		blockTypeIndices[w] = typeId < newTypeIndices.size() ? newTypeIndices[typeId] : typeId;
+		blockSizes[w] = blockSizes[i];
+		if (w != i)
+			(*blocks)[w] = std::move(block);
+
+		w++;
+	}
+
+	blocks->resize(w);
+	blockTypeIndices.resize(w);
+	blockSizes.resize(w);
+	numBlocks = w;
+
+	RebuildBlockIndices();
+
+	if (refIndexCurrent) {
+		RemapReferenceIndex(newIndices, numBlocks);
+		refIndexValid = true;
+	}
 }
 
 void NiHeader::DeleteBlockByType(const std::string& blockTypeStr, const bool orphanedOnly) {
@@ -214,22 +821,47 @@ void NiHeader::DeleteBlockByType(const std::string& blockTypeStr, const bool orp
 	if (blockTypeId == numBlockTypes)
 		return;
 
-	std::vector<int> indices;
+	std::vector<bool> candidates(numBlocks);
 	for (int i = 0; i < numBlocks; i++)
-		if (blockTypeIndices[i] == blockTypeId)
-			indices.push_back(i);
+		candidates[i] = blockTypeIndices[i] == blockTypeId;
 
-	for (int j = indices.size() - 1; j >= 0; j--)
-		if (!orphanedOnly || !IsBlockReferenced(indices[j]))
-			DeleteBlock(indices[j]);
+	if (orphanedOnly) {
+		DeleteBlocks(GetUnreferencedBlocks(candidates));
+	}
+	else {
+		std::set<int> indices;
+		for (int i = 0; i < numBlocks; i++)
+			if (candidates[i])
+				indices.insert(i);
+
+		DeleteBlocks(indices);
+	}
 }
 
 int NiHeader::AddBlock(NiObject* newBlock) {
+	bool refIndexCurrent = ReferenceIndexCurrent();
+
 	ushort btID = AddOrFindBlockTypeId(newBlock->GetBlockName());
 	blockTypeIndices.push_back(btID);
 	blockSizes.push_back(0);
 	blocks->push_back(std::move(std::shared_ptr<NiObject>(newBlock)));
 	numBlocks = blocks->size();
+
+	blockIndices[newBlock] = numBlocks - 1;
+	AddTypeBlock(btID, numBlocks - 1, newBlock);
+
+	if (nameIndexValid) {
+		auto named = dynamic_cast<NiObjectNET*>(newBlock);
+		if (named)
+			nameIndex[named->GetName()].push_back(numBlocks - 1);
+	}
+
+	if (refIndexCurrent) {
+		incomingRefs.resize(numBlocks);
+		outgoingRefs.resize(numBlocks);
+		UpdateReferenceIndex(numBlocks - 1);
+	}
+
 	return numBlocks - 1;
 }
 
@@ -237,14 +869,18 @@ int NiHeader::ReplaceBlock(int oldBlockId, NiObject* newBlock) {
 	if (oldBlockId == 0xFFFFFFFF)
 		return 0xFFFFFFFF;
 
+	bool refIndexCurrent = ReferenceIndexCurrent();
+	if (numLazyBlocks > 0 && dynamic_cast<NiLazyBlock*>((*blocks)[oldBlockId].get()))
+		numLazyBlocks--;
+
+	SetBlockModified(oldBlockId);
+
 	ushort blockTypeId = blockTypeIndices[oldBlockId];
-	int blockTypeRefCount = 0;
-	for (int i = 0; i < blockTypeIndices.size(); i++)
-		if (blockTypeIndices[i] == blockTypeId)
-			blockTypeRefCount++;
+	RemoveTypeBlock(blockTypeId, oldBlockId);
 
-	if (blockTypeRefCount < 2) {
+	if (!HasTypeBlocks(blockTypeId)) {
 		blockTypes.erase(blockTypes.begin() + blockTypeId);
+		RemoveBlockType(blockTypeId);
 		numBlockTypes--;
 		for (int i = 0; i < blockTypeIndices.size(); i++)
 			if (blockTypeIndices[i] > blockTypeId)
@@ -254,8 +890,21 @@ int NiHeader::ReplaceBlock(int oldBlockId, NiObject* newBlock) {
 	ushort btID = AddOrFindBlockTypeId(newBlock->GetBlockName());
 	blockTypeIndices[oldBlockId] = btID;
 	blockSizes[oldBlockId] = 0;
+	AddTypeBlock(btID, oldBlockId, newBlock);
+
+	blockIndices.erase((*blocks)[oldBlockId].get());
+	blockIndices[newBlock] = oldBlockId;
+
 	auto blockPtrSwap = std::shared_ptr<NiObject>(newBlock);
 	(*blocks)[oldBlockId].swap(blockPtrSwap);
+	InvalidateContentIndices();
+
+	// Block IDs stay the same, only the replaced block's own references change
+	if (refIndexCurrent) {
+		refIndexValid = true;
+		UpdateReferenceIndex(oldBlockId);
+	}
+
 	return oldBlockId;
 }
 
@@ -263,53 +912,87 @@ void NiHeader::SetBlockOrder(std::vector<int>& newOrder) {
 	if (newOrder.size() != numBlocks)
 		return;
 
-	for (int i = 0; i < numBlocks; i++)
-		SwapBlocks(i, newOrder[i]);
+	// Resolve the sequence of swaps into a single permutation
+	std::vector<int> order(numBlocks);
+	for (uint i = 0; i < numBlocks; i++)
+		order[i] = i;
+
+	for (uint i = 0; i < numBlocks; i++)
+		if (newOrder[i] >= 0 && (uint)newOrder[i] < numBlocks)
+			std::swap(order[i], order[newOrder[i]]);
+
+	ApplyBlockOrder(order);
 }
 
 void NiHeader::FixBlockAlignment(const std::vector<NiObject*>& currentTree) {
 	if (currentTree.size() != numBlocks)
 		return;
 
-	std::map<int, int> indices;
-	for (int i = 0; i < numBlocks; i++)
-		indices[i] = GetBlockID(currentTree[i]);
+	std::vector<int> order(numBlocks);
+	for (uint i = 0; i < numBlocks; i++) {
+		order[i] = GetBlockID(currentTree[i]);
+		if (order[i] < 0)
+			return;
+	}
+
+	ApplyBlockOrder(order);
+}
+
+void NiHeader::ApplyBlockOrder(const std::vector<int>& order) {
+	bool identity = true;
+	for (uint i = 0; i < numBlocks && identity; i++)
+		identity = order[i] == (int)i;
+
+	if (identity)
+		return;
+
+	LoadAllBlocks();
+	DropBlockSources();
+
+	bool refIndexCurrent = ReferenceIndexCurrent();
+
+	// First new position of each old index
+	std::vector<uint> newIndices(numBlocks, 0xFFFFFFFF);
+	for (int i = numBlocks - 1; i >= 0; i--)
+		newIndices[order[i]] = i;
+
+	// The index can only be carried over if every block keeps exactly one position
+	bool permutation = std::find(newIndices.begin(), newIndices.end(), 0xFFFFFFFF) == newIndices.end();
+
+	std::vector<Ref*> refs;
+	RefSink<Ref> sink(refs);
+	for (auto &b : (*blocks)) {
+		b->VisitChildRefs(sink);
+		b->VisitPtrs(sink);
+	}
+
+	UniqueRefs(refs);
+
+	for (auto &r : refs) {
+		int index = r->GetIndex();
+		if (index >= 0 && (uint)index < numBlocks && newIndices[index] != 0xFFFFFFFF)
+			r->SetIndex(newIndices[index]);
+	}
 
 	std::vector<ushort> newBlockTypeIndices(numBlocks);
 	std::vector<uint> newBlockSizes(numBlocks);
 	std::vector<std::shared_ptr<NiObject>> newBlocks(numBlocks);
 
-	std::set<Ref*> updatedRefs;
-
-	for (auto &i : indices) {
-		for (auto &b : (*blocks)) {
-			std::set<Ref*> refs;
-			b->GetChildRefs(refs);
-			b->GetPtrs(refs);
-	
-			for (auto &r : refs) {
-				if (updatedRefs.find(r) == updatedRefs.end()) {
-					int index = r->GetIndex();
-					if (index == i.second) {
-						r->SetIndex(i.first);
-						updatedRefs.insert(r);
-					}
-				}
-			}
-		}
+	for (uint i = 0; i < numBlocks; i++) {
+		newBlockTypeIndices[i] = blockTypeIndices[order[i]];
+		newBlockSizes[i] = blockSizes[order[i]];
+		newBlocks[i] = (*blocks)[order[i]];
 	}
 
-	for (auto &i : indices) {
-		int newIndex = i.second;
-		newBlockTypeIndices[i.first] = blockTypeIndices[newIndex];
-		newBlockSizes[i.first] = blockSizes[newIndex];
-		newBlocks[i.first] = blocks->at(newIndex);
-	}
+	blockTypeIndices = std::move(newBlockTypeIndices);
+	blockSizes = std::move(newBlockSizes);
+	blocks->swap(newBlocks);
+
+	RebuildBlockIndices();
 
-	for (int i = numBlocks - 1; i >= 0; i--) {
-		blockTypeIndices[i] = std::move(newBlockTypeIndices[i]);
-		blockSizes[i] = std::move(newBlockSizes[i]);
-		blocks->at(i) = std::move(newBlocks[i]);
+	if (refIndexCurrent && permutation) {
+		RemapReferenceIndex(newIndices, numBlocks);
+		refIndexValid = true;
 	}
 }
 
@@ -319,24 +1002,75 @@ void NiHeader::SwapBlocks(const int blockIndexLo, const int blockIndexHi) {
 		blockIndexLo == blockIndexHi)
 		return;
 
+	LoadAllBlocks();
+	DropBlockSources();
+
 	// First swap data
 	std::iter_swap(blockTypeIndices.begin() + blockIndexLo, blockTypeIndices.begin() + blockIndexHi);
 	std::iter_swap(blockSizes.begin() + blockIndexLo, blockSizes.begin() + blockIndexHi);
 	std::iter_swap(blocks->begin() + blockIndexLo, blocks->begin() + blockIndexHi);
 
+	blockIndices[(*blocks)[blockIndexLo].get()] = blockIndexLo;
+	blockIndices[(*blocks)[blockIndexHi].get()] = blockIndexHi;
+
+	// Blocks of the same type may still sit in different lists if one of them is NiUnknown
+	ushort typeLo = blockTypeIndices[blockIndexLo];
+	ushort typeHi = blockTypeIndices[blockIndexHi];
+	RemoveTypeBlock(typeLo, blockIndexHi);
+	RemoveTypeBlock(typeHi, blockIndexLo);
+	AddTypeBlock(typeLo, blockIndexLo, (*blocks)[blockIndexLo].get());
+	AddTypeBlock(typeHi, blockIndexHi, (*blocks)[blockIndexHi].get());
+
+	bool refIndexCurrent = ReferenceIndexCurrent();
+	InvalidateContentIndices();
+
+	// Only the neighbours of the two blocks see their IDs change
+	if (refIndexCurrent) {
+		auto swapId = [&](std::vector<int>& ids) {
+			for (auto &id : ids) {
+				if (id == blockIndexLo)
+					id = blockIndexHi;
+				else if (id == blockIndexHi)
+					id = blockIndexLo;
+			}
+		};
+
+		std::set<int> holders(incomingRefs[blockIndexLo].begin(), incomingRefs[blockIndexLo].end());
+		holders.insert(incomingRefs[blockIndexHi].begin(), incomingRefs[blockIndexHi].end());
+
+		std::set<int> targets(outgoingRefs[blockIndexLo].begin(), outgoingRefs[blockIndexLo].end());
+		targets.insert(outgoingRefs[blockIndexHi].begin(), outgoingRefs[blockIndexHi].end());
+
+		for (auto &holder : holders)
+			swapId(outgoingRefs[holder]);
+
+		for (auto &target : targets)
+			swapId(incomingRefs[target]);
+
+		incomingRefs[blockIndexLo].swap(incomingRefs[blockIndexHi]);
+		outgoingRefs[blockIndexLo].swap(outgoingRefs[blockIndexHi]);
+		refIndexValid = true;
+	}
+
 	// Next tell all the blocks that the swap happened
+	std::vector<Ref*> refs;
 	for (auto &b : (*blocks))
-		BlockSwapped(b.get(), blockIndexLo, blockIndexHi);
+		BlockSwapped(b.get(), blockIndexLo, blockIndexHi, refs);
 }
 
 bool NiHeader::IsBlockReferenced(const int blockId) {
 	if (blockId == 0xFFFFFFFF)
 		return false;
 
+	if (refIndexEnabled)
+		return blockId >= 0 && (uint)blockId < numBlocks && !GetIncomingRefs(blockId).empty();
+
+	LoadAllBlocks();
+
+	std::vector<Ref*> refs;
 	for (auto &block : (*blocks)) {
-		std::set<Ref*> refs;
-		block->GetChildRefs(refs);
-		block->GetPtrs(refs);
+		refs.clear();
+		block->GetRefs(refs);
 
 		for (auto &ref : refs)
 			if (ref->GetIndex() == blockId)
@@ -350,12 +1084,17 @@ int NiHeader::GetBlockRefCount(const int blockId) {
 	if (blockId == 0xFFFFFFFF)
 		return 0;
 
+	if (refIndexEnabled)
+		return blockId >= 0 && (uint)blockId < numBlocks ? GetIncomingRefs(blockId).size() : 0;
+
+	LoadAllBlocks();
+
 	int refCount = 0;
 
+	std::vector<Ref*> refs;
 	for (auto &block : (*blocks)) {
-		std::set<Ref*> refs;
-		block->GetChildRefs(refs);
-		block->GetPtrs(refs);
+		refs.clear();
+		block->GetRefs(refs);
 
 		for (auto &ref : refs)
 			if (ref->GetIndex() == blockId)
@@ -365,6 +1104,57 @@ int NiHeader::GetBlockRefCount(const int blockId) {
 	return refCount;
 }
 
+std::set<int> NiHeader::GetUnreferencedBlocks(const std::vector<bool>& candidates) {
+	std::set<int> unreferenced;
+	if (!blocks)
+		return unreferenced;
+
+	LoadAllBlocks();
+
+	std::vector<Ref*> refs;
+	std::vector<int> refCounts(numBlocks);
+	if (refIndexEnabled) {
+		for (uint i = 0; i < numBlocks; i++)
+			refCounts[i] = GetIncomingRefs(i).size();
+	}
+	else {
+		for (uint i = 0; i < numBlocks; i++) {
+			refs.clear();
+			(*blocks)[i]->GetRefs(refs);
+
+			for (auto &ref : refs) {
+				int index = ref->GetIndex();
+				if (index >= 0 && (uint)index < numBlocks)
+					refCounts[index]++;
+			}
+		}
+	}
+
+	std::vector<int> pending;
+	for (size_t i = 0; i < numBlocks && i < candidates.size(); i++)
+		if (candidates[i] && refCounts[i] == 0)
+			pending.push_back(i);
+
+	// Deleting a block can cause others to become unreferenced
+	while (!pending.empty()) {
+		int blockId = pending.back();
+		pending.pop_back();
+		unreferenced.insert(blockId);
+
+		refs.clear();
+		(*blocks)[blockId]->GetRefs(refs);
+
+		for (auto &ref : refs) {
+			int index = ref->GetIndex();
+			if (index >= 0 && (uint)index < numBlocks && --refCounts[index] == 0)
+				if ((size_t)index < candidates.size() && candidates[index])
+					pending.push_back(index);
+		}
+	}
+
+	return unreferenced;
+}
+
 ushort NiHeader::AddOrFindBlockTypeId(const std::string& blockTypeName) {
 	NiString niStr;
 	ushort typeId = (ushort)blockTypes.size();
@@ -408,6 +1198,11 @@ uint NiHeader::GetBlockSize(const uint blockId) {
 	return 0xFFFFFFFF;
 }
 
+void NiHeader::SetBlockSize(const uint blockId, const uint size) {
+	if (blockId < numBlocks)
+		blockSizes[blockId] = size;
+}
+
 std::streampos NiHeader::GetBlockSizeStreamPos() {
 	return blockSizePos;
 }
@@ -420,18 +1215,31 @@ int NiHeader::GetStringCount() {
 	return strings.size();
 }
 
-int NiHeader::FindStringId(const std::string& str) {
+void NiHeader::BuildStringIndex() {
+	stringIndex.ids.clear();
+	stringIndex.ids.reserve(strings.size());
+
 	for (int i = 0; i < strings.size(); i++)
-		if (strings[i].GetString().compare(str) == 0)
-			return i;
+		stringIndex.ids.emplace(strings[i].GetString(), i);
+
+	stringIndex.valid = true;
+}
+
+int NiHeader::FindStringId(const std::string& str) {
+	if (!stringIndex.valid)
+		BuildStringIndex();
+
+	auto it = stringIndex.ids.find(str);
+	if (it != stringIndex.ids.end())
+		return it->second;
 
 	return 0xFFFFFFFF;
 }
 
 int NiHeader::AddOrFindStringId(const std::string& str, const bool addEmpty) {
-	for (int i = 0; i < strings.size(); i++)
-		if (strings[i].GetString().compare(str) == 0)
-			return i;
+	int id = FindStringId(str);
+	if (id >= 0)
+		return id;
 
 	if (!addEmpty && str.empty())
 		return 0xFFFFFFFF;
@@ -443,25 +1251,34 @@ int NiHeader::AddOrFindStringId(const std::string& str, const bool addEmpty) {
 	strings.push_back(niStr);
 	numStrings++;
 
+	stringIndex.ids.emplace(strings.back().GetString(), r);
 	return r;
 }
 
 std::string NiHeader::GetStringById(const int id) {
-	if (id >= 0 && id < numStrings)
+	if (id >= 0 && (uint)id < numStrings)
 		return strings[id].GetString();
 
 	return std::string();
 }
 
 void NiHeader::SetStringById(const int id, const std::string& str) {
-	if (id >= 0 && id < numStrings)
+	if (id >= 0 && (uint)id < numStrings) {
 		strings[id].SetString(str);
+		stringIndex.valid = false;
+	}
 }
 
 void NiHeader::ClearStrings() {
+	// Block sources refer to the old string IDs
+	DropBlockSources();
+
 	strings.clear();
 	numStrings = 0;
 	maxStringLen = 0;
+
+	stringIndex.ids.clear();
+	stringIndex.valid = true;
 }
 
 void NiHeader::UpdateMaxStringLength() {
@@ -475,34 +1292,44 @@ void NiHeader::FillStringRefs() {
 	if (version.File() < V20_1_0_1)
 		return;
 
-	for (auto &b : (*blocks)) {
-		std::set<StringRef*> stringRefs;
-		b->GetStringRefs(stringRefs);
+	for (auto &b : (*blocks))
+		FillStringRefs(b.get());
 
-		for (auto &r : stringRefs) {
-			int stringId = r->GetIndex();
+	nameIndexValid = false;
+}
 
-			// Check if string index is overflowing
-			if (stringId != 0xFFFFFFFF && stringId >= numStrings) {
-				stringId -= numStrings;
-				r->SetIndex(stringId);
-			}
+void NiHeader::FillStringRefs(NiObject* block) {
+	if (version.File() < V20_1_0_1)
+		return;
+
+	std::vector<StringRef*> stringRefs;
+	block->GetStringRefs(stringRefs);
 
-			std::string str = GetStringById(stringId);
-			r->SetString(str);
+	for (auto &r : stringRefs) {
+		int stringId = r->GetIndex();
+
+		// Check if string index is overflowing
+		if (stringId >= 0 && (uint)stringId >= numStrings) {
+			stringId -= numStrings;
+			r->SetIndex(stringId);
 		}
+
+		std::string str = GetStringById(stringId);
+		r->SetString(str);
 	}
 }
 
 void NiHeader::UpdateHeaderStrings(const bool hasUnknown) {
-	if (!hasUnknown)
+	// Undecoded blocks and block sources still refer to the current string IDs
+	if (!hasUnknown && numLazyBlocks == 0 && numBlockSources == 0)
 		ClearStrings();
 
 	if (version.File() < V20_1_0_1)
 		return;
 
+	std::vector<StringRef*> stringRefs;
 	for (auto &b : (*blocks)) {
-		std::set<StringRef*> stringRefs;
+		stringRefs.clear();
 		b->GetStringRefs(stringRefs);
 
 		for (auto &r : stringRefs) {
@@ -516,9 +1343,13 @@ void NiHeader::UpdateHeaderStrings(const bool hasUnknown) {
 }
 
 void NiHeader::BlockDeleted(NiObject* o, int blockId) {
-	std::set<Ref*> refs;
-	o->GetChildRefs(refs);
-	o->GetPtrs(refs);
+	std::vector<Ref*> refs;
+	BlockDeleted(o, blockId, refs);
+}
+
+void NiHeader::BlockDeleted(NiObject* o, int blockId, std::vector<Ref*>& refs) {
+	refs.clear();
+	o->GetRefs(refs);
 
 	for (auto &r : refs) {
 		int index = r->GetIndex();
@@ -530,9 +1361,13 @@ void NiHeader::BlockDeleted(NiObject* o, int blockId) {
 }
 
 void NiHeader::BlockSwapped(NiObject* o, int blockIndexLo, int blockIndexHi) {
-	std::set<Ref*> refs;
-	o->GetChildRefs(refs);
-	o->GetPtrs(refs);
+	std::vector<Ref*> refs;
+	BlockSwapped(o, blockIndexLo, blockIndexHi, refs);
+}
+
+void NiHeader::BlockSwapped(NiObject* o, int blockIndexLo, int blockIndexHi, std::vector<Ref*>& refs) {
+	refs.clear();
+	o->GetRefs(refs);
 
 	for (auto &r : refs) {
 		int index = r->GetIndex();
@@ -629,8 +1464,7 @@ void NiHeader::Get(NiStream& stream) {
 	else if (version.File() >= V30_0_0_2) {
 		stream >> embedDataSize;
 		embedData.resize(embedDataSize);
-		for (int i = 0; i < embedDataSize; i++)
-			stream >> embedData[i];
+		stream.readArray(embedData.data(), embedDataSize);
 	}
 
 	if (version.File() >= V5_0_0_1) {
@@ -640,14 +1474,12 @@ void NiHeader::Get(NiStream& stream) {
 			blockTypes[i].Get(stream, 4);
 
 		blockTypeIndices.resize(numBlocks);
-		for (int i = 0; i < numBlocks; i++)
-			stream >> blockTypeIndices[i];
+		stream.readArray(blockTypeIndices.data(), numBlocks);
 	}
 
 	if (version.File() >= V20_2_0_5) {
 		blockSizes.resize(numBlocks);
-		for (int i = 0; i < numBlocks; i++)
-			stream >> blockSizes[i];
+		stream.readArray(blockSizes.data(), numBlocks);
 	}
 
 	if (version.File() >= V20_1_0_1) {
@@ -657,13 +1489,14 @@ void NiHeader::Get(NiStream& stream) {
 		strings.resize(numStrings);
 		for (int i = 0; i < numStrings; i++)
 			strings[i].Get(stream, 4);
+
+		stringIndex.valid = false;
 	}
 
 	if (version.File() >= NiVersion::ToFile(5, 0, 0, 6)) {
 		stream >> numGroups;
 		groupSizes.resize(numGroups);
-		for (int i = 0; i < numGroups; i++)
-			stream >> groupSizes[i];
+		stream.readArray(groupSizes.data(), numGroups);
 	}
 
 	valid = true;
@@ -713,8 +1546,7 @@ void NiHeader::Put(NiStream& stream) {
 	}
 	else if (version.File() >= V30_0_0_2) {
 		stream << embedDataSize;
-		for (int i = 0; i < embedDataSize; i++)
-			stream << embedData[i];
+		stream.writeArray(embedData.data(), embedDataSize);
 	}
 
 	if (version.File() >= V5_0_0_1) {
@@ -722,14 +1554,12 @@ void NiHeader::Put(NiStream& stream) {
 		for (int i = 0; i < numBlockTypes; i++)
 			blockTypes[i].Put(stream, 4, false);
 
-		for (int i = 0; i < numBlocks; i++)
-			stream << blockTypeIndices[i];
+		stream.writeArray(blockTypeIndices.data(), numBlocks);
 	}
 
 	if (version.File() >= V20_2_0_5) {
 		blockSizePos = stream.tellp();
-		for (int i = 0; i < numBlocks; i++)
-			stream << blockSizes[i];
+		stream.writeArray(blockSizes.data(), numBlocks);
 	}
 
 	if (version.File() >= V20_1_0_1) {
@@ -741,8 +1571,7 @@ void NiHeader::Put(NiStream& stream) {
 
 	if (version.File() >= NiVersion::ToFile(5, 0, 0, 6)) {
 		stream << numGroups;
-		for (int i = 0; i < numGroups; i++)
-			stream << groupSizes[i];
+		stream.writeArray(groupSizes.data(), numGroups);
 	}
 }
 
@@ -773,3 +1602,55 @@ void NiUnknown::Put(NiStream& stream) {
 
 	stream.write(&data[0], blockSize);
 }
+
+static thread_local std::pmr::memory_resource* threadBlockResource = nullptr;
+
+std::pmr::memory_resource* BlockResource::Get() {
+	return threadBlockResource ? threadBlockResource : std::pmr::get_default_resource();
+}
+
+BlockResource::Scope::Scope(std::pmr::memory_resource* resource) {
+	previous = threadBlockResource;
+	threadBlockResource = resource;
+}
+
+BlockResource::Scope::~Scope() {
+	threadBlockResource = previous;
+}
+
+NiLazyBlock::NiLazyBlock(const std::string& name, const std::shared_ptr<const std::vector<char>>& data, const size_t dataOffset, const uint size) {
+	blockName = name;
+	source = data;
+	offset = dataOffset;
+	blockSize = size;
+}
+
+NiObject* NiLazyBlock::GetPrototype() {
+	if (!prototype) {
+		auto factory = NiFactoryRegister::Get().GetFactoryByName(blockName);
+		if (factory)
+			prototype = factory->Create();
+	}
+
+	return prototype.get();
+}
+
+std::shared_ptr<NiObject> NiLazyBlock::Decode(NiVersion& version, std::pmr::memory_resource* resource) {
+	auto factory = NiFactoryRegister::Get().GetFactoryByName(blockName);
+	if (!factory)
+		return nullptr;
+
+	NiStream stream(source->data() + offset, blockSize, &version);
+	auto block = factory->Load(stream, resource);
+
+	// Memory streams zero-fill past their end, so a block of the wrong size would decode silently
+	if (stream.IsOverrun() || stream.tellg() != std::streampos(blockSize))
+		return nullptr;
+
+	return block;
+}
+
+void NiLazyBlock::Put(NiStream& stream) {
+	if (blockSize > 0)
+		stream.write(source->data() + offset, blockSize);
+}
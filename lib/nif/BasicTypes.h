@@ -11,11 +11,16 @@ See the included LICENSE file
 #include <unordered_set>
 #include <map>
 #include <unordered_map>
+#include <deque>
+#include <string_view>
 #include <streambuf>
 #include <string>
 #include <algorithm>
 #include <memory>
+#include <memory_resource>
 #include <iostream>
+#include <cstring>
+#include <type_traits>
 
 enum NiFileVersion : uint {
 	V2_3 = 0x02030000,
@@ -133,35 +138,110 @@ private:
 	NiVersion* version = nullptr;
 	int blockSize = 0;
 
+	// Contiguous source used instead of the iostream when reading from memory
+	const char* memBegin = nullptr;
+	const char* memPos = nullptr;
+	const char* memEnd = nullptr;
+	bool memOverrun = false;
+
+	// Buffer used instead of the iostream when writing to memory
+	std::vector<char>* memOut = nullptr;
+
 public:
 	NiStream(std::iostream* stream, NiVersion* version) {
 		this->stream = stream;
 		this->version = version;
 	}
 
+	NiStream(const char* data, const size_t size, NiVersion* version) {
+		this->memBegin = data;
+		this->memPos = data;
+		this->memEnd = data + size;
+		this->version = version;
+	}
+
+	// Appends everything that is written to the buffer
+	NiStream(std::vector<char>* buffer, NiVersion* version) {
+		this->memOut = buffer;
+		this->version = version;
+	}
+
+	bool IsMemory() {
+		return memBegin != nullptr;
+	}
+
 	void write(const char* ptr, std::streamsize count) {
-		stream->write(ptr, count);
+		if (memOut)
+			memOut->insert(memOut->end(), ptr, ptr + count);
+		else
+			stream->write(ptr, count);
+
 		blockSize += count;
 	}
 
 	void writeline(const char* ptr, std::streamsize count) {
-		stream->write(ptr, count);
-		stream->write("\n", 1);
-		blockSize += count + 1;
+		write(ptr, count);
+		write("\n", 1);
 	}
 
 	void read(char* ptr, std::streamsize count) {
-		stream->read(ptr, count);
+		if (memBegin) {
+			if (count > memEnd - memPos) {
+				// Reading past the end, zero the remainder like a failed stream read would leave it unusable
+				std::streamsize avail = memEnd - memPos;
+				std::memcpy(ptr, memPos, avail);
+				std::memset(ptr + avail, 0, count - avail);
+				memPos = memEnd;
+				memOverrun = true;
+				return;
+			}
+
+			std::memcpy(ptr, memPos, count);
+			memPos += count;
+		}
+		else
+			stream->read(ptr, count);
 	}
 
 	void getline(char* ptr, std::streamsize maxCount) {
-		stream->getline(ptr, maxCount);
+		if (memBegin) {
+			if (maxCount <= 0)
+				return;
+
+			std::streamsize n = 0;
+			while (memPos < memEnd && n < maxCount - 1) {
+				char c = *memPos++;
+				if (c == '\n')
+					break;
+
+				ptr[n++] = c;
+			}
+
+			ptr[n] = 0;
+		}
+		else
+			stream->getline(ptr, maxCount);
 	}
 
 	std::streampos tellp() {
+		if (memOut)
+			return std::streampos(memOut->size());
+
 		return stream->tellp();
 	}
 
+	std::streampos tellg() {
+		if (memBegin)
+			return std::streampos(memPos - memBegin);
+
+		return stream->tellg();
+	}
+
+	// True if a read went past the end of a memory source
+	bool IsOverrun() {
+		return memOverrun;
+	}
+
 	// Be careful with sizes of structs and classes
 	template<typename T>
 	NiStream& operator<<(const T& t) {
@@ -176,6 +256,23 @@ public:
 		return *this;
 	}
 
+	// Reads count elements in one call, the file layout has to match sizeof(T).
+	// Files are little-endian like the host, so no byte swapping takes place.
+	template<typename T>
+	void readArray(T* ptr, const size_t count) {
+		static_assert(std::is_trivially_copyable<T>::value, "readArray requires trivially copyable types");
+		if (count > 0)
+			read((char*)ptr, sizeof(T) * count);
+	}
+
+	// Writes count elements in one call, the file layout has to match sizeof(T)
+	template<typename T>
+	void writeArray(const T* ptr, const size_t count) {
+		static_assert(std::is_trivially_copyable<T>::value, "writeArray requires trivially copyable types");
+		if (count > 0)
+			write((const char*)ptr, sizeof(T) * count);
+	}
+
 	void InitBlockSize() {
 		blockSize = 0;
 	}
@@ -196,7 +293,12 @@ private:
 public:
 	NiString() {};
 
-	std::string GetString() {
+	const std::string& GetString() const {
+		return str;
+	}
+
+	// Direct access for in-place edits
+	std::string& GetStringRef() {
 		return str;
 	}
 
@@ -223,7 +325,7 @@ private:
 	NiString str;
 
 public:
-	std::string GetString() {
+	const std::string& GetString() const {
 		return str.GetString();
 	}
 
@@ -259,6 +361,28 @@ public:
 	}
 };
 
+// Flat sink that blocks enumerate their references into.
+// insert() mirrors std::set, but duplicates are kept until the owner of the buffer removes them.
+template <typename T>
+class RefSink {
+private:
+	std::vector<T*>& refs;
+
+public:
+	explicit RefSink(std::vector<T*>& buffer) : refs(buffer) {}
+
+	void insert(T* ref) {
+		refs.push_back(ref);
+	}
+};
+
+// Sorts a reference list and removes duplicates, matching the iteration order of a std::set
+template <typename T>
+void UniqueRefs(std::vector<T*>& refs) {
+	std::sort(refs.begin(), refs.end());
+	refs.erase(std::unique(refs.begin(), refs.end()), refs.end());
+}
+
 class Ref {
 protected:
 	int index = 0xFFFFFFFF;
@@ -318,7 +442,7 @@ public:
 	virtual void SetBlockRef(const int id, const int index) = 0;
 	virtual void RemoveBlockRef(const int id) = 0;
 	virtual void GetIndices(std::vector<int>& indices) = 0;
-	virtual void GetIndexPtrs(std::set<Ref*>& indices) = 0;
+	virtual void GetIndexPtrs(RefSink<Ref>& indices) = 0;
 	virtual void SetIndices(const std::vector<int>& indices) = 0;
 };
 
@@ -423,7 +547,7 @@ public:
 			indices.push_back(r.GetIndex());
 	}
 
-	virtual void GetIndexPtrs(std::set<Ref*>& indices) override {
+	virtual void GetIndexPtrs(RefSink<Ref>& indices) override {
 		for (auto &r : refs)
 			indices.insert(&r);
 	}
@@ -471,9 +595,51 @@ public:
 	}
 };
 
+// Memory resource that the containers of blocks loaded on the current thread are allocated from
+class BlockResource {
+public:
+	// Resource set for this thread, the default resource if none is
+	static std::pmr::memory_resource* Get();
+
+	// Sets the resource of this thread until it goes out of scope
+	class Scope {
+	private:
+		std::pmr::memory_resource* previous = nullptr;
+
+	public:
+		Scope(std::pmr::memory_resource* resource);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+};
+
+// Allocator of block containers. New and copied containers take the resource of the current thread,
+// so blocks read while loading into an arena allocate their arrays from it and copies use the heap.
+template <typename T>
+class BlockAllocator : public std::pmr::polymorphic_allocator<T> {
+public:
+	BlockAllocator() : std::pmr::polymorphic_allocator<T>(BlockResource::Get()) {}
+	BlockAllocator(std::pmr::memory_resource* resource) : std::pmr::polymorphic_allocator<T>(resource) {}
+
+	template <typename U>
+	BlockAllocator(const BlockAllocator<U>& other) : std::pmr::polymorphic_allocator<T>(other.resource()) {}
+
+	BlockAllocator select_on_container_copy_construction() const {
+		return BlockAllocator();
+	}
+};
+
+// Array member of a block, for the bulk data that's worth allocating from the arena of a file
+template <typename T>
+using BlockVector = std::vector<T, BlockAllocator<T>>;
+
 class NiObject {
 protected:
 	uint blockSize = 0;
+	// Set by edits that don't go through the header, see NiHeader::IsBlockModified
+	bool edited = false;
 
 public:
 	virtual ~NiObject() {}
@@ -486,19 +652,93 @@ public:
 	virtual void Get(NiStream&) {}
 	virtual void Put(NiStream&) {}
 
-	virtual void GetStringRefs(std::set<StringRef*>&) {}
-	virtual void GetChildRefs(std::set<Ref*>&) {}
+	// Enumerate the string refs, child refs and pointers of the block
+	virtual void VisitStringRefs(RefSink<StringRef>&) {}
+	virtual void VisitChildRefs(RefSink<Ref>&) {}
+	virtual void VisitPtrs(RefSink<Ref>&) {}
 	virtual void GetChildIndices(std::vector<int>&) {}
-	virtual void GetPtrs(std::set<Ref*>&) {}
+
+	// Append to a flat list that stays sorted and free of duplicates
+	void GetStringRefs(std::vector<StringRef*>& refs) {
+		RefSink<StringRef> sink(refs);
+		VisitStringRefs(sink);
+		UniqueRefs(refs);
+	}
+
+	void GetChildRefs(std::vector<Ref*>& refs) {
+		RefSink<Ref> sink(refs);
+		VisitChildRefs(sink);
+		UniqueRefs(refs);
+	}
+
+	void GetPtrs(std::vector<Ref*>& refs) {
+		RefSink<Ref> sink(refs);
+		VisitPtrs(sink);
+		UniqueRefs(refs);
+	}
+
+	// Child refs and pointers together
+	void GetRefs(std::vector<Ref*>& refs) {
+		RefSink<Ref> sink(refs);
+		VisitChildRefs(sink);
+		VisitPtrs(sink);
+		UniqueRefs(refs);
+	}
+
+	// std::set adapters
+	void GetStringRefs(std::set<StringRef*>& refs) {
+		std::vector<StringRef*> list;
+		GetStringRefs(list);
+		refs.insert(list.begin(), list.end());
+	}
+
+	void GetChildRefs(std::set<Ref*>& refs) {
+		std::vector<Ref*> list;
+		GetChildRefs(list);
+		refs.insert(list.begin(), list.end());
+	}
+
+	void GetPtrs(std::set<Ref*>& refs) {
+		std::vector<Ref*> list;
+		GetPtrs(list);
+		refs.insert(list.begin(), list.end());
+	}
 
 	virtual NiObject* Clone() { return new NiObject(*this); }
 
+	void SetEdited() { edited = true; }
+	bool IsEdited() { return edited; }
+
 	template <typename T>
     bool HasType() {
         return dynamic_cast<const T*>(this) != nullptr;
 	}
 };
 
+// Block of a known type that is kept as bytes of the source file until it's first accessed.
+// The bytes of all lazy blocks of a file share one buffer, the header decodes them on demand.
+class NiLazyBlock : public NiObject {
+private:
+	std::string blockName;
+	std::shared_ptr<const std::vector<char>> source;
+	size_t offset = 0;
+	std::shared_ptr<NiObject> prototype;
+
+public:
+	NiLazyBlock(const std::string& name, const std::shared_ptr<const std::vector<char>>& data, const size_t dataOffset, const uint size);
+
+	const char* GetBlockName() { return blockName.c_str(); }
+
+	// Default constructed block of the same type, for type checks that don't need the contents
+	NiObject* GetPrototype();
+	// Decodes the block with the factory of its type, nullptr if it doesn't take up exactly its size.
+	// The block and its containers are allocated from resource if set.
+	std::shared_ptr<NiObject> Decode(NiVersion& version, std::pmr::memory_resource* resource = nullptr);
+
+	void Put(NiStream& stream);
+	NiLazyBlock* Clone() { return new NiLazyBlock(*this); }
+};
+
 class NiHeader : public NiObject {
 	/*
 	Minimum supported
@@ -542,11 +782,90 @@ private:
 
 	uint numStrings = 0;
 	uint maxStringLen = 0;
-	std::vector<NiString> strings;
+	// Deque keeps the strings in place when appending, the string index refers to them
+	std::deque<NiString> strings;
+
+	// Hash index from string contents to the first string ID, rebuilt lazily.
+	// Views point into this header's own strings, so copies start out empty.
+	struct StringIndex {
+		bool valid = false;
+		std::unordered_map<std::string_view, int> ids;
+
+		StringIndex() {}
+		StringIndex(const StringIndex&) {}
+		StringIndex& operator=(const StringIndex&) {
+			valid = false;
+			ids.clear();
+			return *this;
+		}
+	};
+
+	StringIndex stringIndex;
+
+	void BuildStringIndex();
 
 	uint numGroups = 0;
 	std::vector<uint> groupSizes;
 
+	// Block lookup indices, kept in sync with the blocks list
+	std::unordered_map<NiObject*, int> blockIndices;
+	// Block IDs of each block type in block order. Blocks loaded as NiUnknown, like filtered ones,
+	// are listed apart from the blocks of their type's class, so each list holds a single class.
+	struct TypeBlocks {
+		std::vector<int> known;
+		std::vector<int> unknown;
+	};
+
+	std::vector<TypeBlocks> blockTypeBlocks;
+
+	// Lazily built from block contents, verified on lookup
+	bool nameIndexValid = false;
+	std::unordered_map<std::string, std::vector<int>> nameIndex;
+	bool parentIndexValid = false;
+	std::unordered_map<int, int> parentIndex;
+
+	// Optional index of incoming references, one entry per reference.
+	// Outgoing lists hold what each block referenced when it was last indexed, so a block can be re-indexed on its own.
+	bool refIndexEnabled = false;
+	bool refIndexValid = false;
+	std::vector<std::vector<int>> incomingRefs;
+	std::vector<std::vector<int>> outgoingRefs;
+
+	// Number of blocks that are still NiLazyBlock
+	uint numLazyBlocks = 0;
+	// Memory that blocks decoded after loading are allocated from, owned by the file
+	std::pmr::memory_resource* blockResource = nullptr;
+
+	// Source bytes of decoded blocks that weren't accessed since loading, for pass-through saving.
+	// Renumbering blocks or rebuilding the string table invalidates them.
+	bool keepBlockSources = false;
+	bool trackBlockAccess = false;
+	uint numBlockSources = 0;
+	std::vector<std::shared_ptr<NiObject>> blockSources;
+
+	void RebuildBlockIndices();
+	void InvalidateContentIndices();
+	void FillStringRefs(NiObject* block);
+	NiObject* AccessBlock(const int blockId);
+	void SetDecodedBlock(const int blockId, std::shared_ptr<NiObject> decoded);
+	void AddTypeBlock(const ushort blockTypeId, const int blockId, NiObject* block);
+	void RemoveTypeBlock(const ushort blockTypeId, const int blockId);
+	bool HasTypeBlocks(const ushort blockTypeId);
+	void RemoveBlockType(const ushort blockTypeId);
+	void BuildNameIndex();
+	void BuildParentIndex();
+	bool ReferenceIndexCurrent();
+	void BuildReferenceIndex();
+	void UpdateReferenceIndex(const int blockId);
+	void AddIndexedRef(const int holderId, const int index);
+	void RemoveIndexedRef(const int holderId, const int index);
+	// Renumbers the reference index, newIndices maps old block IDs to new ones or 0xFFFFFFFF for deleted blocks
+	void RemapReferenceIndex(const std::vector<uint>& newIndices, const uint newNumBlocks);
+	const std::vector<int>& GetIncomingRefs(const int blockId);
+
+	// Moves the block at order[i] to index i, remapping all references in one pass
+	void ApplyBlockOrder(const std::vector<int>& order);
+
 public:
 	NiHeader() {};
 
@@ -575,32 +894,164 @@ public:
 
 	void SetBlockReference(std::vector<std::shared_ptr<NiObject>>* blockRef) {
 		blocks = blockRef;
+		RebuildBlockIndices();
 	};
 
 	uint GetNumBlocks() {
 		return numBlocks;
 	}
 
+	// Returns the block for editing, it counts as modified once access tracking has started.
+	// Use LoadBlock<T> for lookups that don't change the block.
 	template <class T>
     T* GetBlock(const int blockId) {
-		if (blockId >= 0 && blockId < numBlocks)
+		if (blockId >= 0 && (uint)blockId < numBlocks) {
+			if (numLazyBlocks > 0 || numBlockSources > 0)
+				return dynamic_cast<T*>(AccessBlock(blockId));
+
 			return dynamic_cast<T*>((*blocks)[blockId].get());
+		}
 
 		return nullptr;
 	}
 
-	int GetBlockID(NiObject* block) {
-		auto it = std::find_if(blocks->begin(), blocks->end(), [&block](const auto& ptr) {
-			return ptr.get() == block;
-		});
+	// Returns the block for reading, decodes it if it was loaded lazily without counting as an edit
+	template <class T>
+	T* LoadBlock(const int blockId) {
+		if (blockId >= 0 && (uint)blockId < numBlocks)
+			return dynamic_cast<T*>(numLazyBlocks > 0 ? LoadBlock(blockId) : (*blocks)[blockId].get());
 
-		if (it != blocks->end())
-			return std::distance(blocks->begin(), it);
+		return nullptr;
+	}
+
+	// Decodes the block if it was loaded lazily, returns the block
+	NiObject* LoadBlock(const int blockId);
+	// Decodes all lazily loaded blocks, needed before anything that follows references of all blocks.
+	// Returns false if a block couldn't be decoded, it stays a NiLazyBlock then.
+	bool LoadAllBlocks();
+	// Same as above, spread over up to numThreads threads (0 for one per core).
+	// Blocks decoded by a thread are allocated from its entry in threadResources if there is one,
+	// on a single thread they use the resource of SetBlockResource.
+	bool LoadAllBlocks(const uint numThreads, const std::vector<std::pmr::memory_resource*>& threadResources = {});
+	// Counts the blocks of the loaded file that were kept as NiLazyBlock
+	void SetLazyBlockCount(const uint count) {
+		numLazyBlocks = count;
+	}
+
+	// Blocks decoded from here on and their containers are allocated from resource, nullptr for the heap
+	void SetBlockResource(std::pmr::memory_resource* resource) {
+		blockResource = resource;
+	}
+
+	bool HasLazyBlocks() {
+		return numLazyBlocks > 0;
+	}
+
+	// Keeps the bytes of lazily loaded blocks when they're decoded,
+	// until the block is accessed once tracking has started
+	void SetKeepBlockSources(const bool keep) {
+		keepBlockSources = keep;
+	}
+
+	void StartBlockAccessTracking() {
+		trackBlockAccess = true;
+	}
+
+	// True if the block has to be encoded when saving, false if its bytes from the loaded file are still valid.
+	// Blocks become modified through GetBlock<T>, SetBlockModified, the reference edits below or their own edit functions.
+	bool IsBlockModified(const int blockId);
+	void SetBlockModified(const int blockId);
+	// Block to write instead when saving without encoding unmodified blocks
+	NiObject* GetBlockSource(const int blockId);
+	// Forgets the source bytes, all decoded blocks count as modified
+	void DropBlockSources();
+
+	int GetBlockID(NiObject* block) {
+		auto it = blockIndices.find(block);
+		if (it != blockIndices.end())
+			return it->second;
 
 		return 0xFFFFFFFF;
 	}
 
+	// Returns all blocks of type T in block order, for reading.
+	// Every list of the type index holds a single class, so only one block per list needs to be checked.
+	template <class T>
+	std::vector<T*> GetBlocks() {
+		std::vector<int> ids = GetBlockIDsOfType<T>();
+
+		std::vector<T*> result;
+		result.reserve(ids.size());
+		for (auto& id : ids) {
+			// Checked again as a block that fails to decode stays NiLazyBlock
+			auto block = dynamic_cast<T*>(numLazyBlocks > 0 ? LoadBlock(id) : (*blocks)[id].get());
+			if (block)
+				result.push_back(block);
+		}
+
+		return result;
+	}
+
+	// IDs of the blocks whose type is T or derived from it, in block order.
+	// Types are checked once per block type, so lazily loaded blocks aren't decoded.
+	template <class T>
+	std::vector<int> GetBlockIDsOfType() {
+		std::vector<int> ids;
+		for (auto& typeBlocks : blockTypeBlocks) {
+			for (auto list : { &typeBlocks.known, &typeBlocks.unknown }) {
+				if (list->empty())
+					continue;
+
+				NiObject* first = (*blocks)[list->front()].get();
+				if (numLazyBlocks > 0) {
+					auto lazy = dynamic_cast<NiLazyBlock*>(first);
+					if (lazy)
+						first = lazy->GetPrototype();
+				}
+
+				if (dynamic_cast<T*>(first))
+					ids.insert(ids.end(), list->begin(), list->end());
+			}
+		}
+
+		std::sort(ids.begin(), ids.end());
+		return ids;
+	}
+
+	// IDs of the named blocks (NiObjectNET) with the given name, in block order
+	std::vector<int> GetBlockIDsByName(const std::string& name);
+	// Renames a named block, keeping the name index up to date
+	void SetBlockName(const int blockId, const std::string& name);
+	// Has to be called after blocks were renamed through NiObjectNET::SetName directly
+	void InvalidateNameIndex();
+
+	// ID of the first node that has the block as a child or 0xFFFFFFFF
+	int GetParentID(const int blockId);
+
+	// Keeps an index of incoming references for parent and reference count lookups in O(degree).
+	// Block operations and the reference edits below keep it up to date. References don't know the
+	// block holding them, so any other edit of a block's references has to be reported with
+	// BlockReferencesEdited, or InvalidateReferenceIndex to rebuild it on its next use.
+	void SetReferenceIndex(const bool enable);
+	bool HasReferenceIndex() {
+		return refIndexEnabled;
+	}
+
+	// IDs of the blocks referencing the block, once per reference, in block order
+	std::vector<int> GetReferencingBlocks(const int blockId);
+
+	// Edit a reference held by the block holderId, the holder counts as modified
+	void SetBlockRef(const int holderId, Ref& ref, const int index);
+	void AddBlockRef(const int holderId, RefArray& refs, const int index);
+	void RemoveBlockRef(const int holderId, RefArray& refs, const int refId);
+
+	// Re-reads the references of a block after they were edited directly, the block counts as modified
+	void BlockReferencesEdited(const int blockId);
+	void InvalidateReferenceIndex();
+
 	void DeleteBlock(int blockId);
+	// Deletes all given blocks at once, remapping the references of the remaining blocks in a single pass
+	void DeleteBlocks(const std::set<int>& blockIds);
 	void DeleteBlockByType(const std::string& blockTypeStr, const bool orphanedOnly = false);
 	int AddBlock(NiObject* newBlock);
 	int ReplaceBlock(int oldBlockId, NiObject* newBlock);
@@ -612,26 +1063,25 @@ public:
 	bool IsBlockReferenced(const int blockId);
 	int GetBlockRefCount(const int blockId);
 
+	// Returns the candidate blocks that end up without references once
+	// unreferenced candidates are deleted, repeating until none are left
+	std::set<int> GetUnreferencedBlocks(const std::vector<bool>& candidates);
+
 	template <class T>
 	bool DeleteUnreferencedBlocks(const int rootId, int* deletionCount = nullptr) {
 		if (rootId == 0xFFFFFFFF)
 			return false;
 
-		for (int i = 0; i < numBlocks; i++) {
-			if (i != rootId) {
-				// Only check blocks of provided template type
-				auto block = GetBlock<T>(i);
-				if (block && !IsBlockReferenced(i)) {
-					DeleteBlock(i);
+		// Only check blocks of provided template type
+		std::vector<bool> candidates(numBlocks);
+		for (uint i = 0; i < numBlocks; i++)
+			candidates[i] = (int)i != rootId && LoadBlock<T>(i);
 
-					if (deletionCount)
-						(*deletionCount)++;
+		std::set<int> unreferenced = GetUnreferencedBlocks(candidates);
+		DeleteBlocks(unreferenced);
 
-					// Deleting a block can cause others to become unreferenced
-					return DeleteUnreferencedBlocks<T>(rootId > i ? rootId - 1 : rootId, deletionCount);
-				}
-			}
-		}
+		if (deletionCount)
+			(*deletionCount) += unreferenced.size();
 
 		return true;
 	}
@@ -641,6 +1091,7 @@ public:
 	ushort GetBlockTypeIndex(const int blockId);
 
 	uint GetBlockSize(const uint blockId);
+	void SetBlockSize(const uint blockId, const uint size);
 	std::streampos GetBlockSizeStreamPos();
 	void ResetBlockSizeStreamPos();
 
@@ -657,6 +1108,9 @@ public:
 
 	static void BlockDeleted(NiObject* o, int blockId);
 	static void BlockSwapped(NiObject* o, int blockIndexLo, int blockIndexHi);
+	// Same as above, reusing refs as scratch storage
+	static void BlockDeleted(NiObject* o, int blockId, std::vector<Ref*>& refs);
+	static void BlockSwapped(NiObject* o, int blockIndexLo, int blockIndexHi, std::vector<Ref*>& refs);
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
@@ -20,8 +20,8 @@ void NiExtraData::Put(NiStream& stream) {
 	name.Put(stream);
 }
 
-void NiExtraData::GetStringRefs(std::set<StringRef*>& refs) {
-	NiObject::GetStringRefs(refs);
+void NiExtraData::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiObject::VisitStringRefs(refs);
 
 	refs.insert(&name);
 }
@@ -40,16 +40,14 @@ void NiBinaryExtraData::Get(NiStream& stream) {
 
 	stream >> size;
 	data.resize(size);
-	for (int i = 0; i < size; i++)
-		stream >> data[i];
+	stream.readArray(data.data(), size);
 }
 
 void NiBinaryExtraData::Put(NiStream& stream) {
 	NiExtraData::Put(stream);
 
 	stream << size;
-	for (int i = 0; i < size; i++)
-		stream << data[i];
+	stream.writeArray(data.data(), size);
 }
 
 std::vector<byte> NiBinaryExtraData::GetData() {
@@ -88,16 +86,14 @@ void NiFloatsExtraData::Get(NiStream& stream) {
 
 	stream >> numFloats;
 	floatsData.resize(numFloats);
-	for (int i = 0; i < numFloats; i++)
-		stream >> floatsData[i];
+	stream.readArray(floatsData.data(), numFloats);
 }
 
 void NiFloatsExtraData::Put(NiStream& stream) {
 	NiExtraData::Put(stream);
 
 	stream << numFloats;
-	for (int i = 0; i < numFloats; i++)
-		stream << floatsData[i];
+	stream.writeArray(floatsData.data(), numFloats);
 }
 
 std::vector<float> NiFloatsExtraData::GetFloatsData() {
@@ -149,8 +145,8 @@ void NiStringExtraData::Put(NiStream& stream) {
 	stringData.Put(stream);
 }
 
-void NiStringExtraData::GetStringRefs(std::set<StringRef*>& refs) {
-	NiExtraData::GetStringRefs(refs);
+void NiStringExtraData::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiExtraData::VisitStringRefs(refs);
 
 	refs.insert(&stringData);
 }
@@ -211,16 +207,14 @@ void NiIntegersExtraData::Get(NiStream& stream) {
 
 	stream >> numIntegers;
 	integersData.resize(numIntegers);
-	for (int i = 0; i < numIntegers; i++)
-		stream >> integersData[i];
+	stream.readArray(integersData.data(), numIntegers);
 }
 
 void NiIntegersExtraData::Put(NiStream& stream) {
 	NiExtraData::Put(stream);
 
 	stream << numIntegers;
-	for (int i = 0; i < numIntegers; i++)
-		stream << integersData[i];
+	stream.writeArray(integersData.data(), numIntegers);
 }
 
 std::vector<uint> NiIntegersExtraData::GetIntegersData() {
@@ -280,16 +274,14 @@ void BSWArray::Get(NiStream& stream) {
 
 	stream >> numData;
 	data.resize(numData);
-	for (int i = 0; i < numData; i++)
-		stream >> data[i];
+	stream.readArray(data.data(), numData);
 }
 
 void BSWArray::Put(NiStream& stream) {
 	NiExtraData::Put(stream);
 
 	stream << numData;
-	for (int i = 0; i < numData; i++)
-		stream << data[i];
+	stream.writeArray(data.data(), numData);
 }
 
 std::vector<uint> BSWArray::GetData() {
@@ -307,16 +299,14 @@ void BSPositionData::Get(NiStream& stream) {
 
 	stream >> numData;
 	data.resize(numData);
-	for (int i = 0; i < numData; i++)
-		stream >> data[i];
+	stream.readArray(data.data(), numData);
 }
 
 void BSPositionData::Put(NiStream& stream) {
 	NiExtraData::Put(stream);
 
 	stream << numData;
-	for (int i = 0; i < numData; i++)
-		stream << data[i];
+	stream.writeArray(data.data(), numData);
 }
 
 std::vector<half_float::half> BSPositionData::GetData() {
@@ -334,16 +324,14 @@ void BSEyeCenterExtraData::Get(NiStream& stream) {
 
 	stream >> numData;
 	data.resize(numData);
-	for (int i = 0; i < numData; i++)
-		stream >> data[i];
+	stream.readArray(data.data(), numData);
 }
 
 void BSEyeCenterExtraData::Put(NiStream& stream) {
 	NiExtraData::Put(stream);
 
 	stream << numData;
-	for (int i = 0; i < numData; i++)
-		stream << data[i];
+	stream.writeArray(data.data(), numData);
 }
 
 std::vector<float> BSEyeCenterExtraData::GetData() {
@@ -361,13 +349,11 @@ void BSPackedGeomData::Get(NiStream& stream) {
 
 	stream >> lodLevels;
 	lod.resize(lodLevels);
-	for (int i = 0; i < lodLevels; i++)
-		stream >> lod[i];
+	stream.readArray(lod.data(), lodLevels);
 
 	stream >> numCombined;
 	combined.resize(numCombined);
-	for (int i = 0; i < numCombined; i++)
-		stream >> combined[i];
+	stream.readArray(combined.data(), numCombined);
 
 	stream >> unkInt1;
 	stream >> unkInt2;
@@ -377,12 +363,10 @@ void BSPackedGeomData::Put(NiStream& stream) {
 	stream << numVerts;
 
 	stream << lodLevels;
-	for (int i = 0; i < lodLevels; i++)
-		stream << lod[i];
+	stream.writeArray(lod.data(), lodLevels);
 
 	stream << numCombined;
-	for (int i = 0; i < numCombined; i++)
-		stream << combined[i];
+	stream.writeArray(combined.data(), numCombined);
 
 	stream << unkInt1;
 	stream << unkInt2;
@@ -402,8 +386,7 @@ void BSPackedCombinedSharedGeomDataExtra::Get(NiStream& stream) {
 	objects.resize(numData);
 	data.resize(numData);
 
-	for (int i = 0; i < numData; i++)
-		stream >> objects[i];
+	stream.readArray(objects.data(), numData);
 
 	for (int i = 0; i < numData; i++)
 		data[i].Get(stream);
@@ -419,8 +402,7 @@ void BSPackedCombinedSharedGeomDataExtra::Put(NiStream& stream) {
 	stream << unkFlags2;
 	stream << numData;
 
-	for (int i = 0; i < numData; i++)
-		stream << objects[i];
+	stream.writeArray(objects.data(), numData);
 
 	for (int i = 0; i < numData; i++)
 		data[i].Put(stream);
@@ -511,12 +493,10 @@ void BSDecalPlacementVectorExtraData::Get(NiStream& stream) {
 		stream >> decalVectorBlocks[i].numVectors;
 
 		decalVectorBlocks[i].points.resize(decalVectorBlocks[i].numVectors);
-		for (int j = 0; j < decalVectorBlocks[i].numVectors; j++)
-			stream >> decalVectorBlocks[i].points[j];
+		stream.readArray(decalVectorBlocks[i].points.data(), decalVectorBlocks[i].numVectors);
 
 		decalVectorBlocks[i].normals.resize(decalVectorBlocks[i].numVectors);
-		for (int j = 0; j < decalVectorBlocks[i].numVectors; j++)
-			stream >> decalVectorBlocks[i].normals[j];
+		stream.readArray(decalVectorBlocks[i].normals.data(), decalVectorBlocks[i].numVectors);
 	}
 }
 
@@ -528,11 +508,9 @@ void BSDecalPlacementVectorExtraData::Put(NiStream& stream) {
 	for (int i = 0; i < numVectorBlocks; i++) {
 		stream << decalVectorBlocks[i].numVectors;
 
-		for (int j = 0; j < decalVectorBlocks[i].numVectors; j++)
-			stream << decalVectorBlocks[i].points[j];
+		stream.writeArray(decalVectorBlocks[i].points.data(), decalVectorBlocks[i].numVectors);
 
-		for (int j = 0; j < decalVectorBlocks[i].numVectors; j++)
-			stream << decalVectorBlocks[i].normals[j];
+		stream.writeArray(decalVectorBlocks[i].normals.data(), decalVectorBlocks[i].numVectors);
 	}
 }
 
@@ -560,8 +538,8 @@ void BSBehaviorGraphExtraData::Put(NiStream& stream) {
 	stream << controlsBaseSkel;
 }
 
-void BSBehaviorGraphExtraData::GetStringRefs(std::set<StringRef*>& refs) {
-	NiExtraData::GetStringRefs(refs);
+void BSBehaviorGraphExtraData::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiExtraData::VisitStringRefs(refs);
 
 	refs.insert(&behaviorGraphFile);
 }
@@ -603,8 +581,8 @@ void BSBoneLODExtraData::Put(NiStream& stream) {
 	}
 }
 
-void BSBoneLODExtraData::GetStringRefs(std::set<StringRef*>& refs) {
-	NiExtraData::GetStringRefs(refs);
+void BSBoneLODExtraData::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiExtraData::VisitStringRefs(refs);
 
 	for (int i = 0; i < numBoneLODs; i++)
 		refs.insert(&boneLODs[i].boneName);
@@ -641,8 +619,8 @@ void NiTextKeyExtraData::Put(NiStream& stream) {
 	}
 }
 
-void NiTextKeyExtraData::GetStringRefs(std::set<StringRef*>& refs) {
-	NiExtraData::GetStringRefs(refs);
+void NiTextKeyExtraData::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiExtraData::VisitStringRefs(refs);
 
 	for (int i = 0; i < numTextKeys; i++)
 		refs.insert(&textKeys[i].value);
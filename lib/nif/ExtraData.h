@@ -17,7 +17,7 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
 
 	std::string GetName();
 	void SetName(const std::string& extraDataName);
@@ -83,7 +83,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
 	NiStringExtraData* Clone() { return new NiStringExtraData(*this); }
 
 	std::string GetStringData();
@@ -388,7 +388,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
 	BSBehaviorGraphExtraData* Clone() { return new BSBehaviorGraphExtraData(*this); }
 };
 
@@ -428,7 +428,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
 	BSBoneLODExtraData* Clone() { return new BSBoneLODExtraData(*this); }
 
 	std::vector<BoneLOD> GetBoneLODs();
@@ -446,7 +446,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
 	NiTextKeyExtraData* Clone() { return new NiTextKeyExtraData(*this); }
 
 	std::vector<Key<StringRef>> GetTextKeys();
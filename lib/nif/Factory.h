@@ -17,11 +17,13 @@ See the included LICENSE file
 #include "Skin.h"
 
 #include <unordered_map>
+#include <memory_resource>
 
 class NiFactory {
 public:
 	virtual std::shared_ptr<NiObject> Create() = 0;
 	virtual std::shared_ptr<NiObject> Load(NiStream& stream) = 0;
+	virtual std::shared_ptr<NiObject> Load(NiStream& stream, std::pmr::memory_resource* resource) = 0;
 };
 
 template<typename T>
@@ -38,6 +40,17 @@ public:
 		nio->Get(stream);
 		return nio;
 	}
+
+	// Load new NiObject from file, the object and its containers are allocated from the memory resource
+	virtual std::shared_ptr<NiObject> Load(NiStream& stream, std::pmr::memory_resource* resource) override {
+		if (!resource)
+			return Load(stream);
+
+		BlockResource::Scope scope(resource);
+		auto nio = std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(resource));
+		nio->Get(stream);
+		return nio;
+	}
 };
 
 class NiFactoryRegister {
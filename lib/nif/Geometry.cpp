@@ -8,6 +8,7 @@ See the included LICENSE file
 #include "Nodes.h"
 #include "utils/KDMatcher.h"
 #include "NifUtil.h"
+#include "VertexCodec.h"
 
 #include <algorithm>
 
@@ -84,8 +85,7 @@ void NiGeometryData::Get(NiStream& stream) {
 
 	if (hasVertices && !isPSys) {
 		vertices.resize(numVertices);
-		for (int i = 0; i < numVertices; i++)
-			stream >> vertices[i];
+		stream.readArray(vertices.data(), numVertices);
 	}
 
 	stream >> numUVSets;
@@ -102,18 +102,15 @@ void NiGeometryData::Get(NiStream& stream) {
 	if (hasNormals && !isPSys) {
 		normals.resize(numVertices);
 
-		for (int i = 0; i < numVertices; i++)
-			stream >> normals[i];
+		stream.readArray(normals.data(), numVertices);
 
 		if (nbtMethod) {
 			tangents.resize(numVertices);
 			bitangents.resize(numVertices);
 
-			for (int i = 0; i < numVertices; i++)
-				stream >> tangents[i];
+			stream.readArray(tangents.data(), numVertices);
 
-			for (int i = 0; i < numVertices; i++)
-				stream >> bitangents[i];
+			stream.readArray(bitangents.data(), numVertices);
 		}
 	}
 
@@ -122,16 +119,14 @@ void NiGeometryData::Get(NiStream& stream) {
 	stream >> hasVertexColors;
 	if (hasVertexColors && !isPSys) {
 		vertexColors.resize(numVertices);
-		for (int i = 0; i < numVertices; i++)
-			stream >> vertexColors[i];
+		stream.readArray(vertexColors.data(), numVertices);
 	}
 
 	if (numTextureSets > 0 && !isPSys) {
 		uvSets.resize(numTextureSets);
 		for (int i = 0; i < numTextureSets; i++) {
 			uvSets[i].resize(numVertices);
-			for (int j = 0; j < numVertices; j++)
-				stream >> uvSets[i][j];
+			stream.readArray(uvSets[i].data(), numVertices);
 		}
 	}
 
@@ -149,8 +144,7 @@ void NiGeometryData::Put(NiStream& stream) {
 	stream << hasVertices;
 
 	if (hasVertices && !isPSys) {
-		for (int i = 0; i < numVertices; i++)
-			stream << vertices[i];
+		stream.writeArray(vertices.data(), numVertices);
 	}
 
 	stream << numUVSets;
@@ -165,15 +159,12 @@ void NiGeometryData::Put(NiStream& stream) {
 
 	stream << hasNormals;
 	if (hasNormals && !isPSys) {
-		for (int i = 0; i < numVertices; i++)
-			stream << normals[i];
+		stream.writeArray(normals.data(), numVertices);
 
 		if (nbtMethod) {
-			for (int i = 0; i < numVertices; i++)
-				stream << tangents[i];
+			stream.writeArray(tangents.data(), numVertices);
 
-			for (int i = 0; i < numVertices; i++)
-				stream << bitangents[i];
+			stream.writeArray(bitangents.data(), numVertices);
 		}
 	}
 
@@ -181,22 +172,20 @@ void NiGeometryData::Put(NiStream& stream) {
 
 	stream << hasVertexColors;
 	if (hasVertexColors && !isPSys) {
-		for (int i = 0; i < numVertices; i++)
-			stream << vertexColors[i];
+		stream.writeArray(vertexColors.data(), numVertices);
 	}
 
 	if (numTextureSets > 0 && !isPSys) {
 		for (int i = 0; i < numTextureSets; i++)
-			for (int j = 0; j < numVertices; j++)
-				stream << uvSets[i][j];
+			stream.writeArray(uvSets[i].data(), numVertices);
 	}
 
 	stream << consistencyFlags;
 	additionalDataRef.Put(stream);
 }
 
-void NiGeometryData::GetChildRefs(std::set<Ref*>& refs) {
-	NiObject::GetChildRefs(refs);
+void NiGeometryData::VisitChildRefs(RefSink<Ref>& refs) {
+	NiObject::VisitChildRefs(refs);
 
 	refs.insert(&additionalDataRef);
 }
@@ -281,7 +270,7 @@ bool NiGeometryData::GetTriangles(std::vector<Triangle>&) { return false; }
 void NiGeometryData::SetTriangles(const std::vector<Triangle>&) { };
 
 void NiGeometryData::UpdateBounds() {
-	bounds = BoundingSphere(vertices);
+	bounds = BoundingSphere(vertices.data(), vertices.size());
 }
 
 void NiGeometryData::Create(const std::vector<Vector3>* verts, const std::vector<Triangle>*, const std::vector<Vector2>* texcoords, const std::vector<Vector3>* norms) {
@@ -317,7 +306,7 @@ void NiGeometryData::Create(const std::vector<Vector3>* verts, const std::vector
 
 	if (norms && norms->size() == numVertices) {
 		SetNormals(true);
-		normals = (*norms);
+		normals.assign(norms->begin(), norms->end());
 		CalcTangentSpace();
 	}
 	else {
@@ -489,11 +478,11 @@ void NiShape::UpdateBounds() {
 }
 
 int NiShape::GetBoneID(NiHeader& hdr, const std::string& boneName) {
-	auto boneCont = hdr.GetBlock<NiBoneContainer>(GetSkinInstanceRef());
+	auto boneCont = hdr.LoadBlock<NiBoneContainer>(GetSkinInstanceRef());
 	if (boneCont) {
 		int i = 0;
 		for (auto& bone : boneCont->GetBones()) {
-			auto node = hdr.GetBlock<NiNode>(bone.GetIndex());
+			auto node = hdr.LoadBlock<NiNode>(bone.GetIndex());
 			if (node && node->GetName() == boneName)
 				return i;
 			++i;
@@ -523,15 +512,15 @@ bool NiShape::ReorderTriangles(const std::vector<uint>& triInds) {
 	return true;
 }
 
-const std::vector<Vector3>* NiShape::get_vertices() {
+const BlockVector<Vector3>* NiShape::get_vertices() {
 	return nullptr;
 }
 
-const std::vector<Vector2>* NiShape::get_uv() {
+const BlockVector<Vector2>* NiShape::get_uv() {
 	return nullptr;
 }
 
-const std::vector<Vector3>* NiShape::get_normals(bool transform) {
+const BlockVector<Vector3>* NiShape::get_normals(bool transform) {
 	return nullptr;
 }
 
@@ -541,6 +530,84 @@ void NiShape::set_uv(const std::vector<Vector2> &uv) {}
 
 void NiShape::set_normals(const std::vector<Vector3> &normals) {}
 
+StridedSpan<const Vector3> NiShape::view_vertices() {
+	auto geomData = GetGeomData();
+	if (!geomData)
+		return StridedSpan<const Vector3>();
+
+	return geomData->vertices;
+}
+
+StridedSpan<const Vector2> NiShape::view_uv() {
+	auto geomData = GetGeomData();
+	if (!geomData || geomData->uvSets.empty())
+		return StridedSpan<const Vector2>();
+
+	return geomData->uvSets[0];
+}
+
+StridedSpan<const Vector3> NiShape::view_normals() {
+	auto geomData = GetGeomData();
+	if (!geomData)
+		return StridedSpan<const Vector3>();
+
+	return geomData->normals;
+}
+
+StridedSpan<Vector3> NiShape::edit_vertices() {
+	auto geomData = GetGeomData();
+	if (!geomData)
+		return StridedSpan<Vector3>();
+
+	SetEdited();
+	return geomData->vertices;
+}
+
+StridedSpan<Vector2> NiShape::edit_uv() {
+	auto geomData = GetGeomData();
+	if (!geomData || geomData->uvSets.empty())
+		return StridedSpan<Vector2>();
+
+	SetEdited();
+	return geomData->uvSets[0];
+}
+
+void NiShape::set_vertices(StridedSpan<const Vector3> vertices) {
+	auto geomData = GetGeomData();
+	if (!geomData)
+		return;
+
+	SetEdited();
+
+	if (vertices.size() != geomData->vertices.size()) {
+		std::vector<Vector3> verts(vertices.begin(), vertices.end());
+		geomData->Create(&verts, nullptr, nullptr, nullptr);
+	}
+	else
+		std::copy(vertices.begin(), vertices.end(), geomData->vertices.begin());
+}
+
+void NiShape::set_uv(StridedSpan<const Vector2> uv) {
+	auto geomData = GetGeomData();
+	if (!geomData || uv.size() != geomData->vertices.size())
+		return;
+
+	SetEdited();
+	geomData->SetUVs(true);
+	geomData->uvSets[0].assign(uv.begin(), uv.end());
+}
+
+void NiShape::set_normals(StridedSpan<const Vector3> normals) {
+	auto geomData = GetGeomData();
+	if (!geomData)
+		return;
+
+	SetEdited();
+
+	geomData->SetNormals(true);
+	geomData->normals.assign(normals.begin(), normals.end());
+}
+
 
 BSTriShape::BSTriShape() {
 	vertexDesc.SetFlag(VF_VERTEX);
@@ -565,8 +632,7 @@ void BSTriShape::Get(NiStream& stream) {
 	stream >> bounds;
 
 	if (stream.GetVersion().Stream() == 155)
-		for (int i = 0; i < 6; i++)
-			stream >> boundMinMax[i];
+		stream.readArray(boundMinMax, 6);
 
 	skinInstanceRef.Get(stream);
 	shaderPropertyRef.Get(stream);
@@ -588,75 +654,18 @@ void BSTriShape::Get(NiStream& stream) {
 	vertData.resize(numVertices);
 
 	if (dataSize > 0) {
-		half_float::half halfData;
-		for (int i = 0; i < numVertices; i++) {
-			auto& vertex = vertData[i];
-			if (HasVertices()) {
-				if (IsFullPrecision() || stream.GetVersion().Stream() == 100) {
-					// Full precision
-					stream >> vertex.vert;
-					stream >> vertex.bitangentX;
-				}
-				else {
-					// Half precision
-					stream.read((char*)&halfData, 2);
-					vertex.vert.x = halfData;
-					stream.read((char*)&halfData, 2);
-					vertex.vert.y = halfData;
-					stream.read((char*)&halfData, 2);
-					vertex.vert.z = halfData;
-
-					stream.read((char*)&halfData, 2);
-					vertex.bitangentX = halfData;
-				}
-			}
-
-			if (HasUVs()) {
-				stream.read((char*)&halfData, 2);
-				vertex.uv.u = halfData;
-				stream.read((char*)&halfData, 2);
-				vertex.uv.v = halfData;
-			}
-
-			if (HasNormals()) {
-				for (int j = 0; j < 3; j++)
-					stream >> vertex.normal[j];
-
-				stream >> vertex.bitangentY;
-
-				if (HasTangents()) {
-					for (int j = 0; j < 3; j++)
-						stream >> vertex.tangent[j];
-
-					stream >> vertex.bitangentZ;
-				}
-			}
-
-
-			if (HasVertexColors())
-				for (int j = 0; j < 4; j++)
-					stream >> vertex.colorData[j];
-
-			if (IsSkinned()) {
-				for (int j = 0; j < 4; j++) {
-					stream.read((char*)&halfData, 2);
-					vertex.weights[j] = halfData;
-				}
-
-				for (int j = 0; j < 4; j++)
-					stream >> vertex.weightBones[j];
-			}
-
-			if (HasEyeData())
-				stream >> vertex.eyeData;
-		}
+		byte layout = GetVertexLayout(vertexDesc, IsFullPrecision() || stream.GetVersion().Stream() == 100);
+		std::vector<char> packed(numVertices * GetVertexLayoutSize(layout));
+		stream.readArray(packed.data(), packed.size());
+		DecodeVertices(layout, packed.data(), vertData.data(), numVertices);
 	}
 
+	InvalidateVertexStreams();
+
 	triangles.resize(numTriangles);
 
 	if (dataSize > 0) {
-		for (int i = 0; i < numTriangles; i++)
-			stream >> triangles[i];
+		stream.readArray(triangles.data(), numTriangles);
 	}
 
 	if (stream.GetVersion().User() == 12 && stream.GetVersion().Stream() == 100) {
@@ -667,27 +676,14 @@ void BSTriShape::Get(NiStream& stream) {
 			particleNorms.resize(numVertices);
 			particleTris.resize(numTriangles);
 
-			half_float::half halfData;
-			for (int i = 0; i < numVertices; i++) {
-				stream.read((char*)&halfData, 2);
-				particleVerts[i].x = halfData;
-				stream.read((char*)&halfData, 2);
-				particleVerts[i].y = halfData;
-				stream.read((char*)&halfData, 2);
-				particleVerts[i].z = halfData;
-			}
+			std::vector<ushort> halfData(numVertices * 3);
+			stream.readArray(halfData.data(), halfData.size());
+			HalfToFloat(halfData.data(), &particleVerts.data()->x, halfData.size());
 
-			for (int i = 0; i < numVertices; i++) {
-				stream.read((char*)&halfData, 2);
-				particleNorms[i].x = halfData;
-				stream.read((char*)&halfData, 2);
-				particleNorms[i].y = halfData;
-				stream.read((char*)&halfData, 2);
-				particleNorms[i].z = halfData;
-			}
+			stream.readArray(halfData.data(), halfData.size());
+			HalfToFloat(halfData.data(), &particleNorms.data()->x, halfData.size());
 
-			for (int i = 0; i < numTriangles; i++)
-				stream >> particleTris[i];
+			stream.readArray(particleTris.data(), numTriangles);
 		}
 	}
 }
@@ -707,8 +703,7 @@ void BSTriShape::Put(NiStream& stream) {
 	stream << bounds;
 
 	if (stream.GetVersion().Stream() == 155)
-		for (int i = 0; i < 6; i++)
-			stream << boundMinMax[i];
+		stream.writeArray(boundMinMax, 6);
 
 	skinInstanceRef.Put(stream);
 	shaderPropertyRef.Put(stream);
@@ -741,73 +736,14 @@ void BSTriShape::Put(NiStream& stream) {
 		stream << dataSize;
 
 		if (dataSize > 0) {
-			half_float::half halfData;
-			for (int i = 0; i < numVertices; i++) {
-				auto& vertex = vertData[i];
-				if (HasVertices()) {
-					if (IsFullPrecision() || stream.GetVersion().Stream() == 100) {
-						// Full precision
-						stream << vertex.vert;
-						stream << vertex.bitangentX;
-					}
-					else {
-						// Half precision
-						halfData = vertex.vert.x;
-						stream.write((char*)&halfData, 2);
-						halfData = vertex.vert.y;
-						stream.write((char*)&halfData, 2);
-						halfData = vertex.vert.z;
-						stream.write((char*)&halfData, 2);
-
-						halfData = vertex.bitangentX;
-						stream.write((char*)&halfData, 2);
-					}
-				}
-
-				if (HasUVs()) {
-					halfData = vertex.uv.u;
-					stream.write((char*)&halfData, 2);
-
-					halfData = vertex.uv.v;
-					stream.write((char*)&halfData, 2);
-				}
-
-				if (HasNormals()) {
-					for (int j = 0; j < 3; j++)
-						stream << vertex.normal[j];
-
-					stream << vertex.bitangentY;
-
-					if (HasTangents()) {
-						for (int j = 0; j < 3; j++)
-							stream << vertex.tangent[j];
-
-						stream << vertex.bitangentZ;
-					}
-				}
-
-				if (HasVertexColors())
-					for (int j = 0; j < 4; j++)
-						stream << vertex.colorData[j];
-
-				if (IsSkinned()) {
-					for (int j = 0; j < 4; j++) {
-						halfData = vertex.weights[j];
-						stream.write((char*)&halfData, 2);
-					}
-
-					for (int j = 0; j < 4; j++)
-						stream << vertex.weightBones[j];
-				}
-
-				if (HasEyeData())
-					stream << vertex.eyeData;
-			}
+			byte layout = GetVertexLayout(vertexDesc, IsFullPrecision() || stream.GetVersion().Stream() == 100);
+			std::vector<char> packed(numVertices * GetVertexLayoutSize(layout));
+			EncodeVertices(layout, vertData.data(), packed.data(), numVertices);
+			stream.writeArray(packed.data(), packed.size());
 		}
 
 		if (dataSize > 0) {
-			for (int i = 0; i < numTriangles; i++)
-				stream << triangles[i];
+			stream.writeArray(triangles.data(), numTriangles);
 		}
 	}
 
@@ -815,27 +751,14 @@ void BSTriShape::Put(NiStream& stream) {
 		stream << particleDataSize;
 
 		if (particleDataSize > 0) {
-			half_float::half halfData;
-			for (int i = 0; i < numVertices; i++) {
-				halfData = particleVerts[i].x;
-				stream.write((char*)&halfData, 2);
-				halfData = particleVerts[i].y;
-				stream.write((char*)&halfData, 2);
-				halfData = particleVerts[i].z;
-				stream.write((char*)&halfData, 2);
-			}
+			std::vector<ushort> halfData(numVertices * 3);
+			FloatToHalf(&particleVerts.data()->x, halfData.data(), halfData.size());
+			stream.writeArray(halfData.data(), halfData.size());
 
-			for (int i = 0; i < numVertices; i++) {
-				halfData = particleNorms[i].x;
-				stream.write((char*)&halfData, 2);
-				halfData = particleNorms[i].y;
-				stream.write((char*)&halfData, 2);
-				halfData = particleNorms[i].z;
-				stream.write((char*)&halfData, 2);
-			}
+			FloatToHalf(&particleNorms.data()->x, halfData.data(), halfData.size());
+			stream.writeArray(halfData.data(), halfData.size());
 
-			for (int i = 0; i < numTriangles; i++)
-				stream << particleTris[i];
+			stream.writeArray(particleTris.data(), numTriangles);
 		}
 	}
 }
@@ -847,6 +770,7 @@ void BSTriShape::notifyVerticesDelete(const std::vector<ushort>& vertIndices) {
 
 	EraseVectorIndices(vertData, vertIndices);
 	numVertices = vertData.size();
+	InvalidateVertexStreams();
 
 	ApplyMapToTriangles(triangles, indexCollapse, &deletedTris);
 	numTriangles = triangles.size();
@@ -854,8 +778,8 @@ void BSTriShape::notifyVerticesDelete(const std::vector<ushort>& vertIndices) {
 	std::sort(deletedTris.begin(), deletedTris.end(), std::greater<>());
 }
 
-void BSTriShape::GetChildRefs(std::set<Ref*>& refs) {
-	NiAVObject::GetChildRefs(refs);
+void BSTriShape::VisitChildRefs(RefSink<Ref>& refs) {
+	NiAVObject::VisitChildRefs(refs);
 
 	refs.insert(&skinInstanceRef);
 	refs.insert(&shaderPropertyRef);
@@ -894,15 +818,12 @@ void BSTriShape::SetAlphaPropertyRef(int alphaPropRef) {
 	alphaPropertyRef.SetIndex(alphaPropRef);
 }
 
-std::vector<Vector3>* BSTriShape::GetRawVerts() {
-	rawVertices.resize(numVertices);
-	for (int i = 0; i < numVertices; i++)
-		rawVertices[i] = vertData[i].vert;
-
-	return &rawVertices;
+BlockVector<Vector3>* BSTriShape::GetRawVerts() {
+	GetPositionStream();
+	return &vertexStreams.positions;
 }
 
-std::vector<Vector3>* BSTriShape::GetNormalData(bool xform) {
+BlockVector<Vector3>* BSTriShape::GetNormalData(bool xform) {
 	if (!HasNormals())
 		return nullptr;
 
@@ -931,7 +852,7 @@ std::vector<Vector3>* BSTriShape::GetNormalData(bool xform) {
 	return &rawNormals;
 }
 
-std::vector<Vector3>* BSTriShape::GetTangentData(bool xform) {
+BlockVector<Vector3>* BSTriShape::GetTangentData(bool xform) {
 	if (!HasTangents())
 		return nullptr;
 
@@ -959,7 +880,7 @@ std::vector<Vector3>* BSTriShape::GetTangentData(bool xform) {
 	return &rawTangents;
 }
 
-std::vector<Vector3>* BSTriShape::GetBitangentData(bool xform) {
+BlockVector<Vector3>* BSTriShape::GetBitangentData(bool xform) {
 	if (!HasTangents())
 		return nullptr;
 
@@ -984,18 +905,15 @@ std::vector<Vector3>* BSTriShape::GetBitangentData(bool xform) {
 	return &rawBitangents;
 }
 
-std::vector<Vector2>* BSTriShape::GetUVData() {
+BlockVector<Vector2>* BSTriShape::GetUVData() {
 	if (!HasUVs())
 		return nullptr;
 
-	rawUvs.resize(numVertices);
-	for (int i = 0; i < numVertices; i++)
-		rawUvs[i] = vertData[i].uv;
-
-	return &rawUvs;
+	GetUVStream();
+	return &vertexStreams.uvs;
 }
 
-std::vector<Color4>* BSTriShape::GetColorData() {
+BlockVector<Color4>* BSTriShape::GetColorData() {
 	if (!HasVertexColors())
 		return nullptr;
 
@@ -1010,7 +928,7 @@ std::vector<Color4>* BSTriShape::GetColorData() {
 	return &rawColors;
 }
 
-std::vector<float>* BSTriShape::GetEyeData() {
+BlockVector<float>* BSTriShape::GetEyeData() {
 	if (!HasEyeData())
 		return nullptr;
 
@@ -1021,22 +939,179 @@ std::vector<float>* BSTriShape::GetEyeData() {
 	return &rawEyeData;
 }
 
+Span<const Vector3> BSTriShape::GetPositionStream() {
+	if (!IsVertexStreamValid(BSVertexStreams::POSITIONS)) {
+		vertexStreams.positions.resize(numVertices);
+		for (int i = 0; i < numVertices; i++)
+			vertexStreams.positions[i] = vertData[i].vert;
+
+		vertexStreams.valid |= BSVertexStreams::POSITIONS;
+	}
+
+	return vertexStreams.positions;
+}
+
+Span<const Vector2> BSTriShape::GetUVStream() {
+	if (!HasUVs())
+		return Span<const Vector2>();
+
+	if (!IsVertexStreamValid(BSVertexStreams::UVS)) {
+		vertexStreams.uvs.resize(numVertices);
+		for (int i = 0; i < numVertices; i++)
+			vertexStreams.uvs[i] = vertData[i].uv;
+
+		vertexStreams.valid |= BSVertexStreams::UVS;
+	}
+
+	return vertexStreams.uvs;
+}
+
+Span<const Vector3> BSTriShape::GetNormalStream() {
+	if (!HasNormals())
+		return Span<const Vector3>();
+
+	if (!IsVertexStreamValid(BSVertexStreams::NORMALS)) {
+		vertexStreams.normals.resize(numVertices);
+		for (int i = 0; i < numVertices; i++) {
+			vertexStreams.normals[i].x = (((float)vertData[i].normal[0]) / 255.0f) * 2.0f - 1.0f;
+			vertexStreams.normals[i].y = (((float)vertData[i].normal[1]) / 255.0f) * 2.0f - 1.0f;
+			vertexStreams.normals[i].z = (((float)vertData[i].normal[2]) / 255.0f) * 2.0f - 1.0f;
+		}
+
+		vertexStreams.valid |= BSVertexStreams::NORMALS;
+	}
+
+	return vertexStreams.normals;
+}
+
+Span<const Vector3> BSTriShape::GetTangentStream() {
+	if (!HasTangents())
+		return Span<const Vector3>();
+
+	if (!IsVertexStreamValid(BSVertexStreams::TANGENTS)) {
+		vertexStreams.tangents.resize(numVertices);
+		for (int i = 0; i < numVertices; i++) {
+			vertexStreams.tangents[i].x = (((float)vertData[i].tangent[0]) / 255.0f) * 2.0f - 1.0f;
+			vertexStreams.tangents[i].y = (((float)vertData[i].tangent[1]) / 255.0f) * 2.0f - 1.0f;
+			vertexStreams.tangents[i].z = (((float)vertData[i].tangent[2]) / 255.0f) * 2.0f - 1.0f;
+		}
+
+		vertexStreams.valid |= BSVertexStreams::TANGENTS;
+	}
+
+	return vertexStreams.tangents;
+}
+
+Span<const Vector3> BSTriShape::GetBitangentStream() {
+	if (!HasTangents())
+		return Span<const Vector3>();
+
+	if (!IsVertexStreamValid(BSVertexStreams::BITANGENTS)) {
+		vertexStreams.bitangents.resize(numVertices);
+		for (int i = 0; i < numVertices; i++) {
+			vertexStreams.bitangents[i].x = vertData[i].bitangentX;
+			vertexStreams.bitangents[i].y = (((float)vertData[i].bitangentY) / 255.0f) * 2.0f - 1.0f;
+			vertexStreams.bitangents[i].z = (((float)vertData[i].bitangentZ) / 255.0f) * 2.0f - 1.0f;
+		}
+
+		vertexStreams.valid |= BSVertexStreams::BITANGENTS;
+	}
+
+	return vertexStreams.bitangents;
+}
+
+Span<const Color4> BSTriShape::GetColorStream() {
+	if (!HasVertexColors())
+		return Span<const Color4>();
+
+	if (!IsVertexStreamValid(BSVertexStreams::COLORS)) {
+		vertexStreams.colors.resize(numVertices);
+		for (int i = 0; i < numVertices; i++) {
+			vertexStreams.colors[i].r = vertData[i].colorData[0] / 255.0f;
+			vertexStreams.colors[i].g = vertData[i].colorData[1] / 255.0f;
+			vertexStreams.colors[i].b = vertData[i].colorData[2] / 255.0f;
+			vertexStreams.colors[i].a = vertData[i].colorData[3] / 255.0f;
+		}
+
+		vertexStreams.valid |= BSVertexStreams::COLORS;
+	}
+
+	return vertexStreams.colors;
+}
+
+Span<const std::array<float, 4>> BSTriShape::GetWeightStream() {
+	if (!IsSkinned())
+		return Span<const std::array<float, 4>>();
+
+	if (!IsVertexStreamValid(BSVertexStreams::WEIGHTS)) {
+		vertexStreams.weights.resize(numVertices);
+		vertexStreams.boneIndices.resize(numVertices);
+		for (int i = 0; i < numVertices; i++) {
+			std::copy(vertData[i].weights, vertData[i].weights + 4, vertexStreams.weights[i].begin());
+			std::copy(vertData[i].weightBones, vertData[i].weightBones + 4, vertexStreams.boneIndices[i].begin());
+		}
+
+		vertexStreams.valid |= BSVertexStreams::WEIGHTS;
+	}
+
+	return vertexStreams.weights;
+}
+
+Span<const std::array<byte, 4>> BSTriShape::GetBoneIndexStream() {
+	if (!IsSkinned())
+		return Span<const std::array<byte, 4>>();
+
+	// Filled together with the weights
+	GetWeightStream();
+	return vertexStreams.boneIndices;
+}
+
+Span<const float> BSTriShape::GetEyeDataStream() {
+	if (!HasEyeData())
+		return Span<const float>();
+
+	if (!IsVertexStreamValid(BSVertexStreams::EYEDATA)) {
+		vertexStreams.eyeData.resize(numVertices);
+		for (int i = 0; i < numVertices; i++)
+			vertexStreams.eyeData[i] = vertData[i].eyeData;
+
+		vertexStreams.valid |= BSVertexStreams::EYEDATA;
+	}
+
+	return vertexStreams.eyeData;
+}
+
+void BSTriShape::InvalidateVertexStreams() {
+	vertexStreams.valid = 0;
+	vertexStreams.editing = 0;
+}
+
+bool BSTriShape::IsVertexStreamValid(const uint stream) {
+	// vertData may still be written through a view handed out earlier, so the cached copy can't be trusted
+	if (vertexStreams.editing & stream)
+		return false;
+
+	return (vertexStreams.valid & stream) != 0;
+}
+
 ushort BSTriShape::GetNumVertices() {
 	return numVertices;
 }
 
-const std::vector<Vector3>* BSTriShape::get_vertices() {
+const BlockVector<Vector3>* BSTriShape::get_vertices() {
 	return GetRawVerts();
 }
 
-const std::vector<Vector3>* BSTriShape::get_normals(bool transform) {
+const BlockVector<Vector3>* BSTriShape::get_normals(bool transform) {
 	return GetNormalData(transform);
 }
-const std::vector<Vector2>* BSTriShape::get_uv() {
+const BlockVector<Vector2>* BSTriShape::get_uv() {
 	return GetUVData();
 }
 
 void BSTriShape::set_vertices(const std::vector<Vector3> &vertices) {
+	SetEdited();
+
 	if (vertices.size() != GetNumVertices())
 	{
 		Create(&vertices, nullptr, nullptr, nullptr);
@@ -1045,6 +1120,8 @@ void BSTriShape::set_vertices(const std::vector<Vector3> &vertices) {
 	{
 		for (int i = 0; i < GetNumVertices(); i++)
 			vertData[i].vert = vertices[i];
+
+		InvalidateVertexStreams();
 	}
 }
 
@@ -1052,16 +1129,99 @@ void BSTriShape::set_uv(const std::vector<Vector2> &uv) {
 	if (uv.size() != vertData.size())
 		return;
 
+	SetEdited();
 	SetUVs(true);
 
 	for (int i = 0; i < GetNumVertices(); i++)
 		vertData[i].uv = uv[i];
+
+	InvalidateVertexStreams();
 }
 
 void BSTriShape::set_normals(const std::vector<Vector3> &normals) {
+	SetEdited();
 	SetNormals(normals);
 }
 
+StridedSpan<const Vector3> BSTriShape::view_vertices() {
+	if (vertData.empty())
+		return StridedSpan<const Vector3>();
+
+	return StridedSpan<const Vector3>(&vertData[0].vert, vertData.size(), sizeof(BSVertexData));
+}
+
+StridedSpan<const Vector2> BSTriShape::view_uv() {
+	if (!HasUVs() || vertData.empty())
+		return StridedSpan<const Vector2>();
+
+	return StridedSpan<const Vector2>(&vertData[0].uv, vertData.size(), sizeof(BSVertexData));
+}
+
+StridedSpan<const Vector3> BSTriShape::view_normals() {
+	// Normals are packed into bytes, so this is the unpacked stream
+	return GetNormalStream();
+}
+
+StridedSpan<Vector3> BSTriShape::edit_vertices() {
+	if (vertData.empty())
+		return StridedSpan<Vector3>();
+
+	SetEdited();
+	vertexStreams.editing |= BSVertexStreams::POSITIONS;
+	return StridedSpan<Vector3>(&vertData[0].vert, vertData.size(), sizeof(BSVertexData));
+}
+
+StridedSpan<Vector2> BSTriShape::edit_uv() {
+	if (!HasUVs() || vertData.empty())
+		return StridedSpan<Vector2>();
+
+	SetEdited();
+	vertexStreams.editing |= BSVertexStreams::UVS;
+	return StridedSpan<Vector2>(&vertData[0].uv, vertData.size(), sizeof(BSVertexData));
+}
+
+void BSTriShape::set_vertices(StridedSpan<const Vector3> vertices) {
+	SetEdited();
+
+	if (vertices.size() != GetNumVertices()) {
+		std::vector<Vector3> verts(vertices.begin(), vertices.end());
+		Create(&verts, nullptr, nullptr, nullptr);
+		return;
+	}
+
+	for (int i = 0; i < GetNumVertices(); i++)
+		vertData[i].vert = vertices[i];
+
+	InvalidateVertexStreams();
+}
+
+void BSTriShape::set_uv(StridedSpan<const Vector2> uv) {
+	if (uv.size() != vertData.size())
+		return;
+
+	SetEdited();
+	SetUVs(true);
+
+	for (int i = 0; i < GetNumVertices(); i++)
+		vertData[i].uv = uv[i];
+
+	InvalidateVertexStreams();
+}
+
+void BSTriShape::set_normals(StridedSpan<const Vector3> normals) {
+	SetEdited();
+	SetNormals(true);
+
+	size_t count = std::min(normals.size(), vertData.size());
+	for (size_t i = 0; i < count; i++) {
+		vertData[i].normal[0] = (unsigned char)round((((normals[i].x + 1.0f) / 2.0f) * 255.0f));
+		vertData[i].normal[1] = (unsigned char)round((((normals[i].y + 1.0f) / 2.0f) * 255.0f));
+		vertData[i].normal[2] = (unsigned char)round((((normals[i].z + 1.0f) / 2.0f) * 255.0f));
+	}
+
+	InvalidateVertexStreams();
+}
+
 void BSTriShape::SetVertices(const bool enable) {
 	if (enable) {
 		vertexDesc.SetFlag(VF_VERTEX);
@@ -1078,6 +1238,8 @@ void BSTriShape::SetVertices(const bool enable) {
 		SetVertexColors(false);
 		SetSkinned(false);
 	}
+
+	InvalidateVertexStreams();
 }
 
 void BSTriShape::SetUVs(const bool enable) {
@@ -1117,6 +1279,8 @@ void BSTriShape::SetVertexColors(const bool enable) {
 				v.colorData[2] = 255;
 				v.colorData[3] = 255;
 			}
+
+			InvalidateVertexStreams();
 		}
 
 		vertexDesc.SetFlag(VF_COLORS);
@@ -1154,26 +1318,27 @@ uint BSTriShape::GetNumTriangles() {
 }
 
 bool BSTriShape::GetTriangles(std::vector<Triangle>& tris) {
-	tris = triangles;
+	tris.assign(triangles.begin(), triangles.end());
 	return true;
 }
 
 void BSTriShape::SetTriangles(const std::vector<Triangle>& tris) {
-	triangles = tris;
+	triangles.assign(tris.begin(), tris.end());
 	numTriangles = triangles.size();
 }
 
 void BSTriShape::UpdateBounds() {
-	GetRawVerts();
-	bounds = BoundingSphere(rawVertices);
+	auto verts = GetRawVerts();
+	bounds = BoundingSphere(verts->data(), verts->size());
 }
 
-void BSTriShape::SetVertexData(const std::vector<BSVertexData>& bsVertData) {
-	vertData = bsVertData;
+void BSTriShape::SetVertexData(Span<const BSVertexData> bsVertData) {
+	vertData.assign(bsVertData.begin(), bsVertData.end());
 	numVertices = vertData.size();
+	InvalidateVertexStreams();
 }
 
-void BSTriShape::SetNormals(const std::vector<Vector3>& inNorms) {
+void BSTriShape::SetNormals(Span<const Vector3> inNorms) {
 	SetNormals(true);
 
 	rawNormals.resize(numVertices);
@@ -1183,6 +1348,8 @@ void BSTriShape::SetNormals(const std::vector<Vector3>& inNorms) {
 		vertData[i].normal[1] = (unsigned char)round((((inNorms[i].y + 1.0f) / 2.0f) * 255.0f));
 		vertData[i].normal[2] = (unsigned char)round((((inNorms[i].z + 1.0f) / 2.0f) * 255.0f));
 	}
+
+	InvalidateVertexStreams();
 }
 
 void BSTriShape::SetTangentData(const std::vector<Vector3>& in) {
@@ -1193,6 +1360,8 @@ void BSTriShape::SetTangentData(const std::vector<Vector3>& in) {
 		vertData[i].tangent[1] = (unsigned char)round((((in[i].y + 1.0f) / 2.0f) * 255.0f));
 		vertData[i].tangent[2] = (unsigned char)round((((in[i].z + 1.0f) / 2.0f) * 255.0f));
 	}
+
+	InvalidateVertexStreams();
 }
 
 void BSTriShape::SetBitangentData(const std::vector<Vector3>& in) {
@@ -1203,6 +1372,8 @@ void BSTriShape::SetBitangentData(const std::vector<Vector3>& in) {
 		vertData[i].bitangentY = (unsigned char)round((((in[i].y + 1.0f) / 2.0f) * 255.0f));
 		vertData[i].bitangentZ = (unsigned char)round((((in[i].z + 1.0f) / 2.0f) * 255.0f));
 	}
+
+	InvalidateVertexStreams();
 }
 
 void BSTriShape::SetEyeData(const std::vector<float>& in) {
@@ -1210,9 +1381,12 @@ void BSTriShape::SetEyeData(const std::vector<float>& in) {
 
 	for (int i = 0; i < numVertices; i++)
 		vertData[i].eyeData = in[i];
+
+	InvalidateVertexStreams();
 }
 
-static void CalculateNormals(const std::vector<Vector3> &verts, const std::vector<Triangle> &tris, std::vector<Vector3> &norms, const bool smooth, float smoothThresh) {
+template<typename VertAlloc, typename TriAlloc, typename NormAlloc>
+static void CalculateNormals(const std::vector<Vector3, VertAlloc> &verts, const std::vector<Triangle, TriAlloc> &tris, std::vector<Vector3, NormAlloc> &norms, const bool smooth, float smoothThresh) {
 	// Zero norms
 	norms.clear();
 	norms.resize(verts.size());
@@ -1257,14 +1431,14 @@ static void CalculateNormals(const std::vector<Vector3> &verts, const std::vecto
 }
 
 void BSTriShape::RecalcNormals(const bool smooth, const float smoothThresh, std::unordered_set<uint>* lockedIndices) {
-	GetRawVerts();
+	Span<const Vector3> positions = GetPositionStream();
 	SetNormals(true);
 
 	std::vector<Vector3> verts(numVertices);
 	for (int i = 0; i < numVertices; i++) {
-		verts[i].x = rawVertices[i].x * -0.1f;
-		verts[i].z = rawVertices[i].y * 0.1f;
-		verts[i].y = rawVertices[i].z * 0.1f;
+		verts[i].x = positions[i].x * -0.1f;
+		verts[i].z = positions[i].y * 0.1f;
+		verts[i].y = positions[i].z * 0.1f;
 	}
 
 	std::vector<Vector3> norms;
@@ -1285,6 +1459,8 @@ void BSTriShape::RecalcNormals(const bool smooth, const float smoothThresh, std:
 		vertData[i].normal[1] = (unsigned char)round((((rawNormals[i].y + 1.0f) / 2.0f) * 255.0f));
 		vertData[i].normal[2] = (unsigned char)round((((rawNormals[i].z + 1.0f) / 2.0f) * 255.0f));
 	}
+
+	InvalidateVertexStreams();
 }
 
 void BSTriShape::CalcTangentSpace() {
@@ -1379,6 +1555,8 @@ void BSTriShape::CalcTangentSpace() {
 		vertData[i].bitangentY = (unsigned char)round((((rawBitangents[i].y + 1.0f) / 2.0f) * 255.0f));
 		vertData[i].bitangentZ = (unsigned char)round((((rawBitangents[i].z + 1.0f) / 2.0f) * 255.0f));
 	}
+
+	InvalidateVertexStreams();
 }
 
 int BSTriShape::CalcDataSizes(NiVersion& version) {
@@ -1454,6 +1632,7 @@ void BSTriShape::Create(const std::vector<Vector3>* verts, const std::vector<Tri
 		numTriangles = uint(triCount);
 
 	vertData.resize(numVertices);
+	InvalidateVertexStreams();
 
 	if (uvs && uvs->size() != numVertices)
 		SetUVs(false);
@@ -1896,8 +2075,7 @@ void BSDynamicTriShape::Get(NiStream& stream) {
 	stream >> dynamicDataSize;
 
 	dynamicData.resize(numVertices);
-	for (int i = 0; i < numVertices; i++)
-		stream >> dynamicData[i];
+	stream.readArray(dynamicData.data(), numVertices);
 }
 
 void BSDynamicTriShape::Put(NiStream& stream) {
@@ -1905,8 +2083,7 @@ void BSDynamicTriShape::Put(NiStream& stream) {
 
 	stream << dynamicDataSize;
 
-	for (int i = 0; i < numVertices; i++)
-		stream << dynamicData[i];
+	stream.writeArray(dynamicData.data(), numVertices);
 }
 
 void BSDynamicTriShape::notifyVerticesDelete(const std::vector<ushort>& vertIndices) {
@@ -1932,6 +2109,7 @@ void BSDynamicTriShape::CalcDynamicData() {
 		else
 			vertex.eyeData = 0.0f;
 	}
+	InvalidateVertexStreams();
 }
 
 void BSDynamicTriShape::Create(const std::vector<Vector3>* verts, const std::vector<Triangle>* tris, const std::vector<Vector2>* uvs, const std::vector<Vector3>* normals) {
@@ -2022,15 +2200,15 @@ void NiGeometry::Put(NiStream& stream) {
 	}
 }
 
-void NiGeometry::GetStringRefs(std::set<StringRef*>& refs) {
-	NiAVObject::GetStringRefs(refs);
+void NiGeometry::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiAVObject::VisitStringRefs(refs);
 
 	for (auto &m : materialNameRefs)
 		refs.insert(&m);
 }
 
-void NiGeometry::GetChildRefs(std::set<Ref*>& refs) {
-	NiAVObject::GetChildRefs(refs);
+void NiGeometry::VisitChildRefs(RefSink<Ref>& refs) {
+	NiAVObject::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 	refs.insert(&skinInstanceRef);
@@ -2128,8 +2306,7 @@ void NiTriShapeData::Get(NiStream& stream) {
 	for (int i = 0; i < numMatchGroups; i++) {
 		stream >> mg.count;
 		mg.matches.resize(mg.count);
-		for (int j = 0; j < mg.count; j++)
-			stream >> mg.matches[j];
+		stream.readArray(mg.matches.data(), mg.count);
 
 		matchGroups[i] = mg;
 	}
@@ -2146,15 +2323,13 @@ void NiTriShapeData::Put(NiStream& stream) {
 	stream << hasTriangles;
 
 	if (hasTriangles) {
-		for (int i = 0; i < numTriangles; i++)
-			stream << triangles[i];
+		stream.writeArray(triangles.data(), numTriangles);
 	}
 
 	stream << numMatchGroups;
 	for (int i = 0; i < numMatchGroups; i++) {
 		stream << matchGroups[i].count;
-		for (int j = 0; j < matchGroups[i].count; j++)
-			stream << matchGroups[i].matches[j];
+		stream.writeArray(matchGroups[i].matches.data(), matchGroups[i].count);
 	}
 }
 
@@ -2196,13 +2371,13 @@ uint NiTriShapeData::GetNumTriangles() {
 }
 
 bool NiTriShapeData::GetTriangles(std::vector<Triangle>& tris) {
-	tris = triangles;
+	tris.assign(triangles.begin(), triangles.end());
 	return hasTriangles;
 }
 
 void NiTriShapeData::SetTriangles(const std::vector<Triangle>& tris) {
 	hasTriangles = true;
-	triangles = tris;
+	triangles.assign(tris.begin(), tris.end());
 	numTriangles = triangles.size();
 	numTrianglePoints = numTriangles * 3;
 }
@@ -2298,36 +2473,39 @@ void NiTriShapeData::CalcTangentSpace() {
 	}
 }
 
-const std::vector<Vector3>* NiTriShape::get_vertices() {
+const BlockVector<Vector3>* NiTriShape::get_vertices() {
 	return &shapeData->vertices;
 }
 
-const std::vector<Vector3>* NiTriShape::get_normals(bool transform) {
+const BlockVector<Vector3>* NiTriShape::get_normals(bool transform) {
 	return &shapeData->normals;
 }
 
-const std::vector<Vector2>* NiTriShape::get_uv() {
+const BlockVector<Vector2>* NiTriShape::get_uv() {
 	return &shapeData->uvSets[0];
 }
 
 void NiTriShape::set_vertices(const std::vector<Vector3> &vertices) {
+	SetEdited();
 	if (vertices.size() != shapeData->vertices.size())
 		shapeData->Create(&vertices, nullptr, nullptr, nullptr);
 	else
-		shapeData->vertices = vertices;
+		shapeData->vertices.assign(vertices.begin(), vertices.end());
 }
 
 void NiTriShape::set_uv(const std::vector<Vector2> &uv) {
 	if (uv.size() != shapeData->vertices.size())
 		return;
 
+	SetEdited();
 	shapeData->SetUVs(true);
-	shapeData->uvSets[0] = uv;
+	shapeData->uvSets[0].assign(uv.begin(), uv.end());
 }
 
 void NiTriShape::set_normals(const std::vector<Vector3> &normals) {
+	SetEdited();
 	shapeData->SetNormals(true);
-	shapeData->normals = normals;
+	shapeData->normals.assign(normals.begin(), normals.end());
 }
 
 NiGeometryData* NiTriShape::GetGeomData() {
@@ -2346,16 +2524,14 @@ void NiTriStripsData::Get(NiStream& stream) {
 
 	stream >> numStrips;
 	stripLengths.resize(numStrips);
-	for (int i = 0; i < numStrips; i++)
-		stream >> stripLengths[i];
+	stream.readArray(stripLengths.data(), numStrips);
 
 	stream >> hasPoints;
 	if (hasPoints) {
 		points.resize(numStrips);
 		for (int i = 0; i < numStrips; i++) {
 			points[i].resize(stripLengths[i]);
-			for (int j = 0; j < stripLengths[i]; j++)
-				stream >> points[i][j];
+			stream.readArray(points[i].data(), stripLengths[i]);
 		}
 	}
 }
@@ -2364,14 +2540,12 @@ void NiTriStripsData::Put(NiStream& stream) {
 	NiTriBasedGeomData::Put(stream);
 
 	stream << numStrips;
-	for (int i = 0; i < numStrips; i++)
-		stream << stripLengths[i];
+	stream.writeArray(stripLengths.data(), numStrips);
 
 	stream << hasPoints;
 	if (hasPoints) {
 		for (int i = 0; i < numStrips; i++)
-			for (int j = 0; j < stripLengths[i]; j++)
-				stream << points[i][j];
+			stream.writeArray(points[i].data(), stripLengths[i]);
 	}
 }
 
@@ -2561,12 +2735,10 @@ void NiScreenElementsData::Get(NiStream& stream) {
 
 	stream >> maxPolygons;
 	polygons.resize(maxPolygons);
-	for (int i = 0; i < maxPolygons; i++)
-		stream >> polygons[i];
+	stream.readArray(polygons.data(), maxPolygons);
 
 	polygonIndices.resize(maxPolygons);
-	for (int i = 0; i < maxPolygons; i++)
-		stream >> polygonIndices[i];
+	stream.readArray(polygonIndices.data(), maxPolygons);
 
 	stream >> unkShort1;
 	stream >> numPolygons;
@@ -2580,11 +2752,9 @@ void NiScreenElementsData::Put(NiStream& stream) {
 	NiTriShapeData::Put(stream);
 
 	stream << maxPolygons;
-	for (int i = 0; i < maxPolygons; i++)
-		stream << polygons[i];
+	stream.writeArray(polygons.data(), maxPolygons);
 
-	for (int i = 0; i < maxPolygons; i++)
-		stream << polygonIndices[i];
+	stream.writeArray(polygonIndices.data(), maxPolygons);
 
 	stream << unkShort1;
 	stream << numPolygons;
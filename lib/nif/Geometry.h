@@ -8,7 +8,9 @@ See the included LICENSE file
 #include "BasicTypes.h"
 #include "Objects.h"
 #include "VertexData.h"
+#include "utils/Span.h"
 
+#include <array>
 #include <deque>
 
 struct AdditionalDataInfo {
@@ -218,21 +220,21 @@ protected:
 	BoundingSphere bounds;
 
 public:
-	std::vector<Vector3> vertices;
-	std::vector<Vector3> normals;
-	std::vector<Vector3> tangents;
-	std::vector<Vector3> bitangents;
-	std::vector<Color4> vertexColors;
+	BlockVector<Vector3> vertices;
+	BlockVector<Vector3> normals;
+	BlockVector<Vector3> tangents;
+	BlockVector<Vector3> bitangents;
+	BlockVector<Color4> vertexColors;
 
 	byte keepFlags = 0;
 	ushort numUVSets = 0;
-	std::vector<std::vector<Vector2>> uvSets;
+	BlockVector<BlockVector<Vector2>> uvSets;
 
 	ushort consistencyFlags = 0;
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 
 	void notifyVerticesDelete(const std::vector<ushort>& vertIndices);
@@ -305,14 +307,29 @@ public:
 	virtual void SetSkinned(const bool enable);
 	virtual bool IsSkinned();
 
-	virtual const std::vector<Vector3>* get_vertices();
-	virtual const std::vector<Vector2>* get_uv();
-	virtual const std::vector<Vector3>* get_normals(bool transform);
+	virtual const BlockVector<Vector3>* get_vertices();
+	virtual const BlockVector<Vector2>* get_uv();
+	virtual const BlockVector<Vector3>* get_normals(bool transform);
 
 	virtual void set_vertices(const std::vector<Vector3> &vertices);
 	virtual void set_uv(const std::vector<Vector2> &uv);
 	virtual void set_normals(const std::vector<Vector3> &normals);
 
+	// Views of the attributes without copying, empty if the attribute isn't present.
+	// Views stay valid until the shape's vertex data is resized or replaced.
+	virtual StridedSpan<const Vector3> view_vertices();
+	virtual StridedSpan<const Vector2> view_uv();
+	virtual StridedSpan<const Vector3> view_normals();
+
+	// Mutable views for editing attributes in place.
+	// Cached vertex streams of the attribute are refilled on each read until InvalidateVertexStreams() is called.
+	virtual StridedSpan<Vector3> edit_vertices();
+	virtual StridedSpan<Vector2> edit_uv();
+
+	virtual void set_vertices(StridedSpan<const Vector3> vertices);
+	virtual void set_uv(StridedSpan<const Vector2> uv);
+	virtual void set_normals(StridedSpan<const Vector3> normals);
+
 	virtual uint GetNumTriangles();
 	virtual bool GetTriangles(std::vector<Triangle>& tris);
 	virtual void SetTriangles(const std::vector<Triangle>& tris);
@@ -326,6 +343,35 @@ public:
 };
 
 
+// Deinterleaved copies of BSTriShape vertex attributes.
+// Each stream is filled from vertData on first access and reset when vertData changes.
+struct BSVertexStreams {
+	enum StreamBits : uint {
+		POSITIONS = 1 << 0,
+		UVS = 1 << 1,
+		NORMALS = 1 << 2,
+		TANGENTS = 1 << 3,
+		BITANGENTS = 1 << 4,
+		COLORS = 1 << 5,
+		WEIGHTS = 1 << 6,
+		EYEDATA = 1 << 7
+	};
+
+	BlockVector<Vector3> positions;
+	BlockVector<Vector2> uvs;
+	BlockVector<Vector3> normals;
+	BlockVector<Vector3> tangents;
+	BlockVector<Vector3> bitangents;
+	BlockVector<Color4> colors;
+	BlockVector<std::array<float, 4>> weights;
+	BlockVector<std::array<byte, 4>> boneIndices;
+	BlockVector<float> eyeData;
+
+	uint valid = 0;
+	// Streams whose attribute was handed out as a mutable view, refilled on every read until invalidated
+	uint editing = 0;
+};
+
 class BSTriShape : public NiShape {
 protected:
 	BlockRef<NiObject> skinInstanceRef;
@@ -336,10 +382,14 @@ protected:
 	float boundMinMax[6];
 
 	uint numTriangles = 0;
-	std::vector<Triangle> triangles;
+	BlockVector<Triangle> triangles;
 
 	ushort numVertices = 0;
 
+	BSVertexStreams vertexStreams;
+
+	bool IsVertexStreamValid(const uint stream);
+
 public:
 	VertexDesc vertexDesc;
 
@@ -351,17 +401,15 @@ public:
 	std::vector<Vector3> particleNorms;
 	std::vector<Triangle> particleTris;
 
-	std::vector<Vector3> rawVertices;		// filled by GetRawVerts function and returned.
-	std::vector<Vector3> rawNormals;		// filled by GetNormalData function and returned.
-	std::vector<Vector3> rawTangents;		// filled by CalcTangentSpace function and returned.
-	std::vector<Vector3> rawBitangents;		// filled in CalcTangentSpace
-	std::vector<Vector2> rawUvs;			// filled by GetUVData function and returned.
-	std::vector<Color4> rawColors;			// filled by GetColorData function and returned.
-	std::vector<float> rawEyeData;
+	BlockVector<Vector3> rawNormals;		// filled by GetNormalData function and returned.
+	BlockVector<Vector3> rawTangents;		// filled by CalcTangentSpace function and returned.
+	BlockVector<Vector3> rawBitangents;		// filled in CalcTangentSpace
+	BlockVector<Color4> rawColors;			// filled by GetColorData function and returned.
+	BlockVector<float> rawEyeData;
 
 	std::vector<uint> deletedTris;			// temporary storage for BSSubIndexTriShape
 
-	std::vector<BSVertexData> vertData;
+	BlockVector<BSVertexData> vertData;
 
 	BSTriShape();
 
@@ -371,7 +419,7 @@ public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
 	void notifyVerticesDelete(const std::vector<ushort>& vertIndices);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	BSTriShape* Clone() { return new BSTriShape(*this); }
 
@@ -384,22 +432,50 @@ public:
 	int GetAlphaPropertyRef();
 	void SetAlphaPropertyRef(int alphaPropRef);
 
-	std::vector<Vector3>* GetRawVerts();
-	std::vector<Vector3>* GetNormalData(bool xform = true);
-	std::vector<Vector3>* GetTangentData(bool xform = true);
-	std::vector<Vector3>* GetBitangentData(bool xform = true);
-	std::vector<Vector2>* GetUVData();
-	std::vector<Color4>* GetColorData();
-	std::vector<float>* GetEyeData();
-
-	const std::vector<Vector3>* get_vertices();
-	const std::vector<Vector2>* get_uv();
-	const std::vector<Vector3>* get_normals(bool transform);
+	// Returns the position stream, don't modify it through the pointer
+	BlockVector<Vector3>* GetRawVerts();
+	BlockVector<Vector3>* GetNormalData(bool xform = true);
+	BlockVector<Vector3>* GetTangentData(bool xform = true);
+	BlockVector<Vector3>* GetBitangentData(bool xform = true);
+	// Returns the UV stream, don't modify it through the pointer
+	BlockVector<Vector2>* GetUVData();
+	BlockVector<Color4>* GetColorData();
+	BlockVector<float>* GetEyeData();
+
+	// Attribute streams without per-call copies, empty if the attribute isn't present.
+	// Views stay valid until vertData is modified.
+	Span<const Vector3> GetPositionStream();
+	Span<const Vector2> GetUVStream();
+	Span<const Vector3> GetNormalStream();
+	Span<const Vector3> GetTangentStream();
+	Span<const Vector3> GetBitangentStream();
+	Span<const Color4> GetColorStream();
+	Span<const std::array<float, 4>> GetWeightStream();
+	Span<const std::array<byte, 4>> GetBoneIndexStream();
+	Span<const float> GetEyeDataStream();
+
+	// Has to be called after vertData was modified directly, ends edits through edit_vertices() and edit_uv()
+	void InvalidateVertexStreams();
+
+	const BlockVector<Vector3>* get_vertices();
+	const BlockVector<Vector2>* get_uv();
+	const BlockVector<Vector3>* get_normals(bool transform);
 
 	void set_vertices(const std::vector<Vector3> &vertices);
 	void set_uv(const std::vector<Vector2> &uv);
 	void set_normals(const std::vector<Vector3> &normals);
 
+	StridedSpan<const Vector3> view_vertices();
+	StridedSpan<const Vector2> view_uv();
+	StridedSpan<const Vector3> view_normals();
+
+	StridedSpan<Vector3> edit_vertices();
+	StridedSpan<Vector2> edit_uv();
+
+	void set_vertices(StridedSpan<const Vector3> vertices);
+	void set_uv(StridedSpan<const Vector2> uv);
+	void set_normals(StridedSpan<const Vector3> normals);
+
 	ushort GetNumVertices();
 	void SetVertices(const bool enable);
 	bool HasVertices() { return vertexDesc.HasFlag(VF_VERTEX); }
@@ -437,9 +513,9 @@ public:
 	BoundingSphere GetBounds() { return bounds; }
 	void UpdateBounds();
 
-	void SetVertexData(const std::vector<BSVertexData>& bsVertData);
+	void SetVertexData(Span<const BSVertexData> bsVertData);
 
-	void SetNormals(const std::vector<Vector3>& inNorms);
+	void SetNormals(Span<const Vector3> inNorms);
 	void RecalcNormals(const bool smooth = true, const float smoothThres = 60.0f, std::unordered_set<uint>* lockedIndices = nullptr);
 	void CalcTangentSpace();
 	int CalcDataSizes(NiVersion& version);
@@ -619,8 +695,8 @@ protected:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 
 	bool IsSkinned();
@@ -661,7 +737,7 @@ class NiTriShapeData : public NiTriBasedGeomData {
 protected:
 	uint numTrianglePoints = 0;
 	bool hasTriangles = false;
-	std::vector<Triangle> triangles;
+	BlockVector<Triangle> triangles;
 
 	ushort numMatchGroups = 0;
 	std::vector<MatchGroup> matchGroups;
@@ -692,14 +768,18 @@ public:
 	static constexpr const char* BlockName = "NiTriShape";
 	virtual const char* GetBlockName() { return BlockName; }
 
-	const std::vector<Vector3>* get_vertices();
-	const std::vector<Vector2>* get_uv();
-	const std::vector<Vector3>* get_normals(bool transform);
+	const BlockVector<Vector3>* get_vertices();
+	const BlockVector<Vector2>* get_uv();
+	const BlockVector<Vector3>* get_normals(bool transform);
 
 	void set_vertices(const std::vector<Vector3> &vertices);
 	void set_uv(const std::vector<Vector2> &uv);
 	void set_normals(const std::vector<Vector3> &normals);
 
+	using NiShape::set_vertices;
+	using NiShape::set_uv;
+	using NiShape::set_normals;
+
 	NiGeometryData* GetGeomData();
 	void SetGeomData(NiGeometryData* geomDataPtr);
 
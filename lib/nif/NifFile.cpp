@@ -5,19 +5,21 @@ See the included LICENSE file
 
 #include "NifFile.h"
 #include "NifUtil.h"
+#include "utils/MappedFile.h"
+#include "utils/ParallelFor.h"
 
 #include <algorithm>
 #include <set>
 #include <unordered_set>
 #include <queue>
-#include <regex>
 #include <fstream>
+#include <thread>
 
 template<class T>
 T* NifFile::FindBlockByName(const std::string& name) {
-	for (auto& block : blocks) {
-		auto namedBlock = dynamic_cast<T*>(block.get());
-		if (namedBlock && !name.compare(namedBlock->GetName()))
+	for (auto& id : hdr.GetBlockIDsByName(name)) {
+		auto namedBlock = hdr.LoadBlock<T>(id);
+		if (namedBlock)
 			return namedBlock;
 	}
 
@@ -25,30 +27,16 @@ T* NifFile::FindBlockByName(const std::string& name) {
 }
 
 int NifFile::GetBlockID(NiObject* block) {
-	auto it = std::find_if(blocks.begin(), blocks.end(), [&block](const auto& ptr) {
-		return ptr.get() == block;
-	});
-
-	if (it != blocks.end())
-		return std::distance(blocks.begin(), it);
+	return hdr.GetBlockID(block);
+}
 
-	return 0xFFFFFFFF;
+void NifFile::SetBlockModified(NiObject* block) {
+	hdr.SetBlockModified(GetBlockID(block));
 }
 
 NiNode* NifFile::GetParentNode(NiObject* childBlock) {
-	if (childBlock != nullptr) {
-		int childId = GetBlockID(childBlock);
-		for (auto &block : blocks) {
-			auto node = dynamic_cast<NiNode*>(block.get());
-			if (node) {
-				auto children = node->GetChildren();
-				for (auto it = children.begin(); it < children.end(); ++it) {
-					if (childId == it->GetIndex())
-						return node;
-				}
-			}
-		}
-	}
+	if (childBlock != nullptr)
+		return hdr.LoadBlock<NiNode>(hdr.GetParentID(GetBlockID(childBlock)));
 
 	return nullptr;
 }
@@ -65,11 +53,9 @@ void NifFile::SetParentNode(NiObject* childBlock, NiNode* newParent) {
 	}
 
 	int childId = GetBlockID(childBlock);
-	for (auto &block : blocks) {
-		auto node = dynamic_cast<NiNode*>(block.get());
-		if (!node)
-			continue;
+	auto node = GetParentNode(childBlock);
 
+	if (node) {
 		auto& children = node->GetChildren();
 		for (int ci = 0; ci < children.GetSize(); ++ci) {
 			if (childId != children.GetBlockRef(ci))
@@ -77,8 +63,8 @@ void NifFile::SetParentNode(NiObject* childBlock, NiNode* newParent) {
 
 			// We have now found the node's old parent
 			if (newParent != node) {
-				children.RemoveBlockRef(ci);
-				newParent->GetChildren().AddBlockRef(childId);
+				hdr.RemoveBlockRef(GetBlockID(node), children, ci);
+				hdr.AddBlockRef(GetBlockID(newParent), newParent->GetChildren(), childId);
 			}
 
 			return;
@@ -86,18 +72,11 @@ void NifFile::SetParentNode(NiObject* childBlock, NiNode* newParent) {
 	}
 
 	// If we get here, the node's old parent was not found.
-	newParent->GetChildren().AddBlockRef(childId);
+	hdr.AddBlockRef(GetBlockID(newParent), newParent->GetChildren(), childId);
 }
 
 std::vector<NiNode*> NifFile::GetNodes() {
-	std::vector<NiNode*> outList;
-	for (auto& block : blocks) {
-		auto node = dynamic_cast<NiNode*>(block.get());
-		if (node)
-			outList.push_back(node);
-	}
-
-	return outList;
+	return hdr.GetBlocks<NiNode>();
 }
 
 void NifFile::CopyFrom(const NifFile& other) {
@@ -109,6 +88,7 @@ void NifFile::CopyFrom(const NifFile& other) {
 	isTerrain = other.isTerrain;
 
 	hdr = NiHeader(other.hdr);
+	hdr.SetBlockResource(nullptr);
 
 	size_t nBlocks = other.blocks.size();
 	blocks.resize(nBlocks);
@@ -121,13 +101,10 @@ void NifFile::CopyFrom(const NifFile& other) {
 }
 
 void NifFile::LinkGeomData() {
-	for (auto &block : blocks) {
-		auto geom = dynamic_cast<NiGeometry*>(block.get());
-		if (geom) {
-			auto geomData = hdr.GetBlock<NiGeometryData>(geom->GetDataRef());
-			if (geomData)
-				geom->SetGeomData(geomData);
-		}
+	for (auto &geom : hdr.GetBlocks<NiGeometry>()) {
+		auto geomData = hdr.GetBlock<NiGeometryData>(geom->GetDataRef());
+		if (geomData)
+			geom->SetGeomData(geomData);
 	}
 }
 
@@ -136,9 +113,14 @@ void NifFile::RemoveInvalidTris() {
 		std::vector<Triangle> tris;
 		if (shape->GetTriangles(tris)) {
 			ushort numVerts = shape->GetNumVertices();
-			tris.erase(std::remove_if(tris.begin(), tris.end(), [&](auto& t) {
+			auto validEnd = std::remove_if(tris.begin(), tris.end(), [&](auto& t) {
 				return t.p1 >= numVerts || t.p2 >= numVerts || t.p3 >= numVerts;
-			}), tris.end());
+			});
+
+			if (validEnd != tris.end()) {
+				tris.erase(validEnd, tris.end());
+				SetBlockModified(shape);
+			}
 
 			shape->SetTriangles(tris);
 		}
@@ -164,9 +146,34 @@ void NifFile::Clear() {
 
 	blocks.clear();
 	hdr.Clear();
+	blockArenas.clear();
+}
+
+static bool MatchBlockType(const std::set<std::string>& blockTypes, const std::string& blockType) {
+	if (blockTypes.count(blockType))
+		return true;
+
+	for (auto &t : blockTypes)
+		if (!t.empty() && t.back() == '*' && blockType.compare(0, t.length() - 1, t, 0, t.length() - 1) == 0)
+			return true;
+
+	return false;
+}
+
+bool NifLoadOptions::ParsesBlockType(const std::string& blockType) const {
+	if (!includeBlockTypes.empty() && !MatchBlockType(includeBlockTypes, blockType))
+		return false;
+
+	return excludeBlockTypes.empty() || !MatchBlockType(excludeBlockTypes, blockType);
 }
 
 int NifFile::Load(const std::string& fileName, const NifLoadOptions& options) {
+	if (options.memoryMap) {
+		MappedFile mapped;
+		if (mapped.Open(fileName))
+			return Load(mapped.GetData(), mapped.GetSize(), options);
+	}
+
 	std::fstream file(fileName.c_str(), std::ios::in | std::ios::binary);
 	return Load(file, options);
 }
@@ -174,48 +181,137 @@ int NifFile::Load(const std::string& fileName, const NifLoadOptions& options) {
 int NifFile::Load(std::iostream &file, const NifLoadOptions& options) {
 	Clear();
 
+	if (!file)
+		return 1;
+
+	NiStream stream(&file, &hdr.GetVersion());
+	return LoadStream(stream, options);
+}
+
+int NifFile::Load(const char* data, const size_t size, const NifLoadOptions& options) {
+	Clear();
+
+	if (!data || size == 0)
+		return 1;
+
+	NiStream stream(data, size, &hdr.GetVersion());
+	int error = LoadStream(stream, options);
+	if (error == 0 && stream.IsOverrun()) {
+		Clear();
+		return 1;
+	}
+
+	return error;
+}
+
+int NifFile::LoadStream(NiStream& stream, const NifLoadOptions& options) {
 	isTerrain = options.isTerrain;
 
-	if (file) {
-		NiStream stream(&file, &hdr.GetVersion());
-		hdr.Get(stream);
+	hdr.Get(stream);
 
-		if (!hdr.IsValid()) {
-			Clear();
-			return 1;
-		}
+	if (!hdr.IsValid()) {
+		Clear();
+		return 1;
+	}
 
-		NiVersion& version = stream.GetVersion();
-		if (!(version.File() >= NiVersion::ToFile(20, 2, 0, 7) && (version.User() == 11 || version.User() == 12))) {
-			Clear();
-			return 2;
+	NiVersion& version = stream.GetVersion();
+	if (!(version.File() >= NiVersion::ToFile(20, 2, 0, 7) && (version.User() == 11 || version.User() == 12))) {
+		Clear();
+		return 2;
+	}
+
+	uint nBlocks = hdr.GetNumBlocks();
+	blocks.resize(nBlocks);
+
+	auto& nifactories = NiFactoryRegister::Get();
+	std::vector<std::shared_ptr<NiFactory>> blockFactories(nBlocks);
+	bool filterBlockTypes = !options.includeBlockTypes.empty() || !options.excludeBlockTypes.empty();
+	for (uint i = 0; i < nBlocks; i++) {
+		std::string blockTypeStr = hdr.GetBlockTypeStringById(i);
+
+		// Filtered blocks are loaded like unknown ones
+		if (!filterBlockTypes || options.ParsesBlockType(blockTypeStr))
+			blockFactories[i] = nifactories.GetFactoryByName(blockTypeStr);
+	}
+
+	uint loadThreads = options.loadThreads;
+	if (loadThreads == 0)
+		loadThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	bool parallel = loadThreads > 1 && !options.lazyBlocks;
+	bool keepBlockBytes = options.lazyBlocks || options.keepBlockBytes;
+
+	// One arena per decoding thread, the first one is also used for blocks decoded later
+	std::vector<std::pmr::memory_resource*> arenas;
+	if (options.blockArena) {
+		uint numArenas = parallel ? loadThreads : 1;
+
+		// Decoded blocks take up about as much as their bytes in the file, the arenas grow from there
+		size_t dataSize = 0;
+		for (uint i = 0; i < nBlocks; i++)
+			if (blockFactories[i])
+				dataSize += hdr.GetBlockSize(i);
+
+		for (uint i = 0; i < numArenas; i++) {
+			blockArenas.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>(std::max<size_t>(dataSize / numArenas, 4096)));
+			arenas.push_back(blockArenas.back().get());
 		}
 
-		uint nBlocks = hdr.GetNumBlocks();
-		blocks.resize(nBlocks);
+		hdr.SetBlockResource(arenas.front());
+	}
 
-		auto& nifactories = NiFactoryRegister::Get();
-		for (int i = 0; i < nBlocks; i++) {
-			std::string blockTypeStr = hdr.GetBlockTypeStringById(i);
+	// Bytes of all lazily loaded blocks in one buffer, parallel decoding starts out the same way
+	std::shared_ptr<std::vector<char>> lazyData;
+	size_t lazyOffset = 0;
+	uint numLazyBlocks = 0;
+	if (keepBlockBytes || parallel) {
+		size_t lazySize = 0;
+		for (uint i = 0; i < nBlocks; i++)
+			if (blockFactories[i])
+				lazySize += hdr.GetBlockSize(i);
 
-			auto nifactory = nifactories.GetFactoryByName(blockTypeStr);
-			if (nifactory) {
-				blocks[i] = nifactory->Load(stream);
-			}
-			else {
-				hasUnknown = true;
-				blocks[i] = std::make_shared<NiUnknown>(stream, hdr.GetBlockSize(i));
+		lazyData = std::make_shared<std::vector<char>>(lazySize);
+	}
+
+	for (uint i = 0; i < nBlocks; i++) {
+		auto& nifactory = blockFactories[i];
+		if (nifactory) {
+			if (lazyData) {
+				uint blockSize = hdr.GetBlockSize(i);
+				stream.read(lazyData->data() + lazyOffset, blockSize);
+
+				blocks[i] = std::make_shared<NiLazyBlock>(hdr.GetBlockTypeStringById(i), lazyData, lazyOffset, blockSize);
+				lazyOffset += blockSize;
+				numLazyBlocks++;
 			}
+			else
+				blocks[i] = nifactory->Load(stream, arenas.empty() ? nullptr : arenas.front());
+		}
+		else {
+			hasUnknown = true;
+			blocks[i] = std::make_shared<NiUnknown>(stream, hdr.GetBlockSize(i));
 		}
-
-		hdr.SetBlockReference(&blocks);
 	}
-	else {
+
+	hdr.SetBlockReference(&blocks);
+	hdr.SetLazyBlockCount(numLazyBlocks);
+	hdr.SetKeepBlockSources(keepBlockBytes);
+
+	// Blocks that don't decode to their exact size make the file invalid, like they would when read in place
+	if (lazyData && !options.lazyBlocks && !hdr.LoadAllBlocks(parallel ? loadThreads : 1, arenas)) {
 		Clear();
 		return 1;
 	}
 
-	PrepareData();
+	PrepareData(options.trimTexturePaths);
+
+	if (options.referenceIndex)
+		hdr.SetReferenceIndex(true);
+
+	// Blocks accessed from here on count as modified
+	if (keepBlockBytes)
+		hdr.StartBlockAccessTracking();
+
 	isValid = true;
 	return 0;
 }
@@ -358,9 +454,19 @@ void NifFile::SortGraph(NiNode* root, std::vector<int>& newIndices, int& newInde
 	children.GetIndices(indices);
 	children.Clear();
 
-	for (int i = 0; i < hdr.GetNumBlocks(); i++)
-		if (std::find(indices.begin(), indices.end(), i) != indices.end())
-			children.AddBlockRef(i);
+	// Re-add valid children once each in block order
+	int numBlocks = hdr.GetNumBlocks();
+	indices.erase(std::remove_if(indices.begin(), indices.end(), [numBlocks](const int i) {
+		return i < 0 || i >= numBlocks;
+	}), indices.end());
+
+	std::sort(indices.begin(), indices.end());
+	indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+	for (auto& i : indices)
+		children.AddBlockRef(i);
+
+	hdr.BlockReferencesEdited(GetBlockID(root));
 
 	if (children.GetSize() > 0) {
 		if (hdr.GetVersion().IsFO3()) {
@@ -486,28 +592,130 @@ bool NifFile::DeleteUnreferencedNodes(int* deletionCount) {
 	if (!root)
 		return false;
 
-	for (auto &node : GetNodes()) {
-		if (node == root)
-			continue;
+	int numBlocks = hdr.GetNumBlocks();
+	int rootId = GetBlockID(root);
+	bool refIndex = hdr.HasReferenceIndex();
+
+	// Number of references to each block and number of set child refs of each block
+	std::vector<int> refCounts(numBlocks);
+	std::vector<int> childRefCounts(numBlocks);
+	// Blocks holding a child ref to each block, the reference index already knows them
+	std::vector<std::vector<int>> childRefHolders;
+	std::vector<bool> deleted(numBlocks);
+
+	std::vector<Ref*> refs;
+	auto countChildRefs = [&](const int blockId) {
+		refs.clear();
+		hdr.GetBlock<NiObject>(blockId)->GetChildRefs(refs);
+
+		int count = 0;
+		for (auto &ref : refs) {
+			int index = ref->GetIndex();
+			if (index >= 0 && (index >= numBlocks || !deleted[index]))
+				count++;
+		}
 
-		int blockId = GetBlockID(node);
-		if (blockId == 0xFFFFFFFF)
-			continue;
+		return count;
+	};
+
+	if (refIndex) {
+		// Only nodes can be deleted, so only their counts are needed
+		for (auto &id : hdr.GetBlockIDsOfType<NiNode>()) {
+			refCounts[id] = hdr.GetBlockRefCount(id);
+			childRefCounts[id] = countChildRefs(id);
+		}
+	}
+	else {
+		childRefHolders.resize(numBlocks);
+
+		for (int i = 0; i < numBlocks; i++) {
+			auto block = hdr.GetBlock<NiObject>(i);
+
+			refs.clear();
+			block->GetChildRefs(refs);
+
+			for (auto &ref : refs) {
+				int index = ref->GetIndex();
+				if (index < 0)
+					continue;
+
+				childRefCounts[i]++;
+				if (index < numBlocks) {
+					refCounts[index]++;
+					childRefHolders[index].push_back(i);
+				}
+			}
+
+			refs.clear();
+			block->GetPtrs(refs);
+
+			for (auto &ref : refs) {
+				int index = ref->GetIndex();
+				if (index >= 0 && index < numBlocks)
+					refCounts[index]++;
+			}
+		}
+	}
+
+	auto canDelete = [&](const int blockId) {
+		return blockId != rootId && !deleted[blockId] && childRefCounts[blockId] == 0 &&
+			refCounts[blockId] < 2 && hdr.GetBlock<NiNode>(blockId);
+	};
+
+	std::vector<int> pending;
+	for (auto &id : hdr.GetBlockIDsOfType<NiNode>())
+		if (canDelete(id))
+			pending.push_back(id);
+
+	// Deleting a block can cause others to become unreferenced
+	std::set<int> deleteIds;
+	while (!pending.empty()) {
+		int blockId = pending.back();
+		pending.pop_back();
 
-		if (!CanDeleteNode(node))
+		if (!canDelete(blockId))
 			continue;
 
-		if (hdr.GetBlockRefCount(blockId) < 2) {
-			hdr.DeleteBlock(blockId);
+		deleted[blockId] = true;
+		deleteIds.insert(blockId);
 
-			if (deletionCount)
-				(*deletionCount)++;
+		if (refIndex) {
+			for (auto &holder : hdr.GetReferencingBlocks(blockId)) {
+				if (deleted[holder] || !hdr.GetBlock<NiNode>(holder))
+					continue;
+
+				childRefCounts[holder] = countChildRefs(holder);
+				if (canDelete(holder))
+					pending.push_back(holder);
+			}
+		}
+		else {
+			for (auto &holder : childRefHolders[blockId]) {
+				childRefCounts[holder]--;
+				if (canDelete(holder))
+					pending.push_back(holder);
+			}
+		}
 
-			// Deleting a block can cause others to become unreferenced
-			return DeleteUnreferencedNodes(deletionCount);
+		refs.clear();
+		auto block = hdr.GetBlock<NiObject>(blockId);
+		block->GetPtrs(refs);
+
+		for (auto &ref : refs) {
+			int index = ref->GetIndex();
+			if (index >= 0 && index < numBlocks) {
+				refCounts[index]--;
+				if (canDelete(index))
+					pending.push_back(index);
+			}
 		}
 	}
 
+	hdr.DeleteBlocks(deleteIds);
+
+	if (deletionCount)
+		(*deletionCount) += deleteIds.size();
+
 	return true;
 }
 
@@ -522,8 +730,8 @@ NiNode* NifFile::AddNode(const std::string& nodeName, const MatTransform& xformT
 	newNode->SetTransformToParent(xformToParent);
 
 	int newNodeId = hdr.AddBlock(newNode);
-	if (newNodeId != 0xFFFFFFFF)
-		parent->GetChildren().AddBlockRef(newNodeId);
+	if (newNodeId >= 0)
+		hdr.AddBlockRef(GetBlockID(parent), parent->GetChildren(), newNodeId);
 
 	return newNode;
 }
@@ -536,7 +744,7 @@ bool NifFile::CanDeleteNode(NiNode* node) {
 	if (!node)
 		return false;
 
-	std::set<Ref*> refs;
+	std::vector<Ref*> refs;
 	node->GetChildRefs(refs);
 
 	// Only delete if the node has no child refs
@@ -544,7 +752,8 @@ bool NifFile::CanDeleteNode(NiNode* node) {
 		if (ref->GetIndex() != 0xFFFFFFFF)
 			return false;
 
-	return true;
+	// and nothing but its parent refers to it
+	return hdr.GetBlockRefCount(GetBlockID(node)) < 2;
 }
 
 bool NifFile::CanDeleteNode(const std::string& nodeName) {
@@ -555,7 +764,7 @@ bool NifFile::CanDeleteNode(const std::string& nodeName) {
 std::string NifFile::GetNodeName(const int blockID) {
 	std::string name;
 
-	auto n = hdr.GetBlock<NiNode>(blockID);
+	auto n = hdr.LoadBlock<NiNode>(blockID);
 	if (n) {
 		name = n->GetName();
 		if (name.empty())
@@ -566,26 +775,23 @@ std::string NifFile::GetNodeName(const int blockID) {
 }
 
 void NifFile::SetNodeName(const int blockID, const std::string& newName) {
-	auto node = hdr.GetBlock<NiNode>(blockID);
-	if (!node)
-		return;
-
-	node->SetName(newName);
+	if (hdr.LoadBlock<NiNode>(blockID))
+		hdr.SetBlockName(blockID, newName);
 }
 
 int NifFile::AssignExtraData(NiAVObject* target, NiExtraData* extraData) {
 	int extraDataId = hdr.AddBlock(extraData);
-	target->GetExtraData().AddBlockRef(extraDataId);
+	hdr.AddBlockRef(GetBlockID(target), target->GetExtraData(), extraDataId);
 	return extraDataId;
 }
 
 NiShader* NifFile::GetShader(NiShape* shape) {
-	auto shader = hdr.GetBlock<NiShader>(shape->GetShaderPropertyRef());
+	auto shader = hdr.LoadBlock<NiShader>(shape->GetShaderPropertyRef());
 	if (shader)
 		return shader;
 
 	for (auto& prop : shape->GetProperties()) {
-		auto shaderProp = hdr.GetBlock<NiShader>(prop.GetIndex());
+		auto shaderProp = hdr.LoadBlock<NiShader>(prop.GetIndex());
 		if (shaderProp)
 			return shaderProp;
 	}
@@ -595,7 +801,7 @@ NiShader* NifFile::GetShader(NiShape* shape) {
 
 NiMaterialProperty* NifFile::GetMaterialProperty(NiShape* shape) {
 	for (auto& prop : shape->GetProperties()) {
-		auto material = hdr.GetBlock<NiMaterialProperty>(prop.GetIndex());
+		auto material = hdr.LoadBlock<NiMaterialProperty>(prop.GetIndex());
 		if (material)
 			return material;
 	}
@@ -605,7 +811,7 @@ NiMaterialProperty* NifFile::GetMaterialProperty(NiShape* shape) {
 
 NiStencilProperty* NifFile::GetStencilProperty(NiShape* shape) {
 	for (auto& prop : shape->GetProperties()) {
-		auto stencil = hdr.GetBlock<NiStencilProperty>(prop.GetIndex());
+		auto stencil = hdr.LoadBlock<NiStencilProperty>(prop.GetIndex());
 		if (stencil)
 			return stencil;
 	}
@@ -644,7 +850,7 @@ int NifFile::GetTextureSlot(NiShader* shader, std::string& outTexFile, int texIn
 			return 0;
 	}
 
-	auto textureSet = hdr.GetBlock<BSShaderTextureSet>(textureSetRef);
+	auto textureSet = hdr.LoadBlock<BSShaderTextureSet>(textureSetRef);
 	if (!textureSet || texIndex + 1 > textureSet->numTextures)
 		return 0;
 
@@ -687,45 +893,22 @@ void NifFile::SetTextureSlot(NiShader* shader, std::string& outTexFile, int texI
 }
 
 void NifFile::TrimTexturePaths() {
-	auto fTrimPath = [&isTerrain = isTerrain](std::string& tex) -> std::string& {
-		if (!tex.empty()) {
-			tex = std::regex_replace(tex, std::regex("/+|\\\\+"), "\\");													// Replace multiple slashes or forward slashes with one backslash
-			tex = std::regex_replace(tex, std::regex("^(.*?)\\\\textures\\\\", std::regex_constants::icase), "");			// Remove everything before the first occurence of "\textures\"
-			tex = std::regex_replace(tex, std::regex("^\\\\+"), "");														// Remove all backslashes from the front
-			tex = std::regex_replace(tex, std::regex("^(?!^textures\\\\)", std::regex_constants::icase), "textures\\");		// If the path doesn't start with "textures\", add it to the front
-
-			if (isTerrain)
-				tex = std::regex_replace(tex, std::regex("^(?!^Data\\\\)", std::regex_constants::icase), "Data\\");			// If the path doesn't start with "Data\", add it to the front
-		}
-		return tex;
-	};
-
 	for (auto &shape : GetShapes()) {
 		NiShader* shader = GetShader(shape);
 		if (shader) {
 			auto textureSet = hdr.GetBlock<BSShaderTextureSet>(shader->GetTextureSetRef());
 			if (textureSet) {
-				for (int i = 0; i < textureSet->numTextures; i++) {
-					std::string tex = textureSet->textures[i].GetString();
-					textureSet->textures[i].SetString(fTrimPath(tex));
-				}
+				for (int i = 0; i < textureSet->numTextures; i++)
+					NormalizeTexturePath(textureSet->textures[i].GetStringRef(), isTerrain);
 
 				auto effectShader = dynamic_cast<BSEffectShaderProperty*>(shader);
 				if (effectShader) {
-					std::string tex = effectShader->sourceTexture.GetString();
-					effectShader->sourceTexture.SetString(fTrimPath(tex));
-
-					tex = effectShader->normalTexture.GetString();
-					effectShader->normalTexture.SetString(fTrimPath(tex));
-
-					tex = effectShader->greyscaleTexture.GetString();
-					effectShader->greyscaleTexture.SetString(fTrimPath(tex));
-
-					tex = effectShader->envMapTexture.GetString();
-					effectShader->envMapTexture.SetString(fTrimPath(tex));
-
-					tex = effectShader->envMaskTexture.GetString();
-					effectShader->envMaskTexture.SetString(fTrimPath(tex));
+					SetBlockModified(effectShader);
+					NormalizeTexturePath(effectShader->sourceTexture.GetStringRef(), isTerrain);
+					NormalizeTexturePath(effectShader->normalTexture.GetStringRef(), isTerrain);
+					NormalizeTexturePath(effectShader->greyscaleTexture.GetStringRef(), isTerrain);
+					NormalizeTexturePath(effectShader->envMapTexture.GetStringRef(), isTerrain);
+					NormalizeTexturePath(effectShader->envMaskTexture.GetStringRef(), isTerrain);
 				}
 			}
 		}
@@ -738,7 +921,7 @@ void NifFile::CloneChildren(NiObject* block, NifFile* srcNif) {
 
 	// Assign new refs and strings, rebind ptrs where possible
 	std::function<void(NiObject*, int, int)> cloneBlock = [&](NiObject* b, int parentOldId, int parentNewId) -> void {
-		std::set<Ref*> refs;
+		std::vector<Ref*> refs;
 		b->GetChildRefs(refs);
 
 		for (auto &r : refs) {
@@ -749,7 +932,7 @@ void NifFile::CloneChildren(NiObject* block, NifFile* srcNif) {
 				int destId = hdr.AddBlock(destChild);
 				r->SetIndex(destId);
 
-				std::set<StringRef*> strRefs;
+				std::vector<StringRef*> strRefs;
 				destChild->GetStringRefs(strRefs);
 
 				for (auto &str : strRefs) {
@@ -758,7 +941,7 @@ void NifFile::CloneChildren(NiObject* block, NifFile* srcNif) {
 				}
 
 				if (parentOldId != 0xFFFFFFFF) {
-					std::set<Ref*> ptrs;
+					std::vector<Ref*> ptrs;
 					destChild->GetPtrs(ptrs);
 
 					for (auto &p : ptrs)
@@ -771,6 +954,9 @@ void NifFile::CloneChildren(NiObject* block, NifFile* srcNif) {
 					cloneBlock(destChild, srcId, destId);
 			}
 		}
+
+		// The block's refs were rewritten in place
+		hdr.BlockReferencesEdited(GetBlockID(b));
 	};
 
 	cloneBlock(block, 0xFFFFFFFF, 0xFFFFFFFF);
@@ -795,10 +981,10 @@ NiShape* NifFile::CloneShape(NiShape* srcShape, const std::string& destShapeName
 		// Assign copied geometry to the same parent
 		auto parentNode = GetParentNode(srcShape);
 		if (parentNode)
-			parentNode->GetChildren().AddBlockRef(destId);
+			hdr.AddBlockRef(GetBlockID(parentNode), parentNode->GetChildren(), destId);
 	}
 	else if (rootNode)
-		rootNode->GetChildren().AddBlockRef(destId);
+		hdr.AddBlockRef(GetBlockID(rootNode), rootNode->GetChildren(), destId);
 
 	// Children
 	CloneChildren(destShape, srcNif);
@@ -824,9 +1010,12 @@ NiShape* NifFile::CloneShape(NiShape* srcShape, const std::string& destShapeName
 	std::vector<std::string> srcBoneList;
 	srcNif->GetShapeBoneList(srcShape, srcBoneList);
 
-	auto destBoneCont = hdr.GetBlock<NiBoneContainer>(destShape->GetSkinInstanceRef());
-	if (destBoneCont)
+	int destBoneContId = destShape->GetSkinInstanceRef();
+	auto destBoneCont = hdr.GetBlock<NiBoneContainer>(destBoneContId);
+	if (destBoneCont) {
 		destBoneCont->GetBones().Clear();
+		hdr.BlockReferencesEdited(destBoneContId);
+	}
 
 	if (rootNode && srcRootNode) {
 		std::function<void(NiNode*)> cloneNodes = [&](NiNode* srcNode) -> void {
@@ -848,7 +1037,7 @@ NiShape* NifFile::CloneShape(NiShape* srcShape, const std::string& destShapeName
 			if (!node) {
 				// Clone missing node into the right parent
 				boneID = CloneNamedNode(boneName, srcNif);
-				nodeParent->GetChildren().AddBlockRef(boneID);
+				hdr.AddBlockRef(GetBlockID(nodeParent), nodeParent->GetChildren(), boneID);
 			}
 			else {
 				// Move existing node to non-root parent
@@ -857,13 +1046,14 @@ NiShape* NifFile::CloneShape(NiShape* srcShape, const std::string& destShapeName
 					MatTransform xformToParent;
 					srcNif->GetNodeTransformToParent(boneName, xformToParent);
 
-					std::set<Ref*> childRefs;
+					int oldParentId = GetBlockID(oldParent);
+					std::vector<Ref*> childRefs;
 					oldParent->GetChildRefs(childRefs);
 					for (auto &ref : childRefs)
 						if (ref->GetIndex() == boneID)
-							ref->Clear();
+							hdr.SetBlockRef(oldParentId, *ref, 0xFFFFFFFF);
 
-					nodeParent->GetChildren().AddBlockRef(boneID);
+					hdr.AddBlockRef(GetBlockID(nodeParent), nodeParent->GetChildren(), boneID);
 					SetNodeTransformToParent(boneName, xformToParent);
 				}
 			}
@@ -889,7 +1079,7 @@ NiShape* NifFile::CloneShape(NiShape* srcShape, const std::string& destShapeName
 			auto node = FindBlockByName<NiNode>(boneName);
 			int boneID = GetBlockID(node);
 			if (node)
-				destBoneCont->GetBones().AddBlockRef(boneID);
+				hdr.AddBlockRef(destBoneContId, destBoneCont->GetBones(), boneID);
 		}
 	}
 
@@ -925,23 +1115,81 @@ int NifFile::Save(std::iostream &file, const NifSaveOptions& options) {
 			return 76;
 
 		NiStream stream(&file, &hdr.GetVersion());
-		FinalizeData();
 
-		if (options.optimize)
-			Optimize();
+		if (options.passThrough) {
+			FinalizeData(true);
+
+			if (options.optimize) {
+				for (uint i = 0; i < hdr.GetNumBlocks(); i++) {
+					if (!hdr.IsBlockModified(i))
+						continue;
+
+					auto shape = hdr.GetBlock<NiShape>(i);
+					if (shape)
+						shape->UpdateBounds();
+				}
+			}
+		}
+		else {
+			// Optimizing and sorting follow the references of all blocks
+			if (options.optimize || options.sortBlocks)
+				hdr.LoadAllBlocks();
+
+			// Every block is encoded again
+			hdr.DropBlockSources();
 
-		if (options.sortBlocks)
-			PrettySortBlocks();
+			FinalizeData();
 
-		hdr.Put(stream);
-		stream.InitBlockSize();
+			if (options.optimize)
+				Optimize();
+
+			if (options.sortBlocks)
+				PrettySortBlocks();
+		}
+
+		auto blockToWrite = [&](const int blockId) {
+			NiObject* block = options.passThrough ? hdr.GetBlockSource(blockId) : nullptr;
+			if (!block)
+				block = blocks[blockId].get();
+
+			return block;
+		};
 
-		// Retrieve block sizes from NiStream while writing
-		std::vector<int> blockSizes(hdr.GetNumBlocks());
-		for (int i = 0; i < hdr.GetNumBlocks(); i++) {
-			blocks[i]->Put(stream);
-			blockSizes[i] = stream.GetBlockSize();
+		uint saveThreads = options.saveThreads;
+		if (saveThreads == 0)
+			saveThreads = std::max(1u, std::thread::hardware_concurrency());
+
+		// Block sizes are only known after writing the blocks when encoding them one by one
+		std::vector<int> blockSizes;
+
+		if (saveThreads > 1) {
+			// Encode every block into its own buffer, the header then gets the final sizes up front
+			std::vector<std::vector<char>> blockData(hdr.GetNumBlocks());
+			ParallelFor(blockData.size(), saveThreads, [&](const size_t i, const uint) {
+				NiStream blockStream(&blockData[i], &hdr.GetVersion());
+				blockToWrite(i)->Put(blockStream);
+			});
+
+			for (uint i = 0; i < hdr.GetNumBlocks(); i++)
+				hdr.SetBlockSize(i, blockData[i].size());
+
+			hdr.Put(stream);
+			hdr.ResetBlockSizeStreamPos();
+
+			for (auto &data : blockData)
+				stream.write(data.data(), data.size());
+		}
+		else {
+			hdr.Put(stream);
 			stream.InitBlockSize();
+
+			// Retrieve block sizes from NiStream while writing
+			blockSizes.resize(hdr.GetNumBlocks());
+			for (uint i = 0; i < hdr.GetNumBlocks(); i++) {
+				blockToWrite(i)->Put(stream);
+				blockSizes[i] = stream.GetBlockSize();
+				stream.InitBlockSize();
+			}
 		}
 
 		uint endPad = 1;
@@ -952,11 +1200,13 @@ int NifFile::Save(std::iostream &file, const NifSaveOptions& options) {
 		// Get previous stream pos of block size array and overwrite
 		std::streampos blockSizePos = hdr.GetBlockSizeStreamPos();
 		if (blockSizePos != std::streampos()) {
-			file.seekg(blockSizePos);
+			// Seek the write position, streams other than files keep separate read and write positions
+			std::streampos endPos = file.tellp();
+			file.seekp(blockSizePos);
 
-			for (int i = 0; i < hdr.GetNumBlocks(); i++)
-				stream << blockSizes[i];
+			stream.writeArray(blockSizes.data(), hdr.GetNumBlocks());
 
+			file.seekp(endPos);
 			hdr.ResetBlockSizeStreamPos();
 		}
 	}
@@ -990,12 +1240,19 @@ OptResult NifFile::OptimizeFor(OptOptions& options) {
 			if (geomData) {
 				bool removeVertexColors = true;
 				bool hasTangents = geomData->HasTangents();
-				std::vector<Vector3>* vertices = &geomData->vertices;
-				std::vector<Vector3>* normals = &geomData->normals;
-				const std::vector<Color4>& colors = geomData->vertexColors;
+				// The new shape is created from plain vectors
+				std::vector<Vector3> vertexData(geomData->vertices.begin(), geomData->vertices.end());
+				std::vector<Vector3> normalData(geomData->normals.begin(), geomData->normals.end());
+				std::vector<Vector2> uvData;
+
+				std::vector<Vector3>* vertices = &vertexData;
+				std::vector<Vector3>* normals = &normalData;
+				const BlockVector<Color4>& colors = geomData->vertexColors;
 				std::vector<Vector2>* uvs = nullptr;
-				if (!geomData->uvSets.empty())
-					uvs = &geomData->uvSets[0];
+				if (!geomData->uvSets.empty()) {
+					uvData.assign(geomData->uvSets[0].begin(), geomData->uvSets[0].end());
+					uvs = &uvData;
+				}
 
 				std::vector<Triangle> triangles;
 				geomData->GetTriangles(triangles);
@@ -1039,12 +1296,14 @@ OptResult NifFile::OptimizeFor(OptOptions& options) {
 						if (removeVertexColors) {
 							bslsp->SetVertexColors(false);
 							bslsp->SetVertexAlpha(false);
+							SetBlockModified(bslsp);
 						}
 
 						if (options.removeParallax) {
 							if (bslsp->GetShaderType() == BSLSP_PARALLAX) {
 								// Change type from parallax to default
 								bslsp->SetShaderType(BSLSP_DEFAULT);
+								SetBlockModified(bslsp);
 
 								// Remove parallax flag
 								bslsp->shaderFlags1 &= ~(1 << 11);
@@ -1073,6 +1332,7 @@ OptResult NifFile::OptimizeFor(OptOptions& options) {
 						if (removeVertexColors) {
 							bsesp->SetVertexColors(false);
 							bsesp->SetVertexAlpha(false);
+							SetBlockModified(bsesp);
 						}
 					}
 				}
@@ -1137,6 +1397,8 @@ OptResult NifFile::OptimizeFor(OptOptions& options) {
 							f = std::max(0.0f, std::min(1.0f, colors[i].a));
 							vertex.colorData[3] = (byte)std::floor(f == 1.0f ? 255 : f * 256.0);
 						}
+
+						bsOptShape->InvalidateVertexStreams();
 					}
 
 					// Find NiOptimizeKeep string
@@ -1199,6 +1461,7 @@ OptResult NifFile::OptimizeFor(OptOptions& options) {
 									part.triangles = part.trueTriangles;
 								}
 								skinPart->bMappedIndices = false;
+								bsOptShape->InvalidateVertexStreams();
 							}
 						}
 					}
@@ -1245,10 +1508,22 @@ OptResult NifFile::OptimizeFor(OptOptions& options) {
 			if (bsTriShape) {
 				bool removeVertexColors = true;
 				bool hasTangents = bsTriShape->HasTangents();
-				std::vector<Vector3>* vertices = bsTriShape->GetRawVerts();
-				std::vector<Vector3>* normals = bsTriShape->GetNormalData(false);
-				std::vector<Color4>* colors = bsTriShape->GetColorData();
-				std::vector<Vector2>* uvs = bsTriShape->GetUVData();
+				// The new shape is created from plain vectors
+				auto rawVerts = bsTriShape->GetRawVerts();
+				auto rawNormals = bsTriShape->GetNormalData(false);
+				auto rawUvs = bsTriShape->GetUVData();
+				std::vector<Vector3> vertexData(rawVerts->begin(), rawVerts->end());
+				std::vector<Vector3> normalData;
+				std::vector<Vector2> uvData;
+				if (rawNormals)
+					normalData.assign(rawNormals->begin(), rawNormals->end());
+				if (rawUvs)
+					uvData.assign(rawUvs->begin(), rawUvs->end());
+
+				std::vector<Vector3>* vertices = &vertexData;
+				std::vector<Vector3>* normals = rawNormals ? &normalData : nullptr;
+				const BlockVector<Color4>* colors = bsTriShape->GetColorData();
+				std::vector<Vector2>* uvs = rawUvs ? &uvData : nullptr;
 
 				std::vector<Triangle> triangles;
 				bsTriShape->GetTriangles(triangles);
@@ -1292,12 +1567,14 @@ OptResult NifFile::OptimizeFor(OptOptions& options) {
 						if (removeVertexColors) {
 							bslsp->SetVertexColors(false);
 							bslsp->SetVertexAlpha(false);
+							SetBlockModified(bslsp);
 						}
 
 						if (options.removeParallax) {
 							if (bslsp->GetShaderType() == BSLSP_PARALLAX) {
 								// Change type from parallax to default
 								bslsp->SetShaderType(BSLSP_DEFAULT);
+								SetBlockModified(bslsp);
 
 								// Remove parallax flag
 								bslsp->shaderFlags1 &= ~(1 << 11);
@@ -1326,6 +1603,7 @@ OptResult NifFile::OptimizeFor(OptOptions& options) {
 						if (removeVertexColors) {
 							bsesp->SetVertexColors(false);
 							bsesp->SetVertexAlpha(false);
+							SetBlockModified(bsesp);
 						}
 					}
 				}
@@ -1420,10 +1698,12 @@ OptResult NifFile::OptimizeFor(OptOptions& options) {
 	return result;
 }
 
-void NifFile::PrepareData() {
+void NifFile::PrepareData(const bool trimTexturePaths) {
 	hdr.FillStringRefs();
 	LinkGeomData();
-	TrimTexturePaths();
+
+	if (trimTexturePaths)
+		TrimTexturePaths();
 
 	for (auto &shape : GetShapes()) {
 		// Move triangle and vertex data from partition to shape
@@ -1459,6 +1739,8 @@ void NifFile::PrepareData() {
 					dynamicShape->vertData[i].vert.z = dynamicShape->dynamicData[i].z;
 					dynamicShape->vertData[i].bitangentX = dynamicShape->dynamicData[i].w;
 				}
+
+				dynamicShape->InvalidateVertexStreams();
 			}
 		}
 	}
@@ -1466,8 +1748,25 @@ void NifFile::PrepareData() {
 	RemoveInvalidTris();
 }
 
-void NifFile::FinalizeData() {
-	for (auto &shape : GetShapes()) {
+void NifFile::FinalizeData(const bool modifiedOnly) {
+	std::vector<NiShape*> shapes;
+	if (modifiedOnly) {
+		for (uint i = 0; i < hdr.GetNumBlocks(); i++) {
+			if (!hdr.IsBlockModified(i))
+				continue;
+
+			auto shape = hdr.GetBlock<NiShape>(i);
+			if (shape) {
+				// Geometry data is edited through the shape
+				hdr.SetBlockModified(shape->GetDataRef());
+				shapes.push_back(shape);
+			}
+		}
+	}
+	else
+		shapes = GetShapes();
+
+	for (auto &shape : shapes) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
 		if (bsTriShape) {
 			auto bsDynTriShape = dynamic_cast<BSDynamicTriShape*>(shape);
@@ -1513,9 +1812,9 @@ bool NifFile::IsSSECompatible(NiShape* shape) {
 	if (shape->HasType<NiTriStrips>())
 		return false;
 
-	auto skinInst = hdr.GetBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
+	auto skinInst = hdr.LoadBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
 	if (skinInst) {
-		auto skinPart = hdr.GetBlock<NiSkinPartition>(skinInst->GetSkinPartitionRef());
+		auto skinPart = hdr.LoadBlock<NiSkinPartition>(skinInst->GetSkinPartitionRef());
 		if (skinPart) {
 			for (auto &partition : skinPart->partitions) {
 				if (partition.numStrips > 0)
@@ -1529,28 +1828,19 @@ bool NifFile::IsSSECompatible(NiShape* shape) {
 
 std::vector<std::string> NifFile::GetShapeNames() {
 	std::vector<std::string> outList;
-	for (auto& block : blocks) {
-		auto shape = dynamic_cast<NiShape*>(block.get());
-		if (shape)
-			outList.push_back(shape->GetName());
-	}
+	for (auto& shape : GetShapes())
+		outList.push_back(shape->GetName());
+
 	return outList;
 }
 
 std::vector<NiShape *> NifFile::GetShapes() {
-	std::vector<NiShape*> outList;
-	for (auto& block : blocks) {
-		auto shape = dynamic_cast<NiShape*>(block.get());
-		if (shape)
-			outList.push_back(shape);
-	}
-
-	return outList;
+	return hdr.GetBlocks<NiShape>();
 }
 
 bool NifFile::RenameShape(NiShape* shape, const std::string& newName) {
 	if (shape) {
-		shape->SetName(newName);
+		hdr.SetBlockName(GetBlockID(shape), newName);
 		return true;
 	}
 
@@ -1566,7 +1856,7 @@ bool NifFile::RenameDuplicateShapes() {
 		std::set<int> uniqueRefs;
 		for (auto &child : parent->GetChildren()) {
 			int childIndex = child.GetIndex();
-			auto obj = hdr.GetBlock<NiAVObject>(childIndex);
+			auto obj = hdr.LoadBlock<NiAVObject>(childIndex);
 			if (obj) {
 				if (uniqueRefs.find(childIndex) == uniqueRefs.end()) {
 					names.push_back(obj->GetName());
@@ -1589,7 +1879,7 @@ bool NifFile::RenameDuplicateShapes() {
 		int dupCount = 0;
 
 		for (auto &child : node->GetChildren()) {
-			auto shape = hdr.GetBlock<NiShape>(child.GetIndex());
+			auto shape = hdr.LoadBlock<NiShape>(child.GetIndex());
 			if (shape) {
 				// Skip first child
 				if (dupCount == 0) {
@@ -1608,7 +1898,7 @@ bool NifFile::RenameDuplicateShapes() {
 						dup = "_" + std::to_string(dupCount);
 					}
 
-					shape->SetName(shapeName + dup);
+					hdr.SetBlockName(child.GetIndex(), shapeName + dup);
 					dupCount++;
 					renamed = true;
 				}
@@ -1642,16 +1932,12 @@ void NifFile::TriangulateShape(NiShape* shape) {
 
 NiNode* NifFile::GetRootNode() {
 	// Check if block at index 0 is a node
-	auto root = hdr.GetBlock<NiNode>(0);
+	auto root = hdr.LoadBlock<NiNode>(0);
 	if (!root) {
 		// Not a node, look for first node block
-		for (auto &block : blocks) {
-			auto node = dynamic_cast<NiNode*>(block.get());
-			if (node) {
-				root = node;
-				break;
-			}
-		}
+		auto nodes = hdr.GetBlocks<NiNode>();
+		if (!nodes.empty())
+			root = nodes.front();
 	}
 	return root;
 }
@@ -1663,70 +1949,71 @@ void NifFile::GetTree(std::vector<NiObject*>& result, NiObject* parent) {
 			return;
 	}
 
+	std::unordered_set<NiObject*> added(result.begin(), result.end());
+	GetTree(result, parent, added);
+}
+
+void NifFile::GetTree(std::vector<NiObject*>& result, NiObject* parent, std::unordered_set<NiObject*>& added) {
 	std::vector<int> indices;
 	parent->GetChildIndices(indices);
 
 	auto constraint = dynamic_cast<bhkConstraint*>(parent);
 	if (constraint) {
 		for (auto& entityId : constraint->GetEntities()) {
-			auto entity = hdr.GetBlock<NiObject>(entityId.GetIndex());
+			auto entity = hdr.LoadBlock<NiObject>(entityId.GetIndex());
 			if (entity)
-				GetTree(result, entity);
+				GetTree(result, entity, added);
 		}
 	}
 
 	for (auto& id : indices) {
-		auto child = hdr.GetBlock<NiObject>(id);
+		auto child = hdr.LoadBlock<NiObject>(id);
 		if (child) {
-			if (std::find(result.begin(), result.end(), child) == result.end()) {
+			if (added.find(child) == added.end()) {
 				bool childBeforeParent = child->HasType<bhkRefObject>() && !child->HasType<bhkConstraint>();
 				if (childBeforeParent)
-					GetTree(result, child);
+					GetTree(result, child, added);
 			}
 		}
 	}
 
 	result.push_back(parent);
+	added.insert(parent);
 
 	for (auto& id : indices) {
-		auto child = hdr.GetBlock<NiObject>(id);
+		auto child = hdr.LoadBlock<NiObject>(id);
 		if (child) {
-			if (std::find(result.begin(), result.end(), child) == result.end()) {
+			if (added.find(child) == added.end()) {
 				bool childBeforeParent = child->HasType<bhkRefObject>() && !child->HasType<bhkConstraint>();
 				if (!childBeforeParent)
-					GetTree(result, child);
+					GetTree(result, child, added);
 			}
 		}
 	}
 }
 
 bool NifFile::GetNodeTransformToParent(const std::string& nodeName, MatTransform& outTransform) {
-	for (auto& block : blocks) {
-		auto node = dynamic_cast<NiNode*>(block.get());
-		if (node && !node->GetName().compare(nodeName)) {
-			outTransform = node->GetTransformToParent();
-			return true;
-		}
+	auto node = FindBlockByName<NiNode>(nodeName);
+	if (node) {
+		outTransform = node->GetTransformToParent();
+		return true;
 	}
 	return false;
 }
 
 bool NifFile::GetNodeTransformToGlobal(const std::string& nodeName, MatTransform& outTransform) {
-	for (auto& block : blocks) {
-		NiNode *node = dynamic_cast<NiNode*>(block.get());
-		if (!node || node->GetName().compare(nodeName) != 0)
-			continue;
-		MatTransform xform = node->GetTransformToParent();
-		NiNode *parent = GetParentNode(node);
-		while (parent) {
-			xform = parent->GetTransformToParent().ComposeTransforms(xform);
-			parent = GetParentNode(parent);
-		}
-		outTransform = xform;
-		return true;
-	}
+	NiNode *node = FindBlockByName<NiNode>(nodeName);
+	if (!node)
+		return false;
 
-	return false;
+	MatTransform xform = node->GetTransformToParent();
+	NiNode *parent = GetParentNode(node);
+	while (parent) {
+		xform = parent->GetTransformToParent().ComposeTransforms(xform);
+		parent = GetParentNode(parent);
+	}
+	outTransform = xform;
+	return true;
 }
 
 bool NifFile::SetNodeTransformToParent(const std::string& nodeName, const MatTransform& inTransform, const bool rootChildrenOnly) {
@@ -1734,10 +2021,11 @@ bool NifFile::SetNodeTransformToParent(const std::string& nodeName, const MatTra
 		auto root = GetRootNode();
 		if (root) {
 			for (auto& child : root->GetChildren()) {
-				auto node = hdr.GetBlock<NiNode>(child.GetIndex());
+				auto node = hdr.LoadBlock<NiNode>(child.GetIndex());
 				if (node) {
 					if (!node->GetName().compare(nodeName)) {
 						node->SetTransformToParent(inTransform);
+						SetBlockModified(node);
 						return true;
 					}
 				}
@@ -1745,12 +2033,11 @@ bool NifFile::SetNodeTransformToParent(const std::string& nodeName, const MatTra
 		}
 	}
 	else {
-		for (auto& block : blocks) {
-			auto node = dynamic_cast<NiNode*>(block.get());
-			if (node && !node->GetName().compare(nodeName)) {
-				node->SetTransformToParent(inTransform);
-				return true;
-			}
+		auto node = FindBlockByName<NiNode>(nodeName);
+		if (node) {
+			node->SetTransformToParent(inTransform);
+			SetBlockModified(node);
+			return true;
 		}
 	}
 
@@ -1763,13 +2050,13 @@ int NifFile::GetShapeBoneList(NiShape* shape, std::vector<std::string>& outList)
 	if (!shape)
 		return 0;
 
-	auto skinInst = hdr.GetBlock<NiBoneContainer>(shape->GetSkinInstanceRef());
+	auto skinInst = hdr.LoadBlock<NiBoneContainer>(shape->GetSkinInstanceRef());
 	if (!skinInst)
 		return 0;
 	
 	auto& bones = skinInst->GetBones();
 	for (int i = 0; i < bones.GetSize(); i++) {
-		auto node = hdr.GetBlock<NiNode>(bones.GetBlockRef(i));
+		auto node = hdr.LoadBlock<NiNode>(bones.GetBlockRef(i));
 		if (node)
 			outList.push_back(node->GetName());
 	}
@@ -1783,7 +2070,7 @@ int NifFile::GetShapeBoneIDList(NiShape* shape, std::vector<int>& outList) {
 	if (!shape)
 		return 0;
 
-	auto skinInst = hdr.GetBlock<NiBoneContainer>(shape->GetSkinInstanceRef());
+	auto skinInst = hdr.LoadBlock<NiBoneContainer>(shape->GetSkinInstanceRef());
 	if (!skinInst)
 		return 0;
 
@@ -1808,7 +2095,8 @@ void NifFile::SetShapeBoneIDList(NiShape* shape, std::vector<int>& inList) {
 			boneData = hdr.GetBlock<BSSkinBoneData>(skinForBoneRef->GetDataRef());
 	}
 
-	auto boneCont = hdr.GetBlock<NiBoneContainer>(shape->GetSkinInstanceRef());
+	int boneContId = shape->GetSkinInstanceRef();
+	auto boneCont = hdr.GetBlock<NiBoneContainer>(boneContId);
 	if (!boneCont)
 		return;
 
@@ -1823,7 +2111,7 @@ void NifFile::SetShapeBoneIDList(NiShape* shape, std::vector<int>& inList) {
 	}
 
 	for (auto &i : inList) {
-		boneCont->GetBones().AddBlockRef(i);
+		hdr.AddBlockRef(boneContId, boneCont->GetBones(), i);
 		if (boneData && feedBoneData) {
 			boneData->boneXforms.emplace_back();
 			boneData->nBones++;
@@ -1871,11 +2159,11 @@ int NifFile::GetShapeBoneWeights(NiShape* shape, const int boneIndex, std::unord
 		return outWeights.size();
 	}
 
-	auto skinInst = hdr.GetBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
+	auto skinInst = hdr.LoadBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
 	if (!skinInst)
 		return 0;
 
-	auto skinData = hdr.GetBlock<NiSkinData>(skinInst->GetDataRef());
+	auto skinData = hdr.LoadBlock<NiSkinData>(skinInst->GetDataRef());
 	if (!skinData || boneIndex >= skinData->numBones)
 		return 0;
 
@@ -1887,6 +2175,80 @@ int NifFile::GetShapeBoneWeights(NiShape* shape, const int boneIndex, std::unord
 	return outWeights.size();
 }
 
+int NifFile::GetShapeBoneWeights(NiShape* shape, BoneWeightColumns& outWeights) {
+	outWeights.Clear();
+
+	if (!shape)
+		return 0;
+
+	auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
+	if (bsTriShape) {
+		VertexWeightRows rows;
+		GetShapeVertexWeights(shape, rows);
+
+		std::vector<int> boneIds;
+		size_t numBones = GetShapeBoneIDList(shape, boneIds);
+		for (size_t i = 0; i < rows.bones.size(); i++)
+			if (rows.weights[i] != 0.0f)
+				numBones = std::max<size_t>(numBones, rows.bones[i] + 1);
+
+		WeightRowsToColumns(rows, numBones, outWeights);
+		return outWeights.GetNumBones();
+	}
+
+	auto skinInst = hdr.LoadBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
+	if (!skinInst)
+		return 0;
+
+	auto skinData = hdr.LoadBlock<NiSkinData>(skinInst->GetDataRef());
+	if (!skinData)
+		return 0;
+
+	outWeights.offsets.reserve(skinData->bones.size() + 1);
+	outWeights.offsets.push_back(0);
+
+	for (auto& bone : skinData->bones) {
+		for (auto& sw : bone.vertexWeights) {
+			if (sw.weight >= EPSILON) {
+				outWeights.vertices.push_back(sw.index);
+				outWeights.weights.push_back(sw.weight);
+			}
+		}
+
+		outWeights.offsets.push_back(outWeights.vertices.size());
+	}
+
+	return outWeights.GetNumBones();
+}
+
+int NifFile::GetShapeVertexWeights(NiShape* shape, VertexWeightRows& outWeights) {
+	outWeights.Reset(0);
+
+	if (!shape)
+		return 0;
+
+	auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
+	if (bsTriShape) {
+		outWeights.Reset(bsTriShape->vertData.size());
+
+		for (size_t vid = 0; vid < bsTriShape->vertData.size(); vid++) {
+			auto& vertex = bsTriShape->vertData[vid];
+			for (int i = 0; i < VertexWeightRows::MaxInfluences; i++) {
+				outWeights.bones[vid * VertexWeightRows::MaxInfluences + i] = vertex.weightBones[i];
+				outWeights.weights[vid * VertexWeightRows::MaxInfluences + i] = vertex.weights[i];
+			}
+		}
+
+		return outWeights.GetNumVertices();
+	}
+
+	BoneWeightColumns columns;
+	GetShapeBoneWeights(shape, columns);
+	WeightColumnsToRows(columns, shape->GetNumVertices(), outWeights);
+
+	return outWeights.GetNumVertices();
+}
+
 bool NifFile::CalcShapeTransformGlobalToSkin(NiShape* shape, MatTransform& outTransform) {
 	if (!shape)
 		return false;
@@ -1921,11 +2283,11 @@ bool NifFile::GetShapeTransformGlobalToSkin(NiShape* shape, MatTransform& outTra
 	// For FO4 meshes, the skin instance is a BSSkinInstance instead of
 	// an NiSkinInstance, so skinInst will be nullptr.  FO4 meshes do not
 	// have this transform.
-	auto skinInst = hdr.GetBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
+	auto skinInst = hdr.LoadBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
 	if (!skinInst)
 		return false;
 
-	auto skinData = hdr.GetBlock<NiSkinData>(skinInst->GetDataRef());
+	auto skinData = hdr.LoadBlock<NiSkinData>(skinInst->GetDataRef());
 	if (!skinData)
 		return false;
 
@@ -1962,9 +2324,9 @@ bool NifFile::GetShapeTransformSkinToBone(NiShape* shape, const int boneIndex, M
 	if (!shape)
 		return false;
 
-	auto skinForBoneRef = hdr.GetBlock<BSSkinInstance>(shape->GetSkinInstanceRef());
+	auto skinForBoneRef = hdr.LoadBlock<BSSkinInstance>(shape->GetSkinInstanceRef());
 	if (skinForBoneRef) {
-		auto boneData = hdr.GetBlock<BSSkinBoneData>(skinForBoneRef->GetDataRef());
+		auto boneData = hdr.LoadBlock<BSSkinBoneData>(skinForBoneRef->GetDataRef());
 		if (boneData) {
 			if (boneIndex >= boneData->nBones)
 				return false;
@@ -1974,11 +2336,11 @@ bool NifFile::GetShapeTransformSkinToBone(NiShape* shape, const int boneIndex, M
 		}
 	}
 
-	auto skinInst = hdr.GetBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
+	auto skinInst = hdr.LoadBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
 	if (!skinInst)
 		return false;
 
-	auto skinData = hdr.GetBlock<NiSkinData>(skinInst->GetDataRef());
+	auto skinData = hdr.LoadBlock<NiSkinData>(skinInst->GetDataRef());
 	if (!skinData)
 		return false;
 
@@ -2078,20 +2440,20 @@ bool NifFile::GetShapeBoneBounds(NiShape* shape, const int boneIndex, BoundingSp
 	if (!shape)
 		return false;
 
-	auto skinForBoneRef = hdr.GetBlock<BSSkinInstance>(shape->GetSkinInstanceRef());
+	auto skinForBoneRef = hdr.LoadBlock<BSSkinInstance>(shape->GetSkinInstanceRef());
 	if (skinForBoneRef) {
-		auto boneData = hdr.GetBlock<BSSkinBoneData>(skinForBoneRef->GetDataRef());
+		auto boneData = hdr.LoadBlock<BSSkinBoneData>(skinForBoneRef->GetDataRef());
 		if (boneData) {
 			outBounds = boneData->boneXforms[boneIndex].bounds;
 			return true;
 		}
 	}
 
-	auto skinInst = hdr.GetBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
+	auto skinInst = hdr.LoadBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
 	if (!skinInst)
 		return false;
 
-	auto skinData = hdr.GetBlock<NiSkinData>(skinInst->GetDataRef());
+	auto skinData = hdr.LoadBlock<NiSkinData>(skinInst->GetDataRef());
 	if (!skinData)
 		return false;
 
@@ -2108,13 +2470,14 @@ void NifFile::UpdateShapeBoneID(const std::string& shapeName, const int oldID, c
 	if (!shape)
 		return;
 
-	auto boneCont = hdr.GetBlock<NiBoneContainer>(shape->GetSkinInstanceRef());
+	int boneContId = shape->GetSkinInstanceRef();
+	auto boneCont = hdr.GetBlock<NiBoneContainer>(boneContId);
 	if (!boneCont)
 		return;
 
 	for (auto &bp : boneCont->GetBones()) {
 		if (bp.GetIndex() == oldID) {
-			bp.SetIndex(newID);
+			hdr.SetBlockRef(boneContId, bp, newID);
 			return;
 		}
 	}
@@ -2146,6 +2509,68 @@ void NifFile::SetShapeBoneWeights(const std::string& shapeName, const int boneIn
 	bone->numVertices = (ushort)bone->vertexWeights.size();
 }
 
+void NifFile::SetShapeBoneWeights(NiShape* shape, const BoneWeightColumns& inWeights) {
+	if (!shape)
+		return;
+
+	auto skinInst = hdr.GetBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
+	if (!skinInst)
+		return;
+
+	auto skinData = hdr.GetBlock<NiSkinData>(skinInst->GetDataRef());
+	if (!skinData)
+		return;
+
+	size_t numBones = std::min<size_t>(skinData->numBones, inWeights.GetNumBones());
+	for (size_t b = 0; b < numBones; b++) {
+		NiSkinData::BoneData* bone = &skinData->bones[b];
+		bone->vertexWeights.clear();
+		bone->vertexWeights.reserve(inWeights.GetColumnSize(b));
+
+		for (uint i = inWeights.offsets[b]; i < inWeights.offsets[b + 1]; i++)
+			if (inWeights.weights[i] >= 0.0001f)
+				bone->vertexWeights.emplace_back(inWeights.vertices[i], inWeights.weights[i]);
+
+		bone->numVertices = (ushort)bone->vertexWeights.size();
+	}
+}
+
+void NifFile::SetShapeVertexWeights(NiShape* shape, const VertexWeightRows& inWeights) {
+	if (!shape)
+		return;
+
+	auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
+	if (!bsTriShape) {
+		auto skinInst = hdr.GetBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
+		auto skinData = skinInst ? hdr.GetBlock<NiSkinData>(skinInst->GetDataRef()) : nullptr;
+		if (!skinData)
+			return;
+
+		BoneWeightColumns columns;
+		WeightRowsToColumns(inWeights, skinData->numBones, columns);
+		SetShapeBoneWeights(shape, columns);
+		return;
+	}
+
+	SetBlockModified(bsTriShape);
+
+	size_t numVerts = std::min(bsTriShape->vertData.size(), inWeights.GetNumVertices());
+	for (size_t vid = 0; vid < numVerts; vid++) {
+		auto& vertex = bsTriShape->vertData[vid];
+		const ushort* bones = &inWeights.bones[vid * VertexWeightRows::MaxInfluences];
+		const float* weights = &inWeights.weights[vid * VertexWeightRows::MaxInfluences];
+
+		// Normalized like SetShapeVertWeights
+		float sum = weights[0] + weights[1] + weights[2] + weights[3];
+		for (int i = 0; i < VertexWeightRows::MaxInfluences; i++) {
+			vertex.weightBones[i] = (byte)bones[i];
+			vertex.weights[i] = sum > 0.0f ? weights[i] / sum : 0.0f;
+		}
+	}
+
+	bsTriShape->InvalidateVertexStreams();
+}
+
 void NifFile::SetShapeVertWeights(const std::string& shapeName, const int vertIndex, std::vector<byte>& boneids, std::vector<float>& weights) {
 	auto shape = FindBlockByName<NiShape>(shapeName);
 	if (!shape)
@@ -2158,6 +2583,8 @@ void NifFile::SetShapeVertWeights(const std::string& shapeName, const int vertIn
 	if (vertIndex < 0 || vertIndex >= bsTriShape->vertData.size())
 		return;
 
+	SetBlockModified(bsTriShape);
+
 	auto& vertex = bsTriShape->vertData[vertIndex];
 	std::memset(vertex.weights, 0, sizeof(float) * 4);
 	std::memset(vertex.weightBones, 0, sizeof(byte) * 4);
@@ -2173,6 +2600,8 @@ void NifFile::SetShapeVertWeights(const std::string& shapeName, const int vertIn
 		vertex.weightBones[i] = boneids[i];
 		vertex.weights[i] = weights[i] / sum;
 	}
+
+	bsTriShape->InvalidateVertexStreams();
 }
 
 void NifFile::ClearShapeVertWeights(const std::string& shapeName) {
@@ -2184,10 +2613,14 @@ void NifFile::ClearShapeVertWeights(const std::string& shapeName) {
 	if (!bsTriShape)
 		return;
 
+	SetBlockModified(bsTriShape);
+
 	for (auto &vertex : bsTriShape->vertData) {
 		std::memset(vertex.weights, 0, sizeof(float) * 4);
 		std::memset(vertex.weightBones, 0, sizeof(byte) * 4);
 	}
+
+	bsTriShape->InvalidateVertexStreams();
 }
 
 bool NifFile::GetShapeSegments(NiShape* shape, NifSegmentationInfo& inf, std::vector<int>& triParts) {
@@ -2205,23 +2638,24 @@ void NifFile::SetShapeSegments(NiShape* shape, const NifSegmentationInfo& inf, c
 		return;
 
 	bssits->SetSegmentation(inf, triParts);
+	SetBlockModified(bssits);
 }
 
 bool NifFile::GetShapePartitions(NiShape* shape, std::vector<BSDismemberSkinInstance::PartitionInfo>& partitionInfo, std::vector<int> &triParts) {
 	if (!shape)
 		return false;
 
-	auto bsdSkinInst = hdr.GetBlock<BSDismemberSkinInstance>(shape->GetSkinInstanceRef());
+	auto bsdSkinInst = hdr.LoadBlock<BSDismemberSkinInstance>(shape->GetSkinInstanceRef());
 	if (bsdSkinInst)
 		partitionInfo = bsdSkinInst->GetPartitions();
 	else
 		partitionInfo.clear();
 
-	auto skinInst = hdr.GetBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
+	auto skinInst = hdr.LoadBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
 	if (!skinInst)
 		return false;
 
-	auto skinPart = hdr.GetBlock<NiSkinPartition>(skinInst->GetSkinPartitionRef());
+	auto skinPart = hdr.LoadBlock<NiSkinPartition>(skinInst->GetSkinPartitionRef());
 	if (!skinPart)
 		return false;
 
@@ -2314,18 +2748,18 @@ void NifFile::SetDefaultPartition(NiShape* shape) {
 	std::vector<Vector3> verts;
 	bool bMappedIndices = true;
 	if (shape->HasType<NiTriShape>()) {
-		auto shapeData = hdr.GetBlock<NiTriShapeData>(shape->GetDataRef());
+		auto shapeData = hdr.LoadBlock<NiTriShapeData>(shape->GetDataRef());
 		if (!shapeData)
 			return;
 
-		verts = shapeData->vertices;
+		verts.assign(shapeData->vertices.begin(), shapeData->vertices.end());
 	}
 	else if (shape->HasType<NiTriStrips>()) {
-		auto stripsData = hdr.GetBlock<NiTriStripsData>(shape->GetDataRef());
+		auto stripsData = hdr.LoadBlock<NiTriStripsData>(shape->GetDataRef());
 		if (!stripsData)
 			return;
 
-		verts = stripsData->vertices;
+		verts.assign(stripsData->vertices.begin(), stripsData->vertices.end());
 	}
 	else if (shape->HasType<BSTriShape>()) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
@@ -2334,7 +2768,7 @@ void NifFile::SetDefaultPartition(NiShape* shape) {
 
 		auto rawVerts = bsTriShape->GetRawVerts();
 		if (rawVerts)
-			verts = (*rawVerts);
+			verts.assign(rawVerts->begin(), rawVerts->end());
 
 		bMappedIndices = false;
 	}
@@ -2364,12 +2798,12 @@ void NifFile::SetDefaultPartition(NiShape* shape) {
 			for (int i = 0; i < vertIndices.size(); i++)
 				vertIndices[i] = i;
 
-			part.vertexMap = vertIndices;
+			part.vertexMap.assign(vertIndices.begin(), vertIndices.end());
 		}
 
 		if (!tris.empty()) {
 			part.numTriangles = tris.size();
-			part.trueTriangles = tris;
+			part.trueTriangles.assign(tris.begin(), tris.end());
 			if (!bMappedIndices)
 				part.triangles = part.trueTriangles;
 		}
@@ -2403,12 +2837,12 @@ void NifFile::DeletePartitions(NiShape* shape, std::vector<int> &partInds) {
 	}
 }
 
-const std::vector<Vector3>* NifFile::GetRawVertsForShape(NiShape* shape) {
+const BlockVector<Vector3>* NifFile::GetRawVertsForShape(NiShape* shape) {
 	if (!shape)
 		return nullptr;
 
 	if (shape->HasType<NiTriBasedGeom>()) {
-		auto geomData = hdr.GetBlock<NiGeometryData>(shape->GetDataRef());
+		auto geomData = hdr.LoadBlock<NiGeometryData>(shape->GetDataRef());
 		if (geomData)
 			return &geomData->vertices;
 	}
@@ -2428,15 +2862,19 @@ bool NifFile::ReorderTriangles(NiShape* shape, const std::vector<uint>& triangle
 	if (shape->HasType<NiTriStrips>())
 		return false;
 
-	return shape->ReorderTriangles(triangleIndices);
+	if (!shape->ReorderTriangles(triangleIndices))
+		return false;
+
+	SetBlockModified(shape);
+	return true;
 }
 
-const std::vector<Vector3>* NifFile::GetNormalsForShape(NiShape* shape, bool transform) {
+const BlockVector<Vector3>* NifFile::GetNormalsForShape(NiShape* shape, bool transform) {
 	if (!shape || !shape->HasNormals())
 		return nullptr;
 
 	if (shape->HasType<NiTriBasedGeom>()) {
-		auto geomData = hdr.GetBlock<NiGeometryData>(shape->GetDataRef());
+		auto geomData = hdr.LoadBlock<NiGeometryData>(shape->GetDataRef());
 		if (geomData)
 			return &geomData->normals;
 	}
@@ -2449,12 +2887,12 @@ const std::vector<Vector3>* NifFile::GetNormalsForShape(NiShape* shape, bool tra
 	return nullptr;
 }
 
-const std::vector<Vector2>* NifFile::GetUvsForShape(NiShape* shape) {
+const BlockVector<Vector2>* NifFile::GetUvsForShape(NiShape* shape) {
 	if (!shape)
 		return nullptr;
 
 	if (shape->HasType<NiTriBasedGeom>()) {
-		auto geomData = hdr.GetBlock<NiGeometryData>(shape->GetDataRef());
+		auto geomData = hdr.LoadBlock<NiGeometryData>(shape->GetDataRef());
 		if (geomData && !geomData->uvSets.empty())
 			return &geomData->uvSets[0];
 	}
@@ -2467,13 +2905,13 @@ const std::vector<Vector2>* NifFile::GetUvsForShape(NiShape* shape) {
 	return nullptr;
 }
 
-const std::vector<Color4>* NifFile::GetColorsForShape(const std::string& shapeName) {
+const BlockVector<Color4>* NifFile::GetColorsForShape(const std::string& shapeName) {
 	auto shape = FindBlockByName<NiShape>(shapeName);
 	if (!shape)
 		return nullptr;
 
 	if (shape->HasType<NiTriBasedGeom>()) {
-		auto geomData = hdr.GetBlock<NiGeometryData>(shape->GetDataRef());
+		auto geomData = hdr.LoadBlock<NiGeometryData>(shape->GetDataRef());
 		if (geomData)
 			return &geomData->vertexColors;
 	}
@@ -2486,12 +2924,12 @@ const std::vector<Color4>* NifFile::GetColorsForShape(const std::string& shapeNa
 	return nullptr;
 }
 
-const std::vector<Vector3>* NifFile::GetTangentsForShape(NiShape* shape, bool transform) {
+const BlockVector<Vector3>* NifFile::GetTangentsForShape(NiShape* shape, bool transform) {
 	if (!shape || !shape->HasTangents())
 		return nullptr;
 
 	if (shape->HasType<NiTriBasedGeom>()) {
-		auto geomData = hdr.GetBlock<NiGeometryData>(shape->GetDataRef());
+		auto geomData = hdr.LoadBlock<NiGeometryData>(shape->GetDataRef());
 		if (geomData)
 			return &geomData->tangents;
 	}
@@ -2504,12 +2942,12 @@ const std::vector<Vector3>* NifFile::GetTangentsForShape(NiShape* shape, bool tr
 	return nullptr;
 }
 
-const std::vector<Vector3>* NifFile::GetBitangentsForShape(NiShape* shape, bool transform) {
+const BlockVector<Vector3>* NifFile::GetBitangentsForShape(NiShape* shape, bool transform) {
 	if (!shape || !shape->HasTangents())
 		return nullptr;
 
 	if (shape->HasType<NiTriBasedGeom>()) {
-		auto geomData = hdr.GetBlock<NiGeometryData>(shape->GetDataRef());
+		auto geomData = hdr.LoadBlock<NiGeometryData>(shape->GetDataRef());
 		if (geomData)
 			return &geomData->bitangents;
 	}
@@ -2522,19 +2960,21 @@ const std::vector<Vector3>* NifFile::GetBitangentsForShape(NiShape* shape, bool
 	return nullptr;
 }
 
-std::vector<float>* NifFile::GetEyeDataForShape(NiShape* shape) {
+BlockVector<float>* NifFile::GetEyeDataForShape(NiShape* shape) {
 	if (!shape)
 		return nullptr;
 
 	auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
-	if (bsTriShape)
+	if (bsTriShape) {
+		SetBlockModified(bsTriShape);
 		return bsTriShape->GetEyeData();
+	}
 
 	return nullptr;
 }
 
 bool NifFile::GetUvsForShape(NiShape* shape, std::vector<Vector2>& outUvs) {
-	const std::vector<Vector2>* uvData = GetUvsForShape(shape);
+	const BlockVector<Vector2>* uvData = GetUvsForShape(shape);
 	if (uvData) {
 		outUvs.assign(uvData->begin(), uvData->end());
 		return true;
@@ -2550,9 +2990,9 @@ bool NifFile::GetVertsForShape(NiShape* shape, std::vector<Vector3>& outVerts) {
 	}
 
 	if (shape->HasType<NiTriBasedGeom>()) {
-		auto geomData = hdr.GetBlock<NiGeometryData>(shape->GetDataRef());
+		auto geomData = hdr.LoadBlock<NiGeometryData>(shape->GetDataRef());
 		if (geomData) {
-			outVerts = geomData->vertices;
+			outVerts.assign(geomData->vertices.begin(), geomData->vertices.end());
 			return true;
 		}
 	}
@@ -2582,18 +3022,22 @@ void NifFile::SetVertsForShape(NiShape* shape, const std::vector<Vector3>& verts
 			if (verts.size() != geomData->vertices.size())
 				geomData->Create(&verts, nullptr, nullptr, nullptr);
 			else
-				geomData->vertices = verts;
+				geomData->vertices.assign(verts.begin(), verts.end());
 		}
 	}
 	else if (shape->HasType<BSTriShape>()) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
 		if (bsTriShape) {
+			SetBlockModified(bsTriShape);
+
 			if (verts.size() != bsTriShape->GetNumVertices()) {
 				bsTriShape->Create(&verts, nullptr, nullptr, nullptr);
 			}
 			else {
 				for (int i = 0; i < bsTriShape->GetNumVertices(); i++)
 					bsTriShape->vertData[i].vert = verts[i];
+
+				bsTriShape->InvalidateVertexStreams();
 			}
 		}
 	}
@@ -2610,12 +3054,14 @@ void NifFile::SetUvsForShape(NiShape* shape, const std::vector<Vector2>& uvs) {
 				return;
 
 			geomData->SetUVs(true);
-			geomData->uvSets[0] = uvs;
+			geomData->uvSets[0].assign(uvs.begin(), uvs.end());
 		}
 	}
 	else if (shape->HasType<BSTriShape>()) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
 		if (bsTriShape) {
+			SetBlockModified(bsTriShape);
+
 			if (uvs.size() != bsTriShape->vertData.size())
 				return;
 
@@ -2623,6 +3069,8 @@ void NifFile::SetUvsForShape(NiShape* shape, const std::vector<Vector2>& uvs) {
 
 			for (int i = 0; i < bsTriShape->GetNumVertices(); i++)
 				bsTriShape->vertData[i].uv = uvs[i];
+
+			bsTriShape->InvalidateVertexStreams();
 		}
 	}
 }
@@ -2639,12 +3087,14 @@ void NifFile::SetColorsForShape(const std::string& shapeName, const std::vector<
 				return;
 
 			geomData->SetVertexColors(true);
-			geomData->vertexColors = colors;
+			geomData->vertexColors.assign(colors.begin(), colors.end());
 		}
 	}
 	else if (shape->HasType<BSTriShape>()) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
 		if (bsTriShape) {
+			SetBlockModified(bsTriShape);
+
 			if (colors.size() != bsTriShape->vertData.size())
 				return;
 
@@ -2665,6 +3115,8 @@ void NifFile::SetColorsForShape(const std::string& shapeName, const std::vector<
 				f = std::max(0.0f, std::min(1.0f, colors[i].a));
 				vertex.colorData[3] = (byte)std::floor(f == 1.0f ? 255 : f * 256.0);
 			}
+
+			bsTriShape->InvalidateVertexStreams();
 		}
 	}
 }
@@ -2677,13 +3129,15 @@ void NifFile::SetTangentsForShape(NiShape* shape, const std::vector<Vector3>& in
 		auto geomData = hdr.GetBlock<NiGeometryData>(shape->GetDataRef());
 		if (geomData) {
 			geomData->SetTangents(true);
-			geomData->tangents = in;
+			geomData->tangents.assign(in.begin(), in.end());
 		}
 	}
 	else if (shape->HasType<BSTriShape>()) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
-		if (bsTriShape)
+		if (bsTriShape) {
+			SetBlockModified(bsTriShape);
 			bsTriShape->SetTangentData(in);
+		}
 	}
 }
 
@@ -2695,13 +3149,15 @@ void NifFile::SetBitangentsForShape(NiShape* shape, const std::vector<Vector3>&
 		auto geomData = hdr.GetBlock<NiGeometryData>(shape->GetDataRef());
 		if (geomData) {
 			geomData->SetTangents(true);
-			geomData->bitangents = in;
+			geomData->bitangents.assign(in.begin(), in.end());
 		}
 	}
 	else if (shape->HasType<BSTriShape>()) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
-		if (bsTriShape)
+		if (bsTriShape) {
+			SetBlockModified(bsTriShape);
 			bsTriShape->SetBitangentData(in);
+		}
 	}
 }
 
@@ -2710,8 +3166,10 @@ void NifFile::SetEyeDataForShape(NiShape* shape, const std::vector<float>& in) {
 		return;
 
 	auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
-	if (bsTriShape)
+	if (bsTriShape) {
+		SetBlockModified(bsTriShape);
 		bsTriShape->SetEyeData(in);
+	}
 }
 
 void NifFile::InvertUVsForShape(NiShape* shape, bool invertX, bool invertY) {
@@ -2733,6 +3191,8 @@ void NifFile::InvertUVsForShape(NiShape* shape, bool invertX, bool invertY) {
 	else if (shape->HasType<BSTriShape>()) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
 		if (bsTriShape) {
+			SetBlockModified(bsTriShape);
+
 			if (invertX)
 				for (int i = 0; i < bsTriShape->vertData.size(); ++i)
 					bsTriShape->vertData[i].uv.u = 1.0f - bsTriShape->vertData[i].uv.u;
@@ -2740,6 +3200,8 @@ void NifFile::InvertUVsForShape(NiShape* shape, bool invertX, bool invertY) {
 			if (invertY)
 				for (int i = 0; i < bsTriShape->vertData.size(); ++i)
 					bsTriShape->vertData[i].uv.v = 1.0f - bsTriShape->vertData[i].uv.v;
+
+			bsTriShape->InvalidateVertexStreams();
 		}
 	}
 }
@@ -2785,9 +3247,13 @@ void NifFile::MirrorShape(NiShape* shape, bool mirrorX, bool mirrorY, bool mirro
 	else if (shape->HasType<BSTriShape>()) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
 		if (bsTriShape) {
+			SetBlockModified(bsTriShape);
+
 			for (int i = 0; i < bsTriShape->vertData.size(); ++i) 
 				bsTriShape->vertData[i].vert = mirrorMat * bsTriShape->vertData[i].vert;
 
+			bsTriShape->InvalidateVertexStreams();
+
 			auto normals = bsTriShape->GetNormalData(false);
 			if (normals) {
 				for (int i = 0; i < normals->size(); ++i)
@@ -2809,6 +3275,7 @@ void NifFile::MirrorShape(NiShape* shape, bool mirrorX, bool mirrorY, bool mirro
 			std::swap(tris[i].p1, tris[i].p3);
 
 		shape->SetTriangles(tris);
+		SetBlockModified(shape);
 	}
 }
 
@@ -2820,13 +3287,15 @@ void NifFile::SetNormalsForShape(NiShape* shape, const std::vector<Vector3>& nor
 		auto geomData = hdr.GetBlock<NiGeometryData>(shape->GetDataRef());
 		if (geomData) {
 			geomData->SetNormals(true);
-			geomData->normals = norms;
+			geomData->normals.assign(norms.begin(), norms.end());
 		}
 	}
 	else if (shape->HasType<BSTriShape>()) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
-		if (bsTriShape)
+		if (bsTriShape) {
+			SetBlockModified(bsTriShape);
 			bsTriShape->SetNormals(norms);
+		}
 	}
 }
 
@@ -2843,7 +3312,7 @@ void NifFile::CalcNormalsForShape(NiShape* shape, const bool force, const bool s
 	std::unordered_set<uint> lockedIndices;
 
 	for (auto &extraDataRef : shape->GetExtraData()) {
-		auto integersExtraData = hdr.GetBlock<NiIntegersExtraData>(extraDataRef.GetIndex());
+		auto integersExtraData = hdr.LoadBlock<NiIntegersExtraData>(extraDataRef.GetIndex());
 		if (integersExtraData && integersExtraData->GetName() == "LOCKEDNORM")
 			for (auto& i : integersExtraData->GetIntegersData())
 				lockedIndices.insert(i);
@@ -2856,8 +3325,10 @@ void NifFile::CalcNormalsForShape(NiShape* shape, const bool force, const bool s
 	}
 	else if (shape->HasType<BSTriShape>()) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
-		if (bsTriShape)
+		if (bsTriShape) {
+			SetBlockModified(bsTriShape);
 			bsTriShape->RecalcNormals(smooth, smoothThresh, &lockedIndices);
+		}
 	}
 }
 
@@ -2872,8 +3343,10 @@ void NifFile::CalcTangentsForShape(NiShape* shape) {
 	}
 	else if (shape->HasType<BSTriShape>()) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
-		if (bsTriShape)
+		if (bsTriShape) {
+			SetBlockModified(bsTriShape);
 			bsTriShape->CalcTangentSpace();
+		}
 	}
 }
 
@@ -2892,7 +3365,7 @@ int NifFile::ApplyNormalsFromFile(NifFile& srcNif, const std::string& shapeName)
 	NiIntegersExtraData* integersExtraData = nullptr;
 
 	for (auto &extraDataRef : srcShape->GetExtraData()) {
-		integersExtraData = srcNif.GetHeader().GetBlock<NiIntegersExtraData>(extraDataRef.GetIndex());
+		integersExtraData = srcNif.GetHeader().LoadBlock<NiIntegersExtraData>(extraDataRef.GetIndex());
 		if (integersExtraData && integersExtraData->GetName() == "LOCKEDNORM")
 			for (auto& i : integersExtraData->GetIntegersData())
 				lockedNormalIndices.insert(i);
@@ -2915,7 +3388,7 @@ int NifFile::ApplyNormalsFromFile(NifFile& srcNif, const std::string& shapeName)
 	if (norms->size() != srcNorms->size())
 		return -6;
 
-	auto workNorms = (*norms);
+	std::vector<Vector3> workNorms(norms->begin(), norms->end());
 
 	// Copy locked normals of the source into the target
 	for (auto &i : lockedNormalIndices) {
@@ -2926,7 +3399,7 @@ int NifFile::ApplyNormalsFromFile(NifFile& srcNif, const std::string& shapeName)
 	SetNormalsForShape(shape, workNorms);
 
 	for (auto &extraDataRef : shape->GetExtraData()) {
-		auto oldIntegersExtraData = hdr.GetBlock<NiIntegersExtraData>(extraDataRef.GetIndex());
+		auto oldIntegersExtraData = hdr.LoadBlock<NiIntegersExtraData>(extraDataRef.GetIndex());
 		if (oldIntegersExtraData && oldIntegersExtraData->GetName() == "LOCKEDNORM")
 			hdr.DeleteBlock(extraDataRef.GetIndex());
 	}
@@ -2955,8 +3428,11 @@ void NifFile::MoveVertex(NiShape* shape, const Vector3& pos, const int id) {
 	}
 	else if (shape->HasType<BSTriShape>()) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
-		if (bsTriShape && bsTriShape->GetNumVertices() > id)
+		if (bsTriShape && bsTriShape->GetNumVertices() > id) {
+			SetBlockModified(bsTriShape);
 			bsTriShape->vertData[id].vert = pos;
+			bsTriShape->InvalidateVertexStreams();
+		}
 	}
 }
 
@@ -2985,6 +3461,8 @@ void NifFile::OffsetShape(NiShape* shape, const Vector3& offset, std::unordered_
 	else if (shape->HasType<BSTriShape>()) {
 		auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
 		if (bsTriShape) {
+			SetBlockModified(bsTriShape);
+
 			for (int i = 0; i < bsTriShape->GetNumVertices(); i++) {
 				if (mask) {
 					float maskFactor = 1.0f;
@@ -2998,6 +3476,8 @@ void NifFile::OffsetShape(NiShape* shape, const Vector3& offset, std::unordered_
 				else
 					bsTriShape->vertData[i].vert += offset;
 			}
+
+			bsTriShape->InvalidateVertexStreams();
 		}
 	}
 }
@@ -3014,21 +3494,16 @@ void NifFile::ScaleShape(NiShape* shape, const Vector3& scale, std::unordered_ma
 		if (!geomData)
 			return;
 
-		std::unordered_map<ushort, Vector3> diff;
 		for (int i = 0; i < geomData->vertices.size(); i++) {
 			Vector3 target = geomData->vertices[i] - root;
 			target.x *= scale.x;
 			target.y *= scale.y;
 			target.z *= scale.z;
-			diff[i] = geomData->vertices[i] - target;
 
 			if (mask) {
-				float maskFactor = 1.0f;
-				if (mask->find(i) != mask->end()) {
-					maskFactor = 1.0f - (*mask)[i];
-					diff[i] *= maskFactor;
-					target = geomData->vertices[i] - root + diff[i];
-				}
+				auto it = mask->find(i);
+				if (it != mask->end())
+					target = geomData->vertices[i] + (target - geomData->vertices[i]) * (1.0f - it->second);
 			}
 			geomData->vertices[i] = target;
 		}
@@ -3038,24 +3513,23 @@ void NifFile::ScaleShape(NiShape* shape, const Vector3& scale, std::unordered_ma
 		if (!bsTriShape)
 			return;
 
-		std::unordered_map<ushort, Vector3> diff;
+		SetBlockModified(bsTriShape);
+
 		for (int i = 0; i < bsTriShape->GetNumVertices(); i++) {
 			Vector3 target = bsTriShape->vertData[i].vert - root;
 			target.x *= scale.x;
 			target.y *= scale.y;
 			target.z *= scale.z;
-			diff[i] = bsTriShape->vertData[i].vert - target;
 
 			if (mask) {
-				float maskFactor = 1.0f;
-				if (mask->find(i) != mask->end()) {
-					maskFactor = 1.0f - (*mask)[i];
-					diff[i] *= maskFactor;
-					target = bsTriShape->vertData[i].vert - root + diff[i];
-				}
+				auto it = mask->find(i);
+				if (it != mask->end())
+					target = bsTriShape->vertData[i].vert + (target - bsTriShape->vertData[i].vert) * (1.0f - it->second);
 			}
 			bsTriShape->vertData[i].vert = target;
 		}
+
+		bsTriShape->InvalidateVertexStreams();
 	}
 }
 
@@ -3071,7 +3545,6 @@ void NifFile::RotateShape(NiShape* shape, const Vector3& angle, std::unordered_m
 		if (!geomData)
 			return;
 
-		std::unordered_map<ushort, Vector3> diff;
 		for (int i = 0; i < geomData->vertices.size(); i++) {
 			Vector3 target = geomData->vertices[i] - root;
 			Matrix4 mat;
@@ -3079,15 +3552,11 @@ void NifFile::RotateShape(NiShape* shape, const Vector3& angle, std::unordered_m
 			mat.Rotate(angle.y * DEG2RAD, Vector3(0.0f, 1.0f, 0.0f));
 			mat.Rotate(angle.z * DEG2RAD, Vector3(0.0f, 0.0f, 1.0f));
 			target = mat * target;
-			diff[i] = geomData->vertices[i] - target;
 
 			if (mask) {
-				float maskFactor = 1.0f;
-				if (mask->find(i) != mask->end()) {
-					maskFactor = 1.0f - (*mask)[i];
-					diff[i] *= maskFactor;
-					target = geomData->vertices[i] - root + diff[i];
-				}
+				auto it = mask->find(i);
+				if (it != mask->end())
+					target = geomData->vertices[i] + (target - geomData->vertices[i]) * (1.0f - it->second);
 			}
 			geomData->vertices[i] = target;
 		}
@@ -3097,7 +3566,8 @@ void NifFile::RotateShape(NiShape* shape, const Vector3& angle, std::unordered_m
 		if (!bsTriShape)
 			return;
 
-		std::unordered_map<ushort, Vector3> diff;
+		SetBlockModified(bsTriShape);
+
 		for (int i = 0; i < bsTriShape->GetNumVertices(); i++) {
 			Vector3 target = bsTriShape->vertData[i].vert - root;
 			Matrix4 mat;
@@ -3105,18 +3575,74 @@ void NifFile::RotateShape(NiShape* shape, const Vector3& angle, std::unordered_m
 			mat.Rotate(angle.y * DEG2RAD, Vector3(0.0f, 1.0f, 0.0f));
 			mat.Rotate(angle.z * DEG2RAD, Vector3(0.0f, 0.0f, 1.0f));
 			target = mat * target;
-			diff[i] = bsTriShape->vertData[i].vert - target;
 
 			if (mask) {
-				float maskFactor = 1.0f;
-				if (mask->find(i) != mask->end()) {
-					maskFactor = 1.0f - (*mask)[i];
-					diff[i] *= maskFactor;
-					target = bsTriShape->vertData[i].vert - root + diff[i];
-				}
+				auto it = mask->find(i);
+				if (it != mask->end())
+					target = bsTriShape->vertData[i].vert + (target - bsTriShape->vertData[i].vert) * (1.0f - it->second);
 			}
 			bsTriShape->vertData[i].vert = target;
 		}
+
+		bsTriShape->InvalidateVertexStreams();
+	}
+}
+
+void NifFile::OffsetShape(NiShape* shape, const Vector3& offset, const std::vector<float>& mask) {
+	if (!shape)
+		return;
+
+	auto verts = shape->edit_vertices();
+	size_t numMasked = std::min(verts.size(), mask.size());
+
+	for (size_t i = 0; i < numMasked; i++)
+		verts[i] += offset * (1.0f - mask[i]);
+
+	for (size_t i = numMasked; i < verts.size(); i++)
+		verts[i] += offset;
+}
+
+void NifFile::ScaleShape(NiShape* shape, const Vector3& scale, const std::vector<float>& mask) {
+	if (!shape)
+		return;
+
+	Vector3 root;
+	GetRootTranslation(root);
+
+	auto verts = shape->edit_vertices();
+	for (size_t i = 0; i < verts.size(); i++) {
+		Vector3 target = verts[i] - root;
+		target.x *= scale.x;
+		target.y *= scale.y;
+		target.z *= scale.z;
+
+		if (i < mask.size())
+			target = verts[i] + (target - verts[i]) * (1.0f - mask[i]);
+
+		verts[i] = target;
+	}
+}
+
+void NifFile::RotateShape(NiShape* shape, const Vector3& angle, const std::vector<float>& mask) {
+	if (!shape)
+		return;
+
+	Vector3 root;
+	GetRootTranslation(root);
+
+	Matrix4 mat;
+	mat.Rotate(angle.x * DEG2RAD, Vector3(1.0f, 0.0f, 0.0f));
+	mat.Rotate(angle.y * DEG2RAD, Vector3(0.0f, 1.0f, 0.0f));
+	mat.Rotate(angle.z * DEG2RAD, Vector3(0.0f, 0.0f, 1.0f));
+
+	auto verts = shape->edit_vertices();
+	for (size_t i = 0; i < verts.size(); i++) {
+		Vector3 target = mat * (verts[i] - root);
+
+		if (i < mask.size())
+			target = verts[i] + (target - verts[i]) * (1.0f - mask[i]);
+
+		verts[i] = target;
 	}
 }
 
@@ -3124,7 +3650,7 @@ NiAlphaProperty* NifFile::GetAlphaProperty(NiShape* shape) {
 	int alphaRef = shape->GetAlphaPropertyRef();
 	if (alphaRef == 0xFFFFFFFF) {
 		for (auto& prop : shape->GetProperties()) {
-			auto alphaProp = hdr.GetBlock<NiAlphaProperty>(prop.GetIndex());
+			auto alphaProp = hdr.LoadBlock<NiAlphaProperty>(prop.GetIndex());
 			if (alphaProp) {
 				alphaRef = prop.GetIndex();
 				break;
@@ -3132,7 +3658,7 @@ NiAlphaProperty* NifFile::GetAlphaProperty(NiShape* shape) {
 		}
 	}
 
-	return hdr.GetBlock<NiAlphaProperty>(alphaRef);
+	return hdr.LoadBlock<NiAlphaProperty>(alphaRef);
 }
 
 int NifFile::AssignAlphaProperty(NiShape* shape, NiAlphaProperty* alphaProp) {
@@ -3146,6 +3672,8 @@ int NifFile::AssignAlphaProperty(NiShape* shape, NiAlphaProperty* alphaProp) {
 		else
 			shape->SetAlphaPropertyRef(alphaRef);
 
+		hdr.BlockReferencesEdited(GetBlockID(shape));
+
 		return alphaRef;
 	}
 
@@ -3173,18 +3701,48 @@ void NifFile::DeleteShape(NiShape* shape) {
 	if (!shape)
 		return;
 
-	hdr.DeleteBlock(shape->GetDataRef());
-	DeleteShader(shape);
-	DeleteSkinning(shape);
+	std::set<int> deleteIds;
+	deleteIds.insert(shape->GetDataRef());
 
-	for (int i = shape->GetProperties().GetSize() - 1; i >= 0; --i)
-		hdr.DeleteBlock(shape->GetProperties().GetBlockRef(i));
+	auto shader = hdr.GetBlock<NiShader>(shape->GetShaderPropertyRef());
+	if (shader) {
+		deleteIds.insert(shader->GetTextureSetRef());
+		deleteIds.insert(shader->GetControllerRef());
+		deleteIds.insert(shape->GetShaderPropertyRef());
+	}
 
-	for (int i = shape->GetExtraData().GetSize() - 1; i >= 0; --i)
-		hdr.DeleteBlock(shape->GetExtraData().GetBlockRef(i));
+	if (hdr.GetBlock<NiAlphaProperty>(shape->GetAlphaPropertyRef()))
+		deleteIds.insert(shape->GetAlphaPropertyRef());
 
-	int shapeID = GetBlockID(shape);
-	hdr.DeleteBlock(shapeID);
+	for (auto &prop : shape->GetProperties()) {
+		auto propShader = hdr.GetBlock<NiShader>(prop.GetIndex());
+		if (propShader && propShader->HasType<BSShaderPPLightingProperty>()) {
+			deleteIds.insert(propShader->GetTextureSetRef());
+			deleteIds.insert(propShader->GetControllerRef());
+		}
+
+		deleteIds.insert(prop.GetIndex());
+	}
+
+	for (auto &extraData : shape->GetExtraData())
+		deleteIds.insert(extraData.GetIndex());
+
+	auto skinInst = hdr.GetBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
+	if (skinInst) {
+		deleteIds.insert(skinInst->GetDataRef());
+		deleteIds.insert(skinInst->GetSkinPartitionRef());
+		deleteIds.insert(shape->GetSkinInstanceRef());
+	}
+
+	auto bsSkinInst = hdr.GetBlock<BSSkinInstance>(shape->GetSkinInstanceRef());
+	if (bsSkinInst) {
+		deleteIds.insert(bsSkinInst->GetDataRef());
+		deleteIds.insert(shape->GetSkinInstanceRef());
+	}
+
+	deleteIds.insert(GetBlockID(shape));
+	deleteIds.erase(0xFFFFFFFF);
+	hdr.DeleteBlocks(deleteIds);
 }
 
 void NifFile::DeleteShader(NiShape* shape) {
@@ -3231,10 +3789,13 @@ void NifFile::DeleteSkinning(NiShape* shape) {
 	}
 
 	shape->SetSkinned(false);
+	SetBlockModified(shape);
 
 	NiShader* shader = GetShader(shape);
-	if (shader)
+	if (shader) {
 		shader->SetSkinned(false);
+		SetBlockModified(shader);
+	}
 }
 
 void NifFile::RemoveEmptyPartitions(NiShape* shape) {
@@ -3279,6 +3840,7 @@ bool NifFile::DeleteVertsForShape(NiShape* shape, const std::vector<ushort>& ind
 
 	auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
 	if (bsTriShape) {
+		SetBlockModified(bsTriShape);
 		bsTriShape->notifyVerticesDelete(indices);
 		if (bsTriShape->GetNumVertices() == 0 || bsTriShape->GetNumTriangles() == 0) {
 			// Deleted all verts or tris
@@ -3338,7 +3900,7 @@ bool NifFile::DeleteVertsForShape(NiShape* shape, const std::vector<ushort>& ind
 int NifFile::CalcShapeDiff(NiShape* shape, const std::vector<Vector3>* targetData, std::unordered_map<ushort, Vector3>& outDiffData, float scale) {
 	outDiffData.clear();
 
-	const std::vector<Vector3>* myData = GetRawVertsForShape(shape);
+	const BlockVector<Vector3>* myData = GetRawVertsForShape(shape);
 	if (!myData)
 		return 1;
 
@@ -3369,7 +3931,7 @@ int NifFile::CalcShapeDiff(NiShape* shape, const std::vector<Vector3>* targetDat
 int NifFile::CalcUVDiff(NiShape* shape, const std::vector<Vector2>* targetData, std::unordered_map<ushort, Vector3>& outDiffData, float scale) {
 	outDiffData.clear();
 
-	const std::vector<Vector2>* myData = GetUvsForShape(shape);
+	const BlockVector<Vector2>* myData = GetUvsForShape(shape);
 	if (!myData)
 		return 1;
 
@@ -3420,26 +3982,42 @@ void NifFile::UpdateSkinPartitions(NiShape* shape) {
 	for (auto &t : tris)
 		t.rot();
 
-	// Make maps of vertices to bones and weights
-	std::unordered_map<ushort, std::vector<SkinWeight>> vertBoneWeights;
+	// Flat lists of bones and weights per vertex, vertex v owns [vertWeightOffsets[v], vertWeightOffsets[v + 1])
+	size_t numVertSlots = shape->GetNumVertices();
+	for (auto &bone : skinData->bones)
+		for (auto &bw : bone.vertexWeights)
+			numVertSlots = std::max<size_t>(numVertSlots, bw.index + 1);
+
+	std::vector<uint> vertWeightOffsets(numVertSlots + 1, 0);
+	for (auto &bone : skinData->bones)
+		for (auto &bw : bone.vertexWeights)
+			vertWeightOffsets[bw.index + 1]++;
+
+	for (size_t v = 0; v < numVertSlots; v++)
+		vertWeightOffsets[v + 1] += vertWeightOffsets[v];
+
+	std::vector<SkinWeight> vertWeights(vertWeightOffsets[numVertSlots]);
+	std::vector<uint> vertWeightFill(vertWeightOffsets.begin(), vertWeightOffsets.end() - 1);
+
 	int boneIndex = 0;
 	for (auto &bone : skinData->bones) {
 		for (auto &bw : bone.vertexWeights)
-			vertBoneWeights[bw.index].push_back(SkinWeight(boneIndex, bw.weight));
+			vertWeights[vertWeightFill[bw.index]++] = SkinWeight(boneIndex, bw.weight);
 
 		boneIndex++;
 	}
 
-	// Sort weights and corresponding bones
-	for (auto &bw : vertBoneWeights)
-		sort(bw.second.begin(), bw.second.end(), BoneWeightsSort());
-
-	// Enforce maximum vertex bone weight count
+	// Sort weights and corresponding bones, then enforce maximum vertex bone weight count
 	int maxBonesPerVertex = 4;
 
-	for (auto &bw : vertBoneWeights)
-		if (bw.second.size() > maxBonesPerVertex)
-			bw.second.resize(maxBonesPerVertex);
+	std::vector<byte> vertWeightCounts(numVertSlots);
+	for (size_t v = 0; v < numVertSlots; v++) {
+		auto first = vertWeights.begin() + vertWeightOffsets[v];
+		auto last = vertWeights.begin() + vertWeightOffsets[v + 1];
+		sort(first, last, BoneWeightsSort());
+
+		vertWeightCounts[v] = std::min<uint>(last - first, maxBonesPerVertex);
+	}
 
 	skinPart->PrepareTriParts(tris);
 	std::vector<int> &triParts = skinPart->triParts;
@@ -3450,9 +4028,31 @@ void NifFile::UpdateSkinPartitions(NiShape* shape) {
 	else if (hdr.GetVersion().IsSSE())
 		maxBonesPerPartition = 80;
 
+	// Bone sets of partitions are bitsets over all bones of the skin
+	const size_t boneWords = (skinData->bones.size() + 63) / 64;
+	auto hasBone = [&](const std::vector<uint64_t> &bits, const size_t set, const int bone) {
+		return (bits[set * boneWords + bone / 64] >> (bone % 64)) & 1;
+	};
+
 	// Make a list of the bones used by each partition.  If any partition
-	// has too many bones, split it.
-	std::vector<std::set<int>> partBones(skinPart->partitions.size());
+	// has too many bones, split it.  A split always starts a new partition
+	// behind the last one split off the same original partition, so every
+	// triangle only needs to remember which of those it went to.
+	const size_t numOrigParts = skinPart->partitions.size();
+	std::vector<std::vector<int>> splitParts(numOrigParts);
+	std::vector<uint64_t> splitBones;
+	std::vector<int> splitBoneCounts;
+
+	auto addSplitPart = [&](const size_t origPart) {
+		splitParts[origPart].push_back(splitBoneCounts.size());
+		splitBoneCounts.push_back(0);
+		splitBones.resize(splitBones.size() + boneWords, 0);
+	};
+
+	for (size_t p = 0; p < numOrigParts; p++)
+		addSplitPart(p);
+
+	std::vector<int> triSplits(tris.size(), 0);
 	for (int triIndex = 0; triIndex < tris.size(); ++triIndex) {
 		int partInd = triParts[triIndex];
 		if (partInd < 0)
@@ -3461,45 +4061,79 @@ void NifFile::UpdateSkinPartitions(NiShape* shape) {
 		Triangle tri = tris[triIndex];
 
 		// Get associated bones for the current tri
-		std::set<int> triBones;
-		for (int i = 0; i < 3; i++)
-			for (auto &tb : vertBoneWeights[tri[i]])
-				triBones.insert(tb.index);
+		int triBones[12];
+		int numTriBones = 0;
+		for (int i = 0; i < 3; i++) {
+			ushort v = tri[i];
+			if (v >= numVertSlots)
+				continue;
+
+			for (uint w = vertWeightOffsets[v]; w < vertWeightOffsets[v] + vertWeightCounts[v]; w++) {
+				int bone = vertWeights[w].index;
+				if (std::find(triBones, triBones + numTriBones, bone) == triBones + numTriBones)
+					triBones[numTriBones++] = bone;
+			}
+		}
 
 		// How many new bones are in the tri's bone list?
+		int set = splitParts[partInd].back();
 		int newBoneCount = 0;
-		for (auto &tb : triBones)
-			if (partBones[partInd].find(tb) == partBones[partInd].end())
+		for (int i = 0; i < numTriBones; i++)
+			if (!hasBone(splitBones, set, triBones[i]))
 				newBoneCount++;
 
-		if (partBones[partInd].size() + newBoneCount > maxBonesPerPartition) {
+		if (splitBoneCounts[set] + newBoneCount > maxBonesPerPartition) {
 			// Too many bones for this partition, make a new partition starting with this triangle
-			for (int j = 0; j < tris.size(); ++j)
-				if (triParts[j] > partInd || (j >= triIndex && triParts[j] >= partInd))
-					++triParts[j];
+			addSplitPart(partInd);
+			set = splitParts[partInd].back();
+		}
+
+		triSplits[triIndex] = splitParts[partInd].size() - 1;
+
+		for (int i = 0; i < numTriBones; i++) {
+			if (!hasBone(splitBones, set, triBones[i])) {
+				splitBones[set * boneWords + triBones[i] / 64] |= uint64_t(1) << (triBones[i] % 64);
+				splitBoneCounts[set]++;
+			}
+		}
+	}
+
+	// Final partition order keeps the split partitions right behind their original
+	std::vector<int> partBase(numOrigParts, 0);
+	std::vector<int> partSets;
+	for (size_t p = 0; p < numOrigParts; p++) {
+		partBase[p] = partSets.size();
+		partSets.insert(partSets.end(), splitParts[p].begin(), splitParts[p].end());
+	}
 
-			partBones.insert(partBones.begin() + partInd + 1, std::set<int>());
+	if (partSets.size() != numOrigParts) {
+		for (size_t triIndex = 0; triIndex < tris.size(); ++triIndex)
+			if (triParts[triIndex] >= 0)
+				triParts[triIndex] = partBase[triParts[triIndex]] + triSplits[triIndex];
 
-			if (bsdSkinInst) {
-				auto partInfo = bsdSkinInst->GetPartitions();
+		if (bsdSkinInst) {
+			auto partInfo = bsdSkinInst->GetPartitions();
 
-				BSDismemberSkinInstance::PartitionInfo info;
-				info.flags = PF_EDITOR_VISIBLE;
-				info.partID = partInfo[partInd].partID;
-				partInfo.insert(partInfo.begin() + partInd + 1, info);
+			std::vector<BSDismemberSkinInstance::PartitionInfo> splitInfo;
+			splitInfo.reserve(partSets.size());
+			for (size_t p = 0; p < partInfo.size(); p++) {
+				splitInfo.push_back(partInfo[p]);
 
-				bsdSkinInst->SetPartitions(partInfo);
+				for (size_t s = 1; p < numOrigParts && s < splitParts[p].size(); s++) {
+					BSDismemberSkinInstance::PartitionInfo info;
+					info.flags = PF_EDITOR_VISIBLE;
+					info.partID = partInfo[p].partID;
+					splitInfo.push_back(info);
+				}
 			}
 
-			++partInd;
+			bsdSkinInst->SetPartitions(splitInfo);
 		}
-
-		partBones[partInd].insert(triBones.begin(), triBones.end());
 	}
 
 	// Re-create partitions
-	std::vector<NiSkinPartition::PartitionBlock> partitions(partBones.size());
-	for (int partInd = 0; partInd < partBones.size(); partInd++) {
+	BlockVector<NiSkinPartition::PartitionBlock> partitions(partSets.size(), skinPart->partitions.get_allocator());
+	for (size_t partInd = 0; partInd < partSets.size(); partInd++) {
 		NiSkinPartition::PartitionBlock &part = partitions[partInd];
 		part.hasBoneIndices = true;
 		part.hasFaces = true;
@@ -3514,23 +4148,32 @@ void NifFile::UpdateSkinPartitions(NiShape* shape) {
 	skinPart->GenerateTrueTrianglesFromTriParts(tris);
 	skinPart->PrepareVertexMapsAndTriangles();
 
+	std::vector<int> boneLookup(skinData->bones.size(), 0);
 	for (int partInd = 0; partInd < skinPart->numPartitions; ++partInd) {
 		NiSkinPartition::PartitionBlock &part = skinPart->partitions[partInd];
+		int set = partSets[partInd];
 
 		// Copy relevant data from shape to partition
 		if (bsTriShape)
 			part.vertexDesc = bsTriShape->vertexDesc;
 
-		std::unordered_map<int, int> boneLookup;
-		boneLookup.reserve(partBones[partInd].size());
-		part.numBones = partBones[partInd].size();
+		part.numBones = splitBoneCounts[set];
 		part.bones.reserve(part.numBones);
 
-		for (auto &b : partBones[partInd]) {
-			part.bones.push_back(b);
-			boneLookup[b] = part.bones.size() - 1;
+		for (size_t word = 0; word < boneWords; word++) {
+			uint64_t bits = splitBones[set * boneWords + word];
+			for (int bit = 0; bits; bit++, bits >>= 1) {
+				if (bits & 1) {
+					int b = word * 64 + bit;
+					part.bones.push_back(b);
+					boneLookup[b] = part.bones.size() - 1;
+				}
+			}
 		}
 
+		part.boneIndices.reserve(part.vertexMap.size());
+		part.vertexWeights.reserve(part.vertexMap.size());
+
 		for (auto &v : part.vertexMap) {
 			BoneIndices b;
 			VertexWeight vw;
@@ -3539,13 +4182,13 @@ void NifFile::UpdateSkinPartitions(NiShape* shape) {
 			float* pw = &vw.w1;
 
 			float tot = 0.0f;
-			for (int bi = 0; bi < vertBoneWeights[v].size(); bi++) {
-				if (bi == 4)
-					break;
-
-				pb[bi] = boneLookup[vertBoneWeights[v][bi].index];
-				pw[bi] = vertBoneWeights[v][bi].weight;
-				tot += pw[bi];
+			if (v < numVertSlots) {
+				for (int bi = 0; bi < vertWeightCounts[v]; bi++) {
+					auto &sw = vertWeights[vertWeightOffsets[v] + bi];
+					pb[bi] = boneLookup[sw.index];
+					pw[bi] = sw.weight;
+					tot += pw[bi];
+				}
 			}
 
 			if (tot != 0.0f)
@@ -3555,6 +4198,9 @@ void NifFile::UpdateSkinPartitions(NiShape* shape) {
 			part.boneIndices.push_back(b);
 			part.vertexWeights.push_back(vw);
 		}
+
+		for (auto &b : part.bones)
+			boneLookup[b] = 0;
 	}
 
 	if (bsTriShape) {
@@ -3684,9 +4330,15 @@ void NifFile::CreateSkinning(NiShape* shape) {
 		}
 	}
 
+	// The skin instance and the shape were given their refs after being added
+	hdr.BlockReferencesEdited(shape->GetSkinInstanceRef());
+	hdr.BlockReferencesEdited(GetBlockID(shape));
+
 	NiShader* shader = GetShader(shape);
-	if (shader)
+	if (shader) {
 		shader->SetSkinned(true);
+		SetBlockModified(shader);
+	}
 }
 
 void NifFile::SetShapeDynamic(const std::string& shapeName) {
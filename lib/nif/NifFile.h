@@ -36,21 +36,59 @@ struct BoneWeightsSort {
 
 struct NifLoadOptions {
 	bool isTerrain = false;
+	// Map the file into memory and parse blocks straight from the mapping
+	bool memoryMap = false;
+	// Normalize texture paths after loading, can be skipped when only geometry is read
+	bool trimTexturePaths = true;
+	// Build the incoming reference index after loading, for files that get their node graph edited a lot
+	bool referenceIndex = false;
+	// Keep blocks as bytes until they're first accessed through the header,
+	// blocks that are never accessed are saved unchanged. A block that fails to decode
+	// stays a NiLazyBlock, so lookups of its type don't find it.
+	bool lazyBlocks = false;
+	// Keep the bytes of all blocks, so NifSaveOptions::passThrough can write blocks that weren't
+	// accessed since loading without encoding them. Always the case with lazyBlocks.
+	bool keepBlockBytes = false;
+	// Decode blocks on this many threads, 0 uses one per core. Not used with lazyBlocks.
+	uint loadThreads = 1;
+	// Allocate the blocks and their vertex, triangle and skin arrays from arenas owned by the file,
+	// which Clear releases at once. Arrays that grow by later edits take more memory from the arena,
+	// so blocks of such a file shouldn't be edited from several threads at once.
+	bool blockArena = false;
+
+	// Block types to parse, all others are kept as NiUnknown. Empty parses every type.
+	// A trailing '*' matches by prefix, e.g. "bhk*".
+	std::set<std::string> includeBlockTypes;
+	// Block types that are kept as NiUnknown instead of being parsed
+	std::set<std::string> excludeBlockTypes;
+
+	bool ParsesBlockType(const std::string& blockType) const;
 };
 
 struct NifSaveOptions {
 	bool optimize = true;
 	bool sortBlocks = true;
+	// Write blocks that weren't accessed since loading as their original bytes and keep the block order.
+	// Only modified blocks are finalized and encoded, optimizing just updates the bounds of modified shapes.
+	bool passThrough = false;
+	// Encode blocks on this many threads, 0 uses one per core
+	uint saveThreads = 1;
 };
 
 class NifFile {
 private:
+	// One per decoding thread, declared before the blocks which have to be destroyed first
+	std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> blockArenas;
+
 	NiHeader hdr;
 	std::vector<std::shared_ptr<NiObject>> blocks;
 	bool isValid = false;
 	bool hasUnknown = false;
 	bool isTerrain = false;
 
+	int LoadStream(NiStream& stream, const NifLoadOptions& options);
+	void GetTree(std::vector<NiObject*>& result, NiObject* parent, std::unordered_set<NiObject*>& added);
+
 public:
 	NifFile() {}
 
@@ -76,14 +114,16 @@ public:
 
 	int Load(const std::string& fileName, const NifLoadOptions& options = NifLoadOptions());
 	int Load(std::iostream &file, const NifLoadOptions& options = NifLoadOptions());
+	// Parse from a contiguous buffer, the data only has to stay alive for the duration of the call
+	int Load(const char* data, const size_t size, const NifLoadOptions& options = NifLoadOptions());
 	int Save(const std::string& fileName, const NifSaveOptions& options = NifSaveOptions());
 	int Save(std::iostream& file, const NifSaveOptions& options = NifSaveOptions());
 
 	void Optimize();
 	OptResult OptimizeFor(OptOptions& options);
 
-	void PrepareData();
-	void FinalizeData();
+	void PrepareData(const bool trimTexturePaths = true);
+	void FinalizeData(const bool modifiedOnly = false);
 
 	bool IsValid() { return isValid; }
 	bool HasUnknown() { return hasUnknown; }
@@ -100,6 +140,7 @@ public:
 
 	NiNode* AddNode(const std::string& nodeName, const MatTransform& xformToParent, NiNode* parent = nullptr);
 	void DeleteNode(const std::string& nodeName);
+	// True if the node has no children and no references besides its parent
 	bool CanDeleteNode(NiNode* node);
 	bool CanDeleteNode(const std::string& nodeName);
 	std::string GetNodeName(const int blockID);
@@ -130,6 +171,8 @@ public:
 	template<class T = NiObject>
 	T* FindBlockByName(const std::string& name);
 	int GetBlockID(NiObject* block);
+	// Marks a block that was edited directly, so saving with passThrough encodes it again
+	void SetBlockModified(NiObject* block);
 	NiNode* GetParentNode(NiObject* block);
 	void SetParentNode(NiObject *block, NiNode *parent);
 	std::vector<NiNode*> GetNodes();
@@ -181,6 +224,10 @@ public:
 	int GetShapeBoneIDList(NiShape* shape, std::vector<int>& outList);
 	void SetShapeBoneIDList(NiShape* shape, std::vector<int>& inList);
 	int GetShapeBoneWeights(NiShape* shape, const int boneIndex, std::unordered_map<ushort, float>& outWeights);
+	// Weights of all bones in one pass, returns the number of bones
+	int GetShapeBoneWeights(NiShape* shape, BoneWeightColumns& outWeights);
+	// Four strongest weights of every vertex, returns the number of vertices
+	int GetShapeVertexWeights(NiShape* shape, VertexWeightRows& outWeights);
 
 	// Looks up the shape's global-to-skin transform if it has it.
 	// Otherwise, try to calculate it using skin-to-bone and node-to-global
@@ -212,6 +259,10 @@ public:
 	bool GetShapeBoneBounds(NiShape* shape, const int boneIndex, BoundingSphere& outBounds);
 	void UpdateShapeBoneID(const std::string& shapeName, const int oldID, const int newID);
 	void SetShapeBoneWeights(const std::string& shapeName, const int boneIndex, std::unordered_map<ushort, float>& inWeights);
+	// Replaces the weights of every bone that has a column
+	void SetShapeBoneWeights(NiShape* shape, const BoneWeightColumns& inWeights);
+	// Writes the vertex weights of a BSTriShape or the bone weights of NiSkinData
+	void SetShapeVertexWeights(NiShape* shape, const VertexWeightRows& inWeights);
 	void SetShapeVertWeights(const std::string& shapeName, const int vertIndex, std::vector<byte>& boneids, std::vector<float>& weights);
 	void ClearShapeVertWeights(const std::string& shapeName);
 
@@ -224,14 +275,15 @@ public:
 	// DeletePartitions: partInds must be in sorted ascending order.
 	void DeletePartitions(NiShape* shape, std::vector<int> &partInds);
 
-	const std::vector<Vector3>* GetRawVertsForShape(NiShape* shape);
+	const BlockVector<Vector3>* GetRawVertsForShape(NiShape* shape);
 	bool ReorderTriangles(NiShape* shape, const std::vector<uint>& triangleIndices);
-	const std::vector<Vector3>* GetNormalsForShape(NiShape* shape, bool transform = true);
-	const std::vector<Vector2>* GetUvsForShape(NiShape* shape);
-	const std::vector<Color4>* GetColorsForShape(const std::string& shapeName);
-	const std::vector<Vector3>* GetTangentsForShape(NiShape* shape, bool transform = true);
-	const std::vector<Vector3>* GetBitangentsForShape(NiShape* shape, bool transform = true);
-	std::vector<float>* GetEyeDataForShape(NiShape* shape);
+	const BlockVector<Vector3>* GetNormalsForShape(NiShape* shape, bool transform = true);
+	const BlockVector<Vector2>* GetUvsForShape(NiShape* shape);
+	const BlockVector<Color4>* GetColorsForShape(const std::string& shapeName);
+	const BlockVector<Vector3>* GetTangentsForShape(NiShape* shape, bool transform = true);
+	const BlockVector<Vector3>* GetBitangentsForShape(NiShape* shape, bool transform = true);
+	// The data can be edited, so the shape counts as modified
+	BlockVector<float>* GetEyeDataForShape(NiShape* shape);
 	bool GetUvsForShape(NiShape* shape, std::vector<Vector2>& outUvs);
 	bool GetVertsForShape(NiShape* shape, std::vector<Vector3>& outVerts);
 	void SetVertsForShape(NiShape* shape, const std::vector<Vector3>& verts);
@@ -254,6 +306,10 @@ public:
 	void OffsetShape(NiShape* shape, const Vector3& offset, std::unordered_map<ushort, float>* mask = nullptr);
 	void ScaleShape(NiShape* shape, const Vector3& scale, std::unordered_map<ushort, float>* mask = nullptr);
 	void RotateShape(NiShape* shape, const Vector3& angle, std::unordered_map<ushort, float>* mask = nullptr);
+	// Dense masks hold one value per vertex, a vertex moves by (1 - mask) of the full transform
+	void OffsetShape(NiShape* shape, const Vector3& offset, const std::vector<float>& mask);
+	void ScaleShape(NiShape* shape, const Vector3& scale, const std::vector<float>& mask);
+	void RotateShape(NiShape* shape, const Vector3& angle, const std::vector<float>& mask);
 
 	NiAlphaProperty* GetAlphaProperty(NiShape* shape);
 	int AssignAlphaProperty(NiShape* shape, NiAlphaProperty* alphaProp); // ushort flags = 4844, ushort threshold = 128
@@ -289,14 +345,14 @@ std::vector<T*> NifFile::GetChildren(NiNode* parent, bool searchExtraData) {
 	}
 
 	for (auto& child : parent->GetChildren()) {
-		n = hdr.GetBlock<T>(child.GetIndex());
+		n = hdr.LoadBlock<T>(child.GetIndex());
 		if (n)
 			result.push_back(n);
 	}
 
 	if (searchExtraData) {
 		for (auto& extraData : parent->GetExtraData()) {
-			n = hdr.GetBlock<T>(extraData.GetIndex());
+			n = hdr.LoadBlock<T>(extraData.GetIndex());
 			if (n)
 				result.push_back(n);
 		}
@@ -7,11 +7,14 @@ See the included LICENSE file
 
 #include "utils/Object3d.h"
 
+#include <cctype>
+#include <string>
+
 // ApplyMapToTriangles applies a vertex index renumbering map to p1, p2,
 // and p3 of a vector of Triangles "tris".  If a triangle has an index out
 // of range of the map or if an index maps to a negative number, the
 // triangle is removed.
-template<typename IndexType1, typename IndexType2 = int> void ApplyMapToTriangles(std::vector<Triangle> &tris, const std::vector<IndexType1> &map, std::vector<IndexType2> *deletedTris = nullptr) {
+template<typename IndexType1, typename IndexType2 = int, typename TriAlloc, typename MapAlloc> void ApplyMapToTriangles(std::vector<Triangle, TriAlloc> &tris, const std::vector<IndexType1, MapAlloc> &map, std::vector<IndexType2> *deletedTris = nullptr) {
 	const int mapsz = map.size();
 	int di = 0;
 	for (int si = 0; si < tris.size(); ++si) {
@@ -32,7 +35,7 @@ template<typename IndexType1, typename IndexType2 = int> void ApplyMapToTriangle
 	tris.resize(di);
 }
 
-inline ushort CalcMaxTriangleIndex(const std::vector<Triangle> &v) {
+template<typename TriAlloc> ushort CalcMaxTriangleIndex(const std::vector<Triangle, TriAlloc> &v) {
 	ushort maxind = 0;
 	for (unsigned int i = 0; i < v.size(); ++i) {
 		maxind = std::max(maxind, v[i].p1);
@@ -139,3 +142,49 @@ template<typename IndexType> std::vector<Triangle> GenerateTrianglesFromStrips(c
 	}
 	return tris;
 }
+
+// NormalizeTexturePath rewrites a texture path in place: runs of forward
+// slashes or backslashes become one backslash, everything before the first
+// "\textures\" is dropped and a missing "textures\" prefix is added.  For
+// terrain a missing "Data\" prefix is added as well.  Prefix tests ignore case.
+inline void NormalizeTexturePath(std::string& tex, const bool isTerrain) {
+	if (tex.empty())
+		return;
+
+	auto hasPrefix = [&tex](const size_t pos, const char* prefix) {
+		for (size_t i = 0; prefix[i]; ++i)
+			if (pos + i >= tex.size() || std::tolower((unsigned char)tex[pos + i]) != prefix[i])
+				return false;
+		return true;
+	};
+
+	size_t di = 0;
+	for (size_t si = 0; si < tex.size();) {
+		const char c = tex[si];
+		if (c == '/' || c == '\\') {
+			while (si < tex.size() && tex[si] == c)
+				++si;
+			tex[di++] = '\\';
+		}
+		else
+			tex[di++] = tex[si++];
+	}
+	tex.resize(di);
+
+	// The part before "\textures\" can't span a line break
+	for (size_t i = 0; i < tex.size() && tex[i] != '\n' && tex[i] != '\r'; ++i) {
+		if (hasPrefix(i, "\\textures\\")) {
+			tex.erase(0, i + 10);
+			break;
+		}
+	}
+
+	size_t start = tex.find_first_not_of('\\');
+	tex.erase(0, start == std::string::npos ? tex.size() : start);
+
+	if (!hasPrefix(0, "textures\\"))
+		tex.insert(0, "textures\\");
+
+	if (isTerrain && !hasPrefix(0, "data\\"))
+		tex.insert(0, "Data\\");
+}
@@ -23,8 +23,8 @@ void NiNode::Put(NiStream& stream) {
 		effectRefs.Put(stream);
 }
 
-void NiNode::GetChildRefs(std::set<Ref*>& refs) {
-	NiAVObject::GetChildRefs(refs);
+void NiNode::VisitChildRefs(RefSink<Ref>& refs) {
+	NiAVObject::VisitChildRefs(refs);
 
 	childRefs.GetIndexPtrs(refs);
 	effectRefs.GetIndexPtrs(refs);
@@ -75,8 +75,8 @@ void BSTreeNode::Put(NiStream& stream) {
 	bones2.Put(stream);
 }
 
-void BSTreeNode::GetChildRefs(std::set<Ref*>& refs) {
-	NiNode::GetChildRefs(refs);
+void BSTreeNode::VisitChildRefs(RefSink<Ref>& refs) {
+	NiNode::VisitChildRefs(refs);
 
 	bones1.GetIndexPtrs(refs);
 	bones2.GetIndexPtrs(refs);
@@ -172,8 +172,8 @@ void BSMultiBound::Put(NiStream& stream) {
 	dataRef.Put(stream);
 }
 
-void BSMultiBound::GetChildRefs(std::set<Ref*>& refs) {
-	NiObject::GetChildRefs(refs);
+void BSMultiBound::VisitChildRefs(RefSink<Ref>& refs) {
+	NiObject::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -211,8 +211,8 @@ void BSMultiBoundNode::Put(NiStream& stream) {
 		stream << cullingMode;
 }
 
-void BSMultiBoundNode::GetChildRefs(std::set<Ref*>& refs) {
-	NiNode::GetChildRefs(refs);
+void BSMultiBoundNode::VisitChildRefs(RefSink<Ref>& refs) {
+	NiNode::VisitChildRefs(refs);
 
 	refs.insert(&multiBoundRef);
 }
@@ -314,8 +314,7 @@ void NiScreenLODData::Get(NiStream& stream) {
 	stream >> numProportions;
 
 	proportionLevels.resize(numProportions);
-	for (int i = 0; i < numProportions; i++)
-		stream >> proportionLevels[i];
+	stream.readArray(proportionLevels.data(), numProportions);
 }
 
 void NiScreenLODData::Put(NiStream& stream) {
@@ -327,8 +326,7 @@ void NiScreenLODData::Put(NiStream& stream) {
 	stream << worldRadius;
 	stream << numProportions;
 
-	for (int i = 0; i < numProportions; i++)
-		stream << proportionLevels[i];
+	stream.writeArray(proportionLevels.data(), numProportions);
 }
 
 
@@ -344,8 +342,8 @@ void NiLODNode::Put(NiStream& stream) {
 	lodLevelData.Put(stream);
 }
 
-void NiLODNode::GetChildRefs(std::set<Ref*>& refs) {
-	NiSwitchNode::GetChildRefs(refs);
+void NiLODNode::VisitChildRefs(RefSink<Ref>& refs) {
+	NiSwitchNode::VisitChildRefs(refs);
 
 	refs.insert(&lodLevelData);
 }
@@ -20,7 +20,7 @@ public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
 
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiNode* Clone() { return new NiNode(*this); }
 
@@ -75,7 +75,7 @@ public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
 
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	BSTreeNode* Clone() { return new BSTreeNode(*this); }
 
@@ -154,7 +154,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	BSMultiBound* Clone() { return new BSMultiBound(*this); }
 
@@ -182,7 +182,7 @@ public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
 
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	BSMultiBoundNode* Clone() { return new BSMultiBoundNode(*this); }
 
@@ -328,7 +328,7 @@ public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
 
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiLODNode* Clone() { return new NiLODNode(*this); }
 
@@ -29,14 +29,14 @@ void NiObjectNET::Put(NiStream& stream) {
 	controllerRef.Put(stream);
 }
 
-void NiObjectNET::GetStringRefs(std::set<StringRef*>& refs) {
-	NiObject::GetStringRefs(refs);
+void NiObjectNET::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiObject::VisitStringRefs(refs);
 
 	refs.insert(&name);
 }
 
-void NiObjectNET::GetChildRefs(std::set<Ref*>& refs) {
-	NiObject::GetChildRefs(refs);
+void NiObjectNET::VisitChildRefs(RefSink<Ref>& refs) {
+	NiObject::VisitChildRefs(refs);
 
 	extraDataRefs.GetIndexPtrs(refs);
 	refs.insert(&controllerRef);
@@ -113,8 +113,8 @@ void NiAVObject::Put(NiStream& stream) {
 		collisionRef.Put(stream);
 }
 
-void NiAVObject::GetChildRefs(std::set<Ref*>& refs) {
-	NiObjectNET::GetChildRefs(refs);
+void NiAVObject::VisitChildRefs(RefSink<Ref>& refs) {
+	NiObjectNET::VisitChildRefs(refs);
 
 	propertyRefs.GetIndexPtrs(refs);
 	refs.insert(&collisionRef);
@@ -157,8 +157,8 @@ void NiDefaultAVObjectPalette::Put(NiStream& stream) {
 	}
 }
 
-void NiDefaultAVObjectPalette::GetPtrs(std::set<Ref*>& ptrs) {
-	NiAVObjectPalette::GetPtrs(ptrs);
+void NiDefaultAVObjectPalette::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiAVObjectPalette::VisitPtrs(ptrs);
 
 	ptrs.insert(&sceneRef);
 
@@ -211,8 +211,8 @@ void NiCamera::Put(NiStream& stream) {
 	stream << numScreenTextures;
 }
 
-void NiCamera::GetChildRefs(std::set<Ref*>& refs) {
-	NiAVObject::GetChildRefs(refs);
+void NiCamera::VisitChildRefs(RefSink<Ref>& refs) {
+	NiAVObject::VisitChildRefs(refs);
 
 	refs.insert(&sceneRef);
 }
@@ -238,8 +238,7 @@ void NiPalette::Get(NiStream& stream) {
 	stream >> hasAlpha;
 	stream >> numEntries;
 	palette.resize(numEntries);
-	for (int i = 0; i < numEntries; i++)
-		stream >> palette[i];
+	stream.readArray(palette.data(), numEntries);
 }
 
 void NiPalette::Put(NiStream& stream) {
@@ -257,8 +256,7 @@ void NiPalette::Put(NiStream& stream) {
 
 	stream << hasAlpha;
 	stream << numEntries;
-	for (int i = 0; i < numEntries; i++)
-		stream << palette[i];
+	stream.writeArray(palette.data(), numEntries);
 }
 
 
@@ -284,8 +282,7 @@ void TextureRenderData::Get(NiStream& stream) {
 	stream >> numMipmaps;
 	stream >> bytesPerPixel;
 	mipmaps.resize(numMipmaps);
-	for (int i = 0; i < numMipmaps; i++)
-		stream >> mipmaps[i];
+	stream.readArray(mipmaps.data(), numMipmaps);
 }
 
 void TextureRenderData::Put(NiStream& stream) {
@@ -309,12 +306,11 @@ void TextureRenderData::Put(NiStream& stream) {
 
 	stream << numMipmaps;
 	stream << bytesPerPixel;
-	for (int i = 0; i < numMipmaps; i++)
-		stream << mipmaps[i];
+	stream.writeArray(mipmaps.data(), numMipmaps);
 }
 
-void TextureRenderData::GetChildRefs(std::set<Ref*>& refs) {
-	NiObject::GetChildRefs(refs);
+void TextureRenderData::VisitChildRefs(RefSink<Ref>& refs) {
+	NiObject::VisitChildRefs(refs);
 
 	refs.insert(&paletteRef);
 }
@@ -345,8 +341,7 @@ void NiPersistentSrcTextureRendererData::Get(NiStream& stream) {
 	pixelData.resize(numFaces);
 	for (int f = 0; f < numFaces; f++) {
 		pixelData[f].resize(numPixels);
-		for (int p = 0; p < numPixels; p++)
-			stream >> pixelData[f][p];
+		stream.readArray(pixelData[f].data(), numPixels);
 	}
 }
 
@@ -359,8 +354,7 @@ void NiPersistentSrcTextureRendererData::Put(NiStream& stream) {
 	stream >> unkInt5;
 
 	for (int f = 0; f < numFaces; f++)
-		for (int p = 0; p < numPixels; p++)
-			stream >> pixelData[f][p];
+		stream.readArray(pixelData[f].data(), numPixels);
 }
 
 
@@ -373,8 +367,7 @@ void NiPixelData::Get(NiStream& stream) {
 	pixelData.resize(numFaces);
 	for (int f = 0; f < numFaces; f++) {
 		pixelData[f].resize(numPixels);
-		for (int p = 0; p < numPixels; p++)
-			stream >> pixelData[f][p];
+		stream.readArray(pixelData[f].data(), numPixels);
 	}
 }
 
@@ -385,8 +378,7 @@ void NiPixelData::Put(NiStream& stream) {
 	stream >> numFaces;
 
 	for (int f = 0; f < numFaces; f++)
-		for (int p = 0; p < numPixels; p++)
-			stream >> pixelData[f][p];
+		stream.readArray(pixelData[f].data(), numPixels);
 }
 
 
@@ -424,14 +416,14 @@ void NiSourceTexture::Put(NiStream& stream) {
 		stream << persistentRenderData;
 }
 
-void NiSourceTexture::GetStringRefs(std::set<StringRef*>& refs) {
-	NiTexture::GetStringRefs(refs);
+void NiSourceTexture::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiTexture::VisitStringRefs(refs);
 
 	refs.insert(&fileName);
 }
 
-void NiSourceTexture::GetChildRefs(std::set<Ref*>& refs) {
-	NiTexture::GetChildRefs(refs);
+void NiSourceTexture::VisitChildRefs(RefSink<Ref>& refs) {
+	NiTexture::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -469,8 +461,8 @@ void NiDynamicEffect::Put(NiStream& stream) {
 	}
 }
 
-void NiDynamicEffect::GetChildRefs(std::set<Ref*>& refs) {
-	NiAVObject::GetChildRefs(refs);
+void NiDynamicEffect::VisitChildRefs(RefSink<Ref>& refs) {
+	NiAVObject::VisitChildRefs(refs);
 
 	affectedNodes.GetIndexPtrs(refs);
 }
@@ -516,8 +508,8 @@ void NiTextureEffect::Put(NiStream& stream) {
 	stream << unkFloat;
 }
 
-void NiTextureEffect::GetChildRefs(std::set<Ref*>& refs) {
-	NiDynamicEffect::GetChildRefs(refs);
+void NiTextureEffect::VisitChildRefs(RefSink<Ref>& refs) {
+	NiDynamicEffect::VisitChildRefs(refs);
 
 	refs.insert(&sourceTexture);
 }
@@ -23,8 +23,8 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 
 	std::string GetName();
@@ -54,7 +54,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 
 	BlockRefArray<NiProperty>& GetProperties();
@@ -86,7 +86,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	NiDefaultAVObjectPalette* Clone() { return new NiDefaultAVObjectPalette(*this); }
 };
 
@@ -116,7 +116,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiCamera* Clone() { return new NiCamera(*this); }
 
@@ -206,7 +206,7 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 
 	int GetPaletteRef();
@@ -297,8 +297,8 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiSourceTexture* Clone() { return new NiSourceTexture(*this); }
 
@@ -353,7 +353,7 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 
 	BlockRefArray<NiNode>& GetAffectedNodes();
@@ -378,7 +378,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiTextureEffect* Clone() { return new NiTextureEffect(*this); }
 
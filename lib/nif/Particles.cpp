@@ -30,8 +30,7 @@ void NiParticlesData::Get(NiStream& stream) {
 	}
 
 	subtexOffsets.resize(numSubtexOffsets);
-	for (int i = 0; i < numSubtexOffsets; i++)
-		stream >> subtexOffsets[i];
+	stream.readArray(subtexOffsets.data(), numSubtexOffsets);
 
 	if (stream.GetVersion().User() >= 12) {
 		stream >> aspectRatio;
@@ -61,8 +60,7 @@ void NiParticlesData::Put(NiStream& stream) {
 		stream << numOffsets;
 	}
 
-	for (int i = 0; i < numSubtexOffsets; i++)
-		stream << subtexOffsets[i];
+	stream.writeArray(subtexOffsets.data(), numSubtexOffsets);
 
 	if (stream.GetVersion().User() >= 12) {
 		stream << aspectRatio;
@@ -86,8 +84,8 @@ void NiParticleMeshesData::Put(NiStream& stream) {
 	dataRef.Put(stream);
 }
 
-void NiParticleMeshesData::GetChildRefs(std::set<Ref*>& refs) {
-	NiRotatingParticlesData::GetChildRefs(refs);
+void NiParticleMeshesData::VisitChildRefs(RefSink<Ref>& refs) {
+	NiRotatingParticlesData::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -126,8 +124,7 @@ void NiMeshPSysData::Get(NiStream& stream) {
 
 	stream >> numGenerations;
 	generationPoolSize.resize(numGenerations);
-	for (int i = 0; i < numGenerations; i++)
-		stream >> generationPoolSize[i];
+	stream.readArray(generationPoolSize.data(), numGenerations);
 
 	nodeRef.Get(stream);
 }
@@ -139,14 +136,13 @@ void NiMeshPSysData::Put(NiStream& stream) {
 	stream << fillPoolsOnLoad;
 
 	stream << numGenerations;
-	for (int i = 0; i < numGenerations; i++)
-		stream << generationPoolSize[i];
+	stream.writeArray(generationPoolSize.data(), numGenerations);
 
 	nodeRef.Put(stream);
 }
 
-void NiMeshPSysData::GetChildRefs(std::set<Ref*>& refs) {
-	NiPSysData::GetChildRefs(refs);
+void NiMeshPSysData::VisitChildRefs(RefSink<Ref>& refs) {
+	NiPSysData::VisitChildRefs(refs);
 
 	refs.insert(&nodeRef);
 }
@@ -223,14 +219,14 @@ void NiPSysModifier::Put(NiStream& stream) {
 	stream << isActive;
 }
 
-void NiPSysModifier::GetStringRefs(std::set<StringRef*>& refs) {
-	NiObject::GetStringRefs(refs);
+void NiPSysModifier::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiObject::VisitStringRefs(refs);
 
 	refs.insert(&name);
 }
 
-void NiPSysModifier::GetPtrs(std::set<Ref*>& ptrs) {
-	NiObject::GetPtrs(ptrs);
+void NiPSysModifier::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiObject::VisitPtrs(ptrs);
 
 	ptrs.insert(&targetRef);
 }
@@ -290,8 +286,8 @@ void NiPSysAgeDeathModifier::Put(NiStream& stream) {
 	spawnModifierRef.Put(stream);
 }
 
-void NiPSysAgeDeathModifier::GetChildRefs(std::set<Ref*>& refs) {
-	NiPSysModifier::GetChildRefs(refs);
+void NiPSysAgeDeathModifier::VisitChildRefs(RefSink<Ref>& refs) {
+	NiPSysModifier::VisitChildRefs(refs);
 
 	refs.insert(&spawnModifierRef);
 }
@@ -336,8 +332,7 @@ void BSPSysSimpleColorModifier::Get(NiStream& stream) {
 	stream >> color3;
 
 	if (stream.GetVersion().Stream() == 155) {
-		for (int i = 0; i < 26; i++)
-			stream >> unknownShorts[i];
+		stream.readArray(unknownShorts, 26);
 	}
 }
 
@@ -355,8 +350,7 @@ void BSPSysSimpleColorModifier::Put(NiStream& stream) {
 	stream << color3;
 
 	if (stream.GetVersion().Stream() == 155) {
-		for (int i = 0; i < 26; i++)
-			stream << unknownShorts[i];
+		stream.writeArray(unknownShorts, 26);
 	}
 }
 
@@ -403,16 +397,14 @@ void BSPSysScaleModifier::Get(NiStream& stream) {
 
 	stream >> numFloats;
 	floats.resize(numFloats);
-	for (int i = 0; i < numFloats; i++)
-		stream >> floats[i];
+	stream.readArray(floats.data(), numFloats);
 }
 
 void BSPSysScaleModifier::Put(NiStream& stream) {
 	NiPSysModifier::Put(stream);
 
 	stream << numFloats;
-	for (int i = 0; i < numFloats; i++)
-		stream << floats[i];
+	stream.writeArray(floats.data(), numFloats);
 }
 
 
@@ -442,8 +434,8 @@ void NiPSysGravityModifier::Put(NiStream& stream) {
 	stream << worldAligned;
 }
 
-void NiPSysGravityModifier::GetPtrs(std::set<Ref*>& ptrs) {
-	NiPSysModifier::GetPtrs(ptrs);
+void NiPSysGravityModifier::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiPSysModifier::VisitPtrs(ptrs);
 
 	ptrs.insert(&gravityObjRef);
 }
@@ -482,8 +474,8 @@ void NiPSysDragModifier::Put(NiStream& stream) {
 	stream << rangeFalloff;
 }
 
-void NiPSysDragModifier::GetPtrs(std::set<Ref*>& ptrs) {
-	NiPSysModifier::GetPtrs(ptrs);
+void NiPSysDragModifier::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiPSysModifier::VisitPtrs(ptrs);
 
 	ptrs.insert(&parentRef);
 }
@@ -507,8 +499,8 @@ void BSPSysInheritVelocityModifier::Put(NiStream& stream) {
 	stream << velocityVar;
 }
 
-void BSPSysInheritVelocityModifier::GetPtrs(std::set<Ref*>& ptrs) {
-	NiPSysModifier::GetPtrs(ptrs);
+void BSPSysInheritVelocityModifier::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiPSysModifier::VisitPtrs(ptrs);
 
 	ptrs.insert(&targetNodeRef);
 }
@@ -561,8 +553,8 @@ void NiPSysBombModifier::Put(NiStream& stream) {
 	stream << symmetryType;
 }
 
-void NiPSysBombModifier::GetPtrs(std::set<Ref*>& ptrs) {
-	NiPSysModifier::GetPtrs(ptrs);
+void NiPSysBombModifier::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiPSysModifier::VisitPtrs(ptrs);
 
 	ptrs.insert(&bombNodeRef);
 }
@@ -593,8 +585,8 @@ void NiPSysColorModifier::Put(NiStream& stream) {
 	dataRef.Put(stream);
 }
 
-void NiPSysColorModifier::GetChildRefs(std::set<Ref*>& refs) {
-	NiPSysModifier::GetChildRefs(refs);
+void NiPSysColorModifier::VisitChildRefs(RefSink<Ref>& refs) {
+	NiPSysModifier::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -643,8 +635,8 @@ void NiPSysMeshUpdateModifier::Put(NiStream& stream) {
 	meshRefs.Put(stream);
 }
 
-void NiPSysMeshUpdateModifier::GetChildRefs(std::set<Ref*>& refs) {
-	NiPSysModifier::GetChildRefs(refs);
+void NiPSysMeshUpdateModifier::VisitChildRefs(RefSink<Ref>& refs) {
+	NiPSysModifier::VisitChildRefs(refs);
 
 	meshRefs.GetIndexPtrs(refs);
 }
@@ -680,8 +672,8 @@ void NiPSysFieldModifier::Put(NiStream& stream) {
 	stream << maxDistance;
 }
 
-void NiPSysFieldModifier::GetChildRefs(std::set<Ref*>& refs) {
-	NiPSysModifier::GetChildRefs(refs);
+void NiPSysFieldModifier::VisitChildRefs(RefSink<Ref>& refs) {
+	NiPSysModifier::VisitChildRefs(refs);
 
 	refs.insert(&fieldObjectRef);
 }
@@ -814,8 +806,8 @@ void BSPSysRecycleBoundModifier::Put(NiStream& stream) {
 	targetNodeRef.Put(stream);
 }
 
-void BSPSysRecycleBoundModifier::GetPtrs(std::set<Ref*>& ptrs) {
-	NiPSysModifier::GetPtrs(ptrs);
+void BSPSysRecycleBoundModifier::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiPSysModifier::VisitPtrs(ptrs);
 
 	ptrs.insert(&targetNodeRef);
 }
@@ -835,8 +827,8 @@ void BSPSysHavokUpdateModifier::Put(NiStream& stream) {
 	modifierRef.Put(stream);
 }
 
-void BSPSysHavokUpdateModifier::GetChildRefs(std::set<Ref*>& refs) {
-	NiPSysModifier::GetChildRefs(refs);
+void BSPSysHavokUpdateModifier::VisitChildRefs(RefSink<Ref>& refs) {
+	NiPSysModifier::VisitChildRefs(refs);
 
 	nodeRefs.GetIndexPtrs(refs);
 	refs.insert(&modifierRef);
@@ -890,8 +882,8 @@ void BSMasterParticleSystem::Put(NiStream& stream) {
 	particleSysRefs.Put(stream);
 }
 
-void BSMasterParticleSystem::GetChildRefs(std::set<Ref*>& refs) {
-	NiNode::GetChildRefs(refs);
+void BSMasterParticleSystem::VisitChildRefs(RefSink<Ref>& refs) {
+	NiNode::VisitChildRefs(refs);
 
 	particleSysRefs.GetIndexPtrs(refs);
 }
@@ -914,8 +906,7 @@ void NiParticleSystem::Get(NiStream& stream) {
 		stream >> bounds;
 
 		if (stream.GetVersion().Stream() == 155)
-			for (int i = 0; i < 6; i++)
-				stream >> boundMinMax[i];
+			stream.readArray(boundMinMax, 6);
 
 		skinInstanceRef.Get(stream);
 		shaderPropertyRef.Get(stream);
@@ -940,8 +931,7 @@ void NiParticleSystem::Get(NiStream& stream) {
 			materialNameRefs[i].Get(stream);
 
 		materials.resize(numMaterials);
-		for (int i = 0; i < numMaterials; i++)
-			stream >> materials[i];
+		stream.readArray(materials.data(), numMaterials);
 
 		stream >> activeMaterial;
 		stream >> defaultMatNeedsUpdate;
@@ -975,8 +965,7 @@ void NiParticleSystem::Put(NiStream& stream) {
 		stream << bounds;
 
 		if (stream.GetVersion().Stream() == 155)
-			for (int i = 0; i < 6; i++)
-				stream << boundMinMax[i];
+			stream.writeArray(boundMinMax, 6);
 
 		skinInstanceRef.Put(stream);
 		shaderPropertyRef.Put(stream);
@@ -998,8 +987,7 @@ void NiParticleSystem::Put(NiStream& stream) {
 		for (int i = 0; i < numMaterials; i++)
 			materialNameRefs[i].Put(stream);
 
-		for (int i = 0; i < numMaterials; i++)
-			stream << materials[i];
+		stream.writeArray(materials.data(), numMaterials);
 
 		stream << activeMaterial;
 		stream << defaultMatNeedsUpdate;
@@ -1024,15 +1012,15 @@ void NiParticleSystem::Put(NiStream& stream) {
 	modifierRefs.Put(stream);
 }
 
-void NiParticleSystem::GetStringRefs(std::set<StringRef*>& refs) {
-	NiAVObject::GetStringRefs(refs);
+void NiParticleSystem::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiAVObject::VisitStringRefs(refs);
 
 	for (auto &m : materialNameRefs)
 		refs.insert(&m);
 }
 
-void NiParticleSystem::GetChildRefs(std::set<Ref*>& refs) {
-	NiAVObject::GetChildRefs(refs);
+void NiParticleSystem::VisitChildRefs(RefSink<Ref>& refs) {
+	NiAVObject::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 	refs.insert(&skinInstanceRef);
@@ -1122,8 +1110,8 @@ void NiPSysCollider::Put(NiStream& stream) {
 	colliderNodeRef.Put(stream);
 }
 
-void NiPSysCollider::GetChildRefs(std::set<Ref*>& refs) {
-	NiObject::GetChildRefs(refs);
+void NiPSysCollider::VisitChildRefs(RefSink<Ref>& refs) {
+	NiObject::VisitChildRefs(refs);
 
 	refs.insert(&spawnModifierRef);
 	refs.insert(&nextColliderRef);
@@ -1136,8 +1124,8 @@ void NiPSysCollider::GetChildIndices(std::vector<int>& indices) {
 	indices.push_back(nextColliderRef.GetIndex());
 }
 
-void NiPSysCollider::GetPtrs(std::set<Ref*>& ptrs) {
-	NiObject::GetPtrs(ptrs);
+void NiPSysCollider::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiObject::VisitPtrs(ptrs);
 
 	ptrs.insert(&managerRef);
 	ptrs.insert(&colliderNodeRef);
@@ -1188,8 +1176,8 @@ void NiPSysColliderManager::Put(NiStream& stream) {
 	colliderRef.Put(stream);
 }
 
-void NiPSysColliderManager::GetChildRefs(std::set<Ref*>& refs) {
-	NiPSysModifier::GetChildRefs(refs);
+void NiPSysColliderManager::VisitChildRefs(RefSink<Ref>& refs) {
+	NiPSysModifier::VisitChildRefs(refs);
 
 	refs.insert(&colliderRef);
 }
@@ -1246,8 +1234,8 @@ void NiPSysVolumeEmitter::Put(NiStream& stream) {
 	emitterNodeRef.Put(stream);
 }
 
-void NiPSysVolumeEmitter::GetPtrs(std::set<Ref*>& ptrs) {
-	NiPSysEmitter::GetPtrs(ptrs);
+void NiPSysVolumeEmitter::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiPSysEmitter::VisitPtrs(ptrs);
 
 	ptrs.insert(&emitterNodeRef);
 }
@@ -1318,8 +1306,8 @@ void NiPSysMeshEmitter::Put(NiStream& stream) {
 	stream << emissionAxis;
 }
 
-void NiPSysMeshEmitter::GetChildRefs(std::set<Ref*>& refs) {
-	NiPSysEmitter::GetChildRefs(refs);
+void NiPSysMeshEmitter::VisitChildRefs(RefSink<Ref>& refs) {
+	NiPSysEmitter::VisitChildRefs(refs);
 
 	meshRefs.GetIndexPtrs(refs);
 }
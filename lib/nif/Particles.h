@@ -97,7 +97,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 
 	NiParticleMeshesData* Clone() { return new NiParticleMeshesData(*this); }
@@ -133,7 +133,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiMeshPSysData* Clone() { return new NiMeshPSysData(*this); }
 };
@@ -181,8 +181,8 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 };
 
 class BSPSysStripUpdateModifier : public NiPSysModifier {
@@ -229,7 +229,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiPSysAgeDeathModifier* Clone() { return new NiPSysAgeDeathModifier(*this); }
 };
@@ -330,7 +330,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	NiPSysGravityModifier* Clone() { return new NiPSysGravityModifier(*this); }
 };
 
@@ -369,7 +369,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	NiPSysDragModifier* Clone() { return new NiPSysDragModifier(*this); }
 };
 
@@ -386,7 +386,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	BSPSysInheritVelocityModifier* Clone() { return new BSPSysInheritVelocityModifier(*this); }
 };
 
@@ -436,7 +436,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	NiPSysBombModifier* Clone() { return new NiPSysBombModifier(*this); }
 };
 
@@ -463,7 +463,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiPSysColorModifier* Clone() { return new NiPSysColorModifier(*this); }
 };
@@ -495,7 +495,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiPSysMeshUpdateModifier* Clone() { return new NiPSysMeshUpdateModifier(*this); }
 
@@ -513,7 +513,7 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 };
 
@@ -627,7 +627,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	BSPSysRecycleBoundModifier* Clone() { return new BSPSysRecycleBoundModifier(*this); }
 };
 
@@ -642,7 +642,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	BSPSysHavokUpdateModifier* Clone() { return new BSPSysHavokUpdateModifier(*this); }
 
@@ -677,7 +677,7 @@ public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
 
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	BSMasterParticleSystem* Clone() { return new BSMasterParticleSystem(*this); }
 
@@ -725,8 +725,8 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiParticleSystem* Clone() { return new NiParticleSystem(*this); }
 
@@ -779,9 +779,9 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 };
 
 class NiPSysSphericalCollider : public NiPSysCollider {
@@ -823,7 +823,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiPSysColliderManager* Clone() { return new NiPSysColliderManager(*this); }
 };
@@ -854,7 +854,7 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 };
 
 class NiPSysSphereEmitter : public NiPSysVolumeEmitter {
@@ -934,7 +934,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	NiPSysMeshEmitter* Clone() { return new NiPSysMeshEmitter(*this); }
 
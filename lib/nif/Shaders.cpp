@@ -210,24 +210,24 @@ void NiTexturingProperty::Put(NiStream& stream) {
 		shaderTex[i].Put(stream);
 }
 
-void NiTexturingProperty::GetChildRefs(std::set<Ref*>& refs) {
-	NiProperty::GetChildRefs(refs);
-
-	baseTex.GetChildRefs(refs);
-	darkTex.GetChildRefs(refs);
-	detailTex.GetChildRefs(refs);
-	glossTex.GetChildRefs(refs);
-	glowTex.GetChildRefs(refs);
-	bumpTex.GetChildRefs(refs);
-	normalTex.GetChildRefs(refs);
-	parallaxTex.GetChildRefs(refs);
-	decalTex0.GetChildRefs(refs);
-	decalTex1.GetChildRefs(refs);
-	decalTex2.GetChildRefs(refs);
-	decalTex3.GetChildRefs(refs);
+void NiTexturingProperty::VisitChildRefs(RefSink<Ref>& refs) {
+	NiProperty::VisitChildRefs(refs);
+
+	baseTex.VisitChildRefs(refs);
+	darkTex.VisitChildRefs(refs);
+	detailTex.VisitChildRefs(refs);
+	glossTex.VisitChildRefs(refs);
+	glowTex.VisitChildRefs(refs);
+	bumpTex.VisitChildRefs(refs);
+	normalTex.VisitChildRefs(refs);
+	parallaxTex.VisitChildRefs(refs);
+	decalTex0.VisitChildRefs(refs);
+	decalTex1.VisitChildRefs(refs);
+	decalTex2.VisitChildRefs(refs);
+	decalTex3.VisitChildRefs(refs);
 
 	for (auto &t : shaderTex)
-		t.GetChildRefs(refs);
+		t.VisitChildRefs(refs);
 }
 
 void NiTexturingProperty::GetChildIndices(std::vector<int>& indices) {
@@ -342,11 +342,9 @@ void BSShaderProperty::Get(NiStream& stream) {
 			SF1.resize(numSF1);
 			SF2.resize(numSF2);
 		
-			for (int i = 0; i < numSF1; i++)
-				stream >> SF1[i];
+			stream.readArray(SF1.data(), numSF1);
 		
-			for (int i = 0; i < numSF2; i++)
-				stream >> SF2[i];
+			stream.readArray(SF2.data(), numSF2);
 		}
 
 		if (stream.GetVersion().Stream() < 155) {
@@ -377,11 +375,9 @@ void BSShaderProperty::Put(NiStream& stream) {
 			stream << numSF1;
 			stream << numSF2;
 		
-			for (int i = 0; i < numSF1; i++)
-				stream << SF1[i];
+			stream.writeArray(SF1.data(), numSF1);
 		
-			for (int i = 0; i < numSF2; i++)
-				stream << SF2[i];
+			stream.writeArray(SF2.data(), numSF2);
 		}
 
 		if (stream.GetVersion().Stream() < 155) {
@@ -834,14 +830,14 @@ void BSLightingShaderProperty::Put(NiStream& stream) {
 	}
 }
 
-void BSLightingShaderProperty::GetStringRefs(std::set<StringRef*>& refs) {
-	BSShaderProperty::GetStringRefs(refs);
+void BSLightingShaderProperty::VisitStringRefs(RefSink<StringRef>& refs) {
+	BSShaderProperty::VisitStringRefs(refs);
 
 	refs.insert(&rootMaterialName);
 }
 
-void BSLightingShaderProperty::GetChildRefs(std::set<Ref*>& refs) {
-	BSShaderProperty::GetChildRefs(refs);
+void BSLightingShaderProperty::VisitChildRefs(RefSink<Ref>& refs) {
+	BSShaderProperty::VisitChildRefs(refs);
 
 	refs.insert(&textureSetRef);
 }
@@ -1165,8 +1161,8 @@ void BSShaderPPLightingProperty::Put(NiStream& stream) {
 		stream << emissiveColor;
 }
 
-void BSShaderPPLightingProperty::GetChildRefs(std::set<Ref*>& refs) {
-	BSShaderLightingProperty::GetChildRefs(refs);
+void BSShaderPPLightingProperty::VisitChildRefs(RefSink<Ref>& refs) {
+	BSShaderLightingProperty::VisitChildRefs(refs);
 
 	refs.insert(&textureSetRef);
 }
@@ -109,7 +109,7 @@ public:
 			stream << transform;
 	}
 
-	void GetChildRefs(std::set<Ref*>& refs) {
+	void VisitChildRefs(RefSink<Ref>& refs) {
 		refs.insert(&sourceRef);
 	}
 
@@ -151,8 +151,8 @@ public:
 		}
 	}
 
-	void GetChildRefs(std::set<Ref*>& refs) {
-		data.GetChildRefs(refs);
+	void VisitChildRefs(RefSink<Ref>& refs) {
+		data.VisitChildRefs(refs);
 	}
 
 	void GetChildIndices(std::vector<int>& indices) {
@@ -214,7 +214,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 
 	NiTexturingProperty* Clone() { return new NiTexturingProperty(*this); }
@@ -550,8 +550,8 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	BSLightingShaderProperty* Clone() { return new BSLightingShaderProperty(*this); }
 
@@ -735,7 +735,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	BSShaderPPLightingProperty* Clone() { return new BSShaderPPLightingProperty(*this); }
 
@@ -4,11 +4,122 @@ See the included LICENSE file
 */
 
 #include "Skin.h"
-#include "utils/half.hpp"
+#include "VertexCodec.h"
 #include "NifUtil.h"
 
+#include <algorithm>
 #include <unordered_map>
 
+void BoneWeightColumns::Clear() {
+	offsets.clear();
+	vertices.clear();
+	weights.clear();
+}
+
+void BoneWeightColumns::AddColumn(const std::unordered_map<ushort, float>& boneWeights) {
+	if (offsets.empty())
+		offsets.push_back(0);
+
+	size_t start = vertices.size();
+	for (auto& w : boneWeights)
+		vertices.push_back(w.first);
+
+	std::sort(vertices.begin() + start, vertices.end());
+
+	for (size_t i = start; i < vertices.size(); i++)
+		weights.push_back(boneWeights.at(vertices[i]));
+
+	offsets.push_back(vertices.size());
+}
+
+void BoneWeightColumns::AddColumn(Span<const ushort> boneVertices, Span<const float> boneWeights) {
+	if (offsets.empty())
+		offsets.push_back(0);
+
+	vertices.insert(vertices.end(), boneVertices.begin(), boneVertices.end());
+	weights.insert(weights.end(), boneWeights.begin(), boneWeights.end());
+	offsets.push_back(vertices.size());
+}
+
+void BoneWeightColumns::GetColumn(const size_t bone, std::unordered_map<ushort, float>& outWeights) const {
+	outWeights.clear();
+	if (bone >= GetNumBones())
+		return;
+
+	outWeights.reserve(GetColumnSize(bone));
+	for (uint i = offsets[bone]; i < offsets[bone + 1]; i++)
+		outWeights.emplace(vertices[i], weights[i]);
+}
+
+void VertexWeightRows::Reset(const size_t numVertices) {
+	bones.assign(numVertices * MaxInfluences, 0);
+	weights.assign(numVertices * MaxInfluences, 0.0f);
+}
+
+void VertexWeightRows::AddInfluence(const size_t vertex, const ushort bone, const float weight) {
+	ushort* rowBones = &bones[vertex * MaxInfluences];
+	float* rowWeights = &weights[vertex * MaxInfluences];
+
+	int weakest = 0;
+	for (int i = 1; i < MaxInfluences; i++)
+		if (rowWeights[i] < rowWeights[weakest])
+			weakest = i;
+
+	if (weight > rowWeights[weakest]) {
+		rowBones[weakest] = bone;
+		rowWeights[weakest] = weight;
+	}
+}
+
+void VertexWeightRows::Normalize() {
+	for (size_t v = 0; v < GetNumVertices(); v++) {
+		float* rowWeights = &weights[v * MaxInfluences];
+		float sum = rowWeights[0] + rowWeights[1] + rowWeights[2] + rowWeights[3];
+		if (sum > 0.0f) {
+			for (int i = 0; i < MaxInfluences; i++)
+				rowWeights[i] /= sum;
+		}
+	}
+}
+
+void WeightColumnsToRows(const BoneWeightColumns& columns, const size_t numVertices, VertexWeightRows& outRows) {
+	outRows.Reset(numVertices);
+
+	for (size_t b = 0; b < columns.GetNumBones(); b++) {
+		for (uint i = columns.offsets[b]; i < columns.offsets[b + 1]; i++) {
+			if (columns.vertices[i] < numVertices && columns.weights[i] > 0.0f)
+				outRows.AddInfluence(columns.vertices[i], b, columns.weights[i]);
+		}
+	}
+}
+
+void WeightRowsToColumns(const VertexWeightRows& rows, const size_t numBones, BoneWeightColumns& outColumns) {
+	outColumns.Clear();
+	outColumns.offsets.assign(numBones + 1, 0);
+
+	// Count entries per bone first, then place them so every column stays in vertex order
+	size_t numEntries = rows.GetNumVertices() * VertexWeightRows::MaxInfluences;
+	for (size_t i = 0; i < numEntries; i++) {
+		if (rows.weights[i] != 0.0f && rows.bones[i] < numBones)
+			outColumns.offsets[rows.bones[i] + 1]++;
+	}
+
+	for (size_t b = 0; b < numBones; b++)
+		outColumns.offsets[b + 1] += outColumns.offsets[b];
+
+	outColumns.vertices.resize(outColumns.offsets[numBones]);
+	outColumns.weights.resize(outColumns.offsets[numBones]);
+
+	std::vector<uint> next(outColumns.offsets.begin(), outColumns.offsets.end() - 1);
+	for (size_t i = 0; i < numEntries; i++) {
+		if (rows.weights[i] != 0.0f && rows.bones[i] < numBones) {
+			uint pos = next[rows.bones[i]]++;
+			outColumns.vertices[pos] = i / VertexWeightRows::MaxInfluences;
+			outColumns.weights[pos] = rows.weights[i];
+		}
+	}
+}
+
 void NiSkinData::Get(NiStream& stream) {
 	NiObject::Get(stream);
 
@@ -113,67 +224,10 @@ void NiSkinPartition::Get(NiStream& stream) {
 			numVertices = dataSize / vertexSize;
 			vertData.resize(numVertices);
 
-			half_float::half halfData;
-			for (int i = 0; i < numVertices; i++) {
-				auto& vertex = vertData[i];
-				if (HasVertices()) {
-					if (IsFullPrecision()) {
-						// Full precision
-						stream >> vertex.vert;
-						stream >> vertex.bitangentX;
-					}
-					else {
-						// Half precision
-						stream.read((char*)&halfData, 2);
-						vertex.vert.x = halfData;
-						stream.read((char*)&halfData, 2);
-						vertex.vert.y = halfData;
-						stream.read((char*)&halfData, 2);
-						vertex.vert.z = halfData;
-
-						stream.read((char*)&halfData, 2);
-						vertex.bitangentX = halfData;
-					}
-				}
-
-				if (HasUVs()) {
-					stream.read((char*)&halfData, 2);
-					vertex.uv.u = halfData;
-					stream.read((char*)&halfData, 2);
-					vertex.uv.v = halfData;
-				}
-
-				if (HasNormals()) {
-					for (int j = 0; j < 3; j++)
-						stream >> vertex.normal[j];
-
-					stream >> vertex.bitangentY;
-
-					if (HasTangents()) {
-						for (int j = 0; j < 3; j++)
-							stream >> vertex.tangent[j];
-
-						stream >> vertex.bitangentZ;
-					}
-				}
-
-				if (HasVertexColors())
-					for (int j = 0; j < 4; j++)
-						stream >> vertex.colorData[j];
-
-				if (IsSkinned()) {
-					for (int j = 0; j < 4; j++) {
-						stream.read((char*)&halfData, 2);
-						vertex.weights[j] = halfData;
-					}
-
-					for (int j = 0; j < 4; j++)
-						stream >> vertex.weightBones[j];
-				}
-
-				if (HasEyeData())
-					stream >> vertex.eyeData;
-			}
+			byte layout = GetVertexLayout(vertexDesc, IsFullPrecision());
+			std::vector<char> packed(numVertices * GetVertexLayoutSize(layout));
+			stream.readArray(packed.data(), packed.size());
+			DecodeVertices(layout, packed.data(), vertData.data(), numVertices);
 		}
 	}
 
@@ -186,48 +240,41 @@ void NiSkinPartition::Get(NiStream& stream) {
 		stream >> partition.numWeightsPerVertex;
 
 		partition.bones.resize(partition.numBones);
-		for (int i = 0; i < partition.numBones; i++)
-			stream >> partition.bones[i];
+		stream.readArray(partition.bones.data(), partition.numBones);
 
 		stream >> partition.hasVertexMap;
 		if (partition.hasVertexMap) {
 			partition.vertexMap.resize(partition.numVertices);
-			for (int i = 0; i < partition.numVertices; i++)
-				stream >> partition.vertexMap[i];
+			stream.readArray(partition.vertexMap.data(), partition.numVertices);
 		}
 
 		stream >> partition.hasVertexWeights;
 		if (partition.hasVertexWeights) {
 			partition.vertexWeights.resize(partition.numVertices);
-			for (int i = 0; i < partition.numVertices; i++)
-				stream >> partition.vertexWeights[i];
+			stream.readArray(partition.vertexWeights.data(), partition.numVertices);
 		}
 
 		partition.stripLengths.resize(partition.numStrips);
-		for (int i = 0; i < partition.numStrips; i++)
-			stream >> partition.stripLengths[i];
+		stream.readArray(partition.stripLengths.data(), partition.numStrips);
 
 		stream >> partition.hasFaces;
 		if (partition.hasFaces) {
 			partition.strips.resize(partition.numStrips);
 			for (int i = 0; i < partition.numStrips; i++) {
 				partition.strips[i].resize(partition.stripLengths[i]);
-				for (int j = 0; j < partition.stripLengths[i]; j++)
-					stream >> partition.strips[i][j];
+				stream.readArray(partition.strips[i].data(), partition.stripLengths[i]);
 			}
 		}
 
 		if (partition.numStrips == 0 && partition.hasFaces) {
 			partition.triangles.resize(partition.numTriangles);
-			for (int i = 0; i < partition.numTriangles; i++)
-				stream >> partition.triangles[i];
+			stream.readArray(partition.triangles.data(), partition.numTriangles);
 		}
 
 		stream >> partition.hasBoneIndices;
 		if (partition.hasBoneIndices) {
 			partition.boneIndices.resize(partition.numVertices);
-			for (int i = 0; i < partition.numVertices; i++)
-				stream >> partition.boneIndices[i];
+			stream.readArray(partition.boneIndices.data(), partition.numVertices);
 		}
 
 		if (stream.GetVersion().User() >= 12)
@@ -237,8 +284,7 @@ void NiSkinPartition::Get(NiStream& stream) {
 			partition.vertexDesc.Get(stream);
 
 			partition.trueTriangles.resize(partition.numTriangles);
-			for (int i = 0; i < partition.numTriangles; i++)
-				stream >> partition.trueTriangles[i];
+			stream.readArray(partition.trueTriangles.data(), partition.numTriangles);
 		}
 
 		partitions[p] = partition;
@@ -258,67 +304,10 @@ void NiSkinPartition::Put(NiStream& stream) {
 		vertexDesc.Put(stream);
 
 		if (dataSize > 0) {
-			half_float::half halfData;
-			for (int i = 0; i < numVertices; i++) {
-				auto& vertex = vertData[i];
-				if (HasVertices()) {
-					if (IsFullPrecision()) {
-						// Full precision
-						stream << vertex.vert;
-						stream << vertex.bitangentX;
-					}
-					else {
-						// Half precision
-						halfData = vertex.vert.x;
-						stream.write((char*)&halfData, 2);
-						halfData = vertex.vert.y;
-						stream.write((char*)&halfData, 2);
-						halfData = vertex.vert.z;
-						stream.write((char*)&halfData, 2);
-
-						halfData = vertex.bitangentX;
-						stream.write((char*)&halfData, 2);
-					}
-				}
-
-				if (HasUVs()) {
-					halfData = vertex.uv.u;
-					stream.write((char*)&halfData, 2);
-					halfData = vertex.uv.v;
-					stream.write((char*)&halfData, 2);
-				}
-
-				if (HasNormals()) {
-					for (int j = 0; j < 3; j++)
-						stream << vertex.normal[j];
-
-					stream << vertex.bitangentY;
-
-					if (HasTangents()) {
-						for (int j = 0; j < 3; j++)
-							stream << vertex.tangent[j];
-
-						stream << vertex.bitangentZ;
-					}
-				}
-
-				if (HasVertexColors())
-					for (int j = 0; j < 4; j++)
-						stream << vertex.colorData[j];
-
-				if (IsSkinned()) {
-					for (int j = 0; j < 4; j++) {
-						halfData = vertex.weights[j];
-						stream.write((char*)&halfData, 2);
-					}
-
-					for (int j = 0; j < 4; j++)
-						stream << vertex.weightBones[j];
-				}
-
-				if (HasEyeData())
-					stream << vertex.eyeData;
-			}
+			byte layout = GetVertexLayout(vertexDesc, IsFullPrecision());
+			std::vector<char> packed(numVertices * GetVertexLayoutSize(layout));
+			EncodeVertices(layout, vertData.data(), packed.data(), numVertices);
+			stream.writeArray(packed.data(), packed.size());
 		}
 	}
 
@@ -333,36 +322,29 @@ void NiSkinPartition::Put(NiStream& stream) {
 		stream << partitions[p].numStrips;
 		stream << partitions[p].numWeightsPerVertex;
 
-		for (int i = 0; i < partitions[p].numBones; i++)
-			stream << partitions[p].bones[i];
+		stream.writeArray(partitions[p].bones.data(), partitions[p].numBones);
 
 		stream << partitions[p].hasVertexMap;
 		if (partitions[p].hasVertexMap)
-			for (int i = 0; i < partitions[p].numVertices; i++)
-				stream << partitions[p].vertexMap[i];
+			stream.writeArray(partitions[p].vertexMap.data(), partitions[p].numVertices);
 
 		stream << partitions[p].hasVertexWeights;
 		if (partitions[p].hasVertexWeights)
-			for (int i = 0; i < partitions[p].numVertices; i++)
-				stream << partitions[p].vertexWeights[i];
+			stream.writeArray(partitions[p].vertexWeights.data(), partitions[p].numVertices);
 
-		for (int i = 0; i < partitions[p].numStrips; i++)
-			stream << partitions[p].stripLengths[i];
+		stream.writeArray(partitions[p].stripLengths.data(), partitions[p].numStrips);
 
 		stream << partitions[p].hasFaces;
 		if (partitions[p].hasFaces)
 			for (int i = 0; i < partitions[p].numStrips; i++)
-				for (int j = 0; j < partitions[p].stripLengths[i]; j++)
-					stream << partitions[p].strips[i][j];
+				stream.writeArray(partitions[p].strips[i].data(), partitions[p].stripLengths[i]);
 
 		if (partitions[p].numStrips == 0 && partitions[p].hasFaces)
-			for (int i = 0; i < partitions[p].numTriangles; i++)
-				stream << partitions[p].triangles[i];
+			stream.writeArray(partitions[p].triangles.data(), partitions[p].numTriangles);
 
 		stream << partitions[p].hasBoneIndices;
 		if (partitions[p].hasBoneIndices)
-			for (int i = 0; i < partitions[p].numVertices; i++)
-				stream << partitions[p].boneIndices[i];
+			stream.writeArray(partitions[p].boneIndices.data(), partitions[p].numVertices);
 
 		if (stream.GetVersion().User() >= 12)
 			stream << partitions[p].unkShort;
@@ -370,8 +352,7 @@ void NiSkinPartition::Put(NiStream& stream) {
 		if (stream.GetVersion().User() >= 12 && stream.GetVersion().Stream() == 100) {
 			partitions[p].vertexDesc.Put(stream);
 
-			for (int i = 0; i < partitions[p].numTriangles; i++)
-				stream << partitions[p].trueTriangles[i];
+			stream.writeArray(partitions[p].trueTriangles.data(), partitions[p].numTriangles);
 		}
 	}
 }
@@ -471,7 +452,8 @@ bool NiSkinPartition::PartitionBlock::ConvertStripsToTriangles() {
 	if (numStrips == 0)
 		return false;
 	hasFaces = true;
-	triangles = GenerateTrianglesFromStrips(strips);
+	std::vector<Triangle> stripTris = GenerateTrianglesFromStrips(strips);
+	triangles.assign(stripTris.begin(), stripTris.end());
 	numTriangles = triangles.size();
 	numStrips = 0;
 	strips.clear();
@@ -662,8 +644,8 @@ void NiSkinInstance::Put(NiStream& stream) {
 	boneRefs.Put(stream);
 }
 
-void NiSkinInstance::GetChildRefs(std::set<Ref*>& refs) {
-	NiObject::GetChildRefs(refs);
+void NiSkinInstance::VisitChildRefs(RefSink<Ref>& refs) {
+	NiObject::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 	refs.insert(&skinPartitionRef);
@@ -676,8 +658,8 @@ void NiSkinInstance::GetChildIndices(std::vector<int>& indices) {
 	indices.push_back(skinPartitionRef.GetIndex());
 }
 
-void NiSkinInstance::GetPtrs(std::set<Ref*>& ptrs) {
-	NiObject::GetPtrs(ptrs);
+void NiSkinInstance::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiObject::VisitPtrs(ptrs);
 
 	ptrs.insert(&targetRef);
 	boneRefs.GetIndexPtrs(ptrs);
@@ -690,16 +672,14 @@ void BSDismemberSkinInstance::Get(NiStream& stream) {
 	stream >> numPartitions;
 	partitions.resize(numPartitions);
 
-	for (int i = 0; i < numPartitions; i++)
-		stream >> partitions[i];
+	stream.readArray(partitions.data(), numPartitions);
 }
 
 void BSDismemberSkinInstance::Put(NiStream& stream) {
 	NiSkinInstance::Put(stream);
 
 	stream << numPartitions;
-	for (int i = 0; i < numPartitions; i++)
-		stream << partitions[i];
+	stream.writeArray(partitions.data(), numPartitions);
 }
 
 void BSDismemberSkinInstance::AddPartition(const BSDismemberSkinInstance::PartitionInfo& part) {
@@ -762,8 +742,7 @@ void BSSkinInstance::Get(NiStream& stream) {
 
 	stream >> numScales;
 	scales.resize(numScales);
-	for (int i = 0; i < numScales; i++)
-		stream >> scales[i];
+	stream.readArray(scales.data(), numScales);
 }
 
 void BSSkinInstance::Put(NiStream& stream) {
@@ -774,12 +753,11 @@ void BSSkinInstance::Put(NiStream& stream) {
 	boneRefs.Put(stream);
 
 	stream << numScales;
-	for (int i = 0; i < numScales; i++)
-		stream << scales[i];
+	stream.writeArray(scales.data(), numScales);
 }
 
-void BSSkinInstance::GetChildRefs(std::set<Ref*>& refs) {
-	NiObject::GetChildRefs(refs);
+void BSSkinInstance::VisitChildRefs(RefSink<Ref>& refs) {
+	NiObject::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -790,8 +768,8 @@ void BSSkinInstance::GetChildIndices(std::vector<int>& indices) {
 	indices.push_back(dataRef.GetIndex());
 }
 
-void BSSkinInstance::GetPtrs(std::set<Ref*>& ptrs) {
-	NiObject::GetPtrs(ptrs);
+void BSSkinInstance::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiObject::VisitPtrs(ptrs);
 
 	ptrs.insert(&targetRef);
 	boneRefs.GetIndexPtrs(ptrs);
@@ -7,6 +7,7 @@ See the included LICENSE file
 
 #include "BasicTypes.h"
 #include "VertexData.h"
+#include "utils/Span.h"
 
 struct SkinWeight {
 	ushort index;
@@ -18,6 +19,57 @@ struct SkinWeight {
 	}
 };
 
+// Vertex weights of every bone as sparse columns in one flat allocation.
+// Column b holds entries [offsets[b], offsets[b + 1]) of vertices and weights.
+struct BoneWeightColumns {
+	std::vector<uint> offsets;
+	std::vector<ushort> vertices;
+	std::vector<float> weights;
+
+	size_t GetNumBones() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+	size_t GetNumEntries() const { return vertices.size(); }
+	uint GetColumnSize(const size_t bone) const { return offsets[bone + 1] - offsets[bone]; }
+
+	Span<const ushort> GetVertices(const size_t bone) const {
+		return Span<const ushort>(vertices.data() + offsets[bone], GetColumnSize(bone));
+	}
+
+	Span<const float> GetWeights(const size_t bone) const {
+		return Span<const float>(weights.data() + offsets[bone], GetColumnSize(bone));
+	}
+
+	void Clear();
+
+	// Appends the column of the next bone, entries are sorted by vertex
+	void AddColumn(const std::unordered_map<ushort, float>& boneWeights);
+	void AddColumn(Span<const ushort> boneVertices, Span<const float> boneWeights);
+
+	void GetColumn(const size_t bone, std::unordered_map<ushort, float>& outWeights) const;
+};
+
+// Up to four bone influences per vertex in fixed-size rows, unused slots have a weight of zero
+struct VertexWeightRows {
+	static constexpr int MaxInfluences = 4;
+
+	std::vector<ushort> bones;
+	std::vector<float> weights;
+
+	size_t GetNumVertices() const { return weights.size() / MaxInfluences; }
+
+	// Resizes to numVertices rows without any influences
+	void Reset(const size_t numVertices);
+
+	// Fills a free slot or replaces the weakest influence if the new weight is stronger
+	void AddInfluence(const size_t vertex, const ushort bone, const float weight);
+
+	// Scales the weights of every vertex with influences to a sum of one
+	void Normalize();
+};
+
+// Keeps the four strongest weights of each vertex
+void WeightColumnsToRows(const BoneWeightColumns& columns, const size_t numVertices, VertexWeightRows& outRows);
+void WeightRowsToColumns(const VertexWeightRows& rows, const size_t numBones, BoneWeightColumns& outColumns);
+
 struct VertexWeight {
 	float w1 = 0.0f;
 	float w2 = 0.0f;
@@ -40,7 +92,7 @@ public:
 		MatTransform boneTransform;
 		BoundingSphere bounds;
 		ushort numVertices = 0;
-		std::vector<SkinWeight> vertexWeights;
+		BlockVector<SkinWeight> vertexWeights;
 	};
 
 	// skinTransform transforms from the global CS to the skin CS.
@@ -48,7 +100,7 @@ public:
 	MatTransform skinTransform;
 	uint numBones = 0;
 	byte hasVertWeights = 1;
-	std::vector<BoneData> bones;
+	BlockVector<BoneData> bones;
 
 	static constexpr const char* BlockName = "NiSkinData";
 	virtual const char* GetBlockName() { return BlockName; }
@@ -69,21 +121,21 @@ public:
 		ushort numWeightsPerVertex = 0;
 		std::vector<ushort> bones;
 		bool hasVertexMap = false;
-		std::vector<ushort> vertexMap;
+		BlockVector<ushort> vertexMap;
 		bool hasVertexWeights = false;
-		std::vector<VertexWeight> vertexWeights;
+		BlockVector<VertexWeight> vertexWeights;
 		std::vector<ushort> stripLengths;
 		bool hasFaces = false;
 		std::vector<std::vector<ushort>> strips;
-		std::vector<Triangle> triangles;
+		BlockVector<Triangle> triangles;
 		bool hasBoneIndices = false;
-		std::vector<BoneIndices> boneIndices;
+		BlockVector<BoneIndices> boneIndices;
 
 		ushort unkShort = 0;					// User Version >= 12
 		VertexDesc vertexDesc;					// User Version >= 12, User Version 2 == 100
 		// When trueTriangles is changed so it's no longer in sync with
 		// triParts, triParts should be cleared.
-		std::vector<Triangle> trueTriangles;	// User Version >= 12, User Version 2 == 100
+		BlockVector<Triangle> trueTriangles;	// User Version >= 12, User Version 2 == 100
 
 		bool ConvertStripsToTriangles();
 		void GenerateTrueTrianglesFromMappedTriangles();
@@ -97,8 +149,8 @@ public:
 	VertexDesc vertexDesc;					// User Version >= 12, User Version 2 == 100
 
 	uint numVertices = 0;					// Not in file
-	std::vector<BSVertexData> vertData;		// User Version >= 12, User Version 2 == 100
-	std::vector<PartitionBlock> partitions;
+	BlockVector<BSVertexData> vertData;		// User Version >= 12, User Version 2 == 100
+	BlockVector<PartitionBlock> partitions;
 
 	// bMappedIndices is not in the file; it is calculated from
 	// the file version.  If true, the vertex indices in triangles
@@ -183,9 +235,9 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	NiSkinInstance* Clone() { return new NiSkinInstance(*this); }
 
 	int GetDataRef() { return dataRef.GetIndex(); }
@@ -280,9 +332,9 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	BSSkinInstance* Clone() { return new BSSkinInstance(*this); }
 
 	int GetTargetRef() { return targetRef.GetIndex(); }
@@ -0,0 +1,179 @@
+/*
+BodySlide and Outfit Studio
+See the included LICENSE file
+*/
+
+#include "Skinning.h"
+#include "NifFile.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	LinearBlendSkin::BoneMatrix ToBoneMatrix(const MatTransform& t) {
+		LinearBlendSkin::BoneMatrix bm;
+		for (int r = 0; r < 3; r++) {
+			bm.m[r * 4 + 0] = t.rotation[r].x * t.scale;
+			bm.m[r * 4 + 1] = t.rotation[r].y * t.scale;
+			bm.m[r * 4 + 2] = t.rotation[r].z * t.scale;
+		}
+
+		bm.m[3] = t.translation.x;
+		bm.m[7] = t.translation.y;
+		bm.m[11] = t.translation.z;
+		return bm;
+	}
+
+	// Inverse of the 3x3 part of a row-major 3x4 matrix by cofactors, false if it's singular
+	bool InvertLinear(const float* m, float* inv) {
+		inv[0] = m[5] * m[10] - m[6] * m[9];
+		inv[1] = m[2] * m[9] - m[1] * m[10];
+		inv[2] = m[1] * m[6] - m[2] * m[5];
+		inv[3] = m[6] * m[8] - m[4] * m[10];
+		inv[4] = m[0] * m[10] - m[2] * m[8];
+		inv[5] = m[2] * m[4] - m[0] * m[6];
+		inv[6] = m[4] * m[9] - m[5] * m[8];
+		inv[7] = m[1] * m[8] - m[0] * m[9];
+		inv[8] = m[0] * m[5] - m[1] * m[4];
+
+		float det = m[0] * inv[0] + m[1] * inv[3] + m[2] * inv[6];
+		if (std::fabs(det) < EPSILON)
+			return false;
+
+		float invDet = 1.0f / det;
+		for (int i = 0; i < 9; i++)
+			inv[i] *= invDet;
+
+		return true;
+	}
+}
+
+bool LinearBlendSkin::Build(NifFile& nif, NiShape* shape) {
+	Clear();
+
+	if (!shape || !shape->IsSkinned())
+		return false;
+
+	auto& hdr = nif.GetHeader();
+
+	std::vector<int> boneIds;
+	nif.GetShapeBoneIDList(shape, boneIds);
+	if (boneIds.empty())
+		return false;
+
+	palette.resize(boneIds.size());
+	for (size_t i = 0; i < boneIds.size(); i++) {
+		MatTransform skinToBone;
+		nif.GetShapeTransformSkinToBone(shape, i, skinToBone);
+
+		MatTransform boneToGlobal;
+		auto node = hdr.LoadBlock<NiNode>(boneIds[i]);
+		if (node)
+			nif.GetNodeTransformToGlobal(node->GetName(), boneToGlobal);
+
+		palette[i] = ToBoneMatrix(boneToGlobal.ComposeTransforms(skinToBone));
+	}
+
+	nif.GetShapeVertexWeights(shape, influences);
+
+	// Slots pointing past the palette get dropped so blending never needs a bounds check
+	for (size_t i = 0; i < influences.weights.size(); i++) {
+		if (influences.bones[i] >= palette.size()) {
+			influences.bones[i] = 0;
+			influences.weights[i] = 0.0f;
+		}
+	}
+
+	influences.Normalize();
+
+	return true;
+}
+
+void LinearBlendSkin::Clear() {
+	palette.clear();
+	influences.Reset(0);
+}
+
+bool LinearBlendSkin::Blend(const size_t vertex, BoneMatrix& out) const {
+	const ushort* bones = &influences.bones[vertex * MaxInfluences];
+	const float* weights = &influences.weights[vertex * MaxInfluences];
+
+	if (weights[0] + weights[1] + weights[2] + weights[3] <= 0.0f)
+		return false;
+
+	// Unused slots have a weight of zero and point at bone 0, so the sum needs no branches
+	const float* m0 = palette[bones[0]].m;
+	const float* m1 = palette[bones[1]].m;
+	const float* m2 = palette[bones[2]].m;
+	const float* m3 = palette[bones[3]].m;
+
+	for (int i = 0; i < 12; i++)
+		out.m[i] = m0[i] * weights[0] + m1[i] * weights[1] + m2[i] * weights[2] + m3[i] * weights[3];
+
+	return true;
+}
+
+void LinearBlendSkin::Deform(StridedSpan<Vector3> vertices) const {
+	size_t count = std::min(vertices.size(), GetNumVertices());
+
+	BoneMatrix b;
+	for (size_t v = 0; v < count; v++) {
+		if (!Blend(v, b))
+			continue;
+
+		Vector3& p = vertices[v];
+		Vector3 q(
+			b.m[0] * p.x + b.m[1] * p.y + b.m[2] * p.z + b.m[3],
+			b.m[4] * p.x + b.m[5] * p.y + b.m[6] * p.z + b.m[7],
+			b.m[8] * p.x + b.m[9] * p.y + b.m[10] * p.z + b.m[11]);
+		p = q;
+	}
+}
+
+void LinearBlendSkin::DeformInverse(StridedSpan<Vector3> vertices) const {
+	size_t count = std::min(vertices.size(), GetNumVertices());
+
+	BoneMatrix b;
+	float inv[9];
+	for (size_t v = 0; v < count; v++) {
+		if (!Blend(v, b) || !InvertLinear(b.m, inv))
+			continue;
+
+		Vector3& p = vertices[v];
+		float x = p.x - b.m[3];
+		float y = p.y - b.m[7];
+		float z = p.z - b.m[11];
+		p = Vector3(
+			inv[0] * x + inv[1] * y + inv[2] * z,
+			inv[3] * x + inv[4] * y + inv[5] * z,
+			inv[6] * x + inv[7] * y + inv[8] * z);
+	}
+}
+
+void LinearBlendSkin::DeformNormals(StridedSpan<Vector3> normals, const bool inverse) const {
+	size_t count = std::min(normals.size(), GetNumVertices());
+
+	BoneMatrix b;
+	float inv[9];
+	for (size_t v = 0; v < count; v++) {
+		if (!Blend(v, b))
+			continue;
+
+		// Normals follow the inverse transpose of the blended linear part, which keeps them perpendicular
+		// to the surface under non-uniform scale. Going back to skin space that is the transpose itself.
+		const float* m = b.m;
+		float lin[9] = { m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10] };
+		if (!inverse) {
+			if (!InvertLinear(b.m, inv))
+				continue;
+			std::copy(inv, inv + 9, lin);
+		}
+
+		Vector3& n = normals[v];
+		n = Vector3(
+			lin[0] * n.x + lin[3] * n.y + lin[6] * n.z,
+			lin[1] * n.x + lin[4] * n.y + lin[7] * n.z,
+			lin[2] * n.x + lin[5] * n.y + lin[8] * n.z);
+		n.Normalize();
+	}
+}
@@ -0,0 +1,62 @@
+/*
+BodySlide and Outfit Studio
+See the included LICENSE file
+*/
+
+#pragma once
+
+#include "BasicTypes.h"
+#include "Skin.h"
+#include "utils/Object3d.h"
+#include "utils/Span.h"
+
+#include <vector>
+
+class NifFile;
+class NiShape;
+
+// Linear blend skinning of a shape between skin space and global space.
+// The bone palette and a fixed four influences per vertex are gathered once,
+// so deforming is a single pass over the vertices without any lookups.
+class LinearBlendSkin {
+public:
+	static constexpr int MaxInfluences = VertexWeightRows::MaxInfluences;
+
+	// Row-major 3x4 affine matrix
+	struct BoneMatrix {
+		float m[12];
+	};
+
+	// Gathers bone matrices and vertex influences of the shape.
+	// Each bone matrix is the bone's node-to-global transform composed with its skin-to-bone transform,
+	// bones without a node in the file use their skin-to-bone transform alone.
+	// Vertices keep their four strongest weights, normalized to a sum of one.
+	// Returns false if the shape isn't skinned.
+	bool Build(NifFile& nif, NiShape* shape);
+
+	void Clear();
+
+	size_t GetNumVertices() const { return influences.GetNumVertices(); }
+	size_t GetNumBones() const { return palette.size(); }
+
+	const std::vector<BoneMatrix>& GetPalette() const { return palette; }
+	const VertexWeightRows& GetInfluences() const { return influences; }
+
+	// Moves vertices from skin space to global space.
+	// Vertices without weights and anything past GetNumVertices() are left as they are.
+	void Deform(StridedSpan<Vector3> vertices) const;
+
+	// Moves vertices from global space back to skin space
+	void DeformInverse(StridedSpan<Vector3> vertices) const;
+
+	// Transforms normals along with Deform or DeformInverse by the inverse transpose of the blended bone
+	// matrices and renormalizes them. Vertices whose matrix is singular keep their normal.
+	void DeformNormals(StridedSpan<Vector3> normals, const bool inverse = false) const;
+
+private:
+	std::vector<BoneMatrix> palette;
+	VertexWeightRows influences;
+
+	// Weighted sum of the palette matrices of a vertex, false if it has no weights
+	bool Blend(const size_t vertex, BoneMatrix& out) const;
+};
@@ -0,0 +1,305 @@
+/*
+BodySlide and Outfit Studio
+See the included LICENSE file
+*/
+
+#include "VertexCodec.h"
+#include "utils/half.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VERTEX_CODEC_F16C
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(VERTEX_CODEC_F16C) && (defined(__GNUC__) || defined(__clang__))
+#define F16C_TARGET __attribute__((target("avx,f16c")))
+#else
+#define F16C_TARGET
+#endif
+
+static_assert(sizeof(Vector3) == 12, "Vector3 must be tightly packed");
+static_assert(offsetof(BSVertexData, bitangentX) == offsetof(BSVertexData, vert) + 12, "Position and bitangent X must be contiguous");
+static_assert(offsetof(BSVertexData, bitangentY) == offsetof(BSVertexData, normal) + 3, "Normal and bitangent Y must be contiguous");
+static_assert(offsetof(BSVertexData, bitangentZ) == offsetof(BSVertexData, tangent) + 3, "Tangent and bitangent Z must be contiguous");
+
+namespace {
+	bool DetectF16C() {
+#if defined(VERTEX_CODEC_F16C) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+
+		// F16C instructions are VEX encoded and need the OS to save YMM state
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		bool f16c = (info[2] & (1 << 29)) != 0;
+		if (!osxsave || !avx || !f16c)
+			return false;
+
+		return (_xgetbv(0) & 6) == 6;
+#elif defined(VERTEX_CODEC_F16C)
+		return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+#else
+		return false;
+#endif
+	}
+
+	const bool hasF16C = DetectF16C();
+
+	inline float HalfBitsToFloat(ushort bits) {
+		return half_float::detail::half2float<float>(bits);
+	}
+
+	inline ushort FloatToHalfBits(float value) {
+		return half_float::detail::float2half<(std::float_round_style)HALF_ROUND_STYLE>(value);
+	}
+
+#ifdef VERTEX_CODEC_F16C
+	F16C_TARGET void HalfToFloat_F16C(const ushort* src, float* dst, const size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m128i h = _mm_loadu_si128((const __m128i*)(src + i));
+			_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+		}
+
+		for (; i < count; i++)
+			dst[i] = HalfBitsToFloat(src[i]);
+	}
+
+	F16C_TARGET void Half4ToFloat4_F16C(const char* src, const size_t srcStride, char* dst, const size_t dstStride, const size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			__m128i h = _mm_loadl_epi64((const __m128i*)(src + i * srcStride));
+			_mm_storeu_ps((float*)(dst + i * dstStride), _mm_cvtph_ps(h));
+		}
+	}
+
+	F16C_TARGET void Half2ToFloat2_F16C(const char* src, const size_t srcStride, char* dst, const size_t dstStride, const size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			int bits;
+			std::memcpy(&bits, src + i * srcStride, 4);
+			__m128 f = _mm_cvtph_ps(_mm_cvtsi32_si128(bits));
+			_mm_storel_pi((__m64*)(dst + i * dstStride), f);
+		}
+	}
+#endif
+
+	// Converts N halves per element between strided buffers
+	template<int N>
+	void HalfToFloatStrided(const char* src, const size_t srcStride, char* dst, const size_t dstStride, const size_t count) {
+#ifdef VERTEX_CODEC_F16C
+		if (hasF16C) {
+			if (N == 4)
+				Half4ToFloat4_F16C(src, srcStride, dst, dstStride, count);
+			else
+				Half2ToFloat2_F16C(src, srcStride, dst, dstStride, count);
+			return;
+		}
+#endif
+
+		for (size_t i = 0; i < count; i++) {
+			ushort h[N];
+			float f[N];
+			std::memcpy(h, src + i * srcStride, sizeof(h));
+			for (int j = 0; j < N; j++)
+				f[j] = HalfBitsToFloat(h[j]);
+
+			std::memcpy(dst + i * dstStride, f, sizeof(f));
+		}
+	}
+
+	// Encoding always uses the scalar path, F16C rounds ties to even and half_float::half rounds them away from zero
+	template<int N>
+	void FloatToHalfStrided(const char* src, const size_t srcStride, char* dst, const size_t dstStride, const size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			float f[N];
+			ushort h[N];
+			std::memcpy(f, src + i * srcStride, sizeof(f));
+			for (int j = 0; j < N; j++)
+				h[j] = FloatToHalfBits(f[j]);
+
+			std::memcpy(dst + i * dstStride, h, sizeof(h));
+		}
+	}
+
+	template<int N>
+	void CopyStrided(const char* src, const size_t srcStride, char* dst, const size_t dstStride, const size_t count) {
+		for (size_t i = 0; i < count; i++)
+			std::memcpy(dst + i * dstStride, src + i * srcStride, N);
+	}
+
+	// Packed attribute sizes, in stream order
+	constexpr uint AttributeSize(const uint layout, const uint attr) {
+		if (!(layout & attr))
+			return 0;
+
+		switch (attr) {
+			case VL_VERTEX: return (layout & VL_FULLPREC) ? 16 : 8;
+			case VL_UV: return 4;
+			case VL_NORMAL: return 4;
+			case VL_TANGENT: return 4;
+			case VL_COLORS: return 4;
+			case VL_SKINNED: return 12;
+			case VL_EYEDATA: return 4;
+		}
+
+		return 0;
+	}
+
+	constexpr uint AttributeOffset(const uint layout, const uint attr) {
+		uint offset = 0;
+		for (uint a = VL_VERTEX; a < attr; a <<= 1)
+			offset += AttributeSize(layout, a);
+
+		return offset;
+	}
+
+	constexpr uint LayoutSize(const uint layout) {
+		return AttributeOffset(layout, VL_FULLPREC);
+	}
+
+	template<uint L>
+	void DecodeLayout(const char* src, BSVertexData* dst, const size_t count) {
+		constexpr size_t stride = LayoutSize(L);
+		constexpr size_t dstStride = sizeof(BSVertexData);
+		char* out = (char*)dst;
+
+		if constexpr ((L & VL_VERTEX) && (L & VL_FULLPREC))
+			CopyStrided<16>(src + AttributeOffset(L, VL_VERTEX), stride, out + offsetof(BSVertexData, vert), dstStride, count);
+		else if constexpr ((L & VL_VERTEX) != 0)
+			HalfToFloatStrided<4>(src + AttributeOffset(L, VL_VERTEX), stride, out + offsetof(BSVertexData, vert), dstStride, count);
+
+		if constexpr ((L & VL_UV) != 0)
+			HalfToFloatStrided<2>(src + AttributeOffset(L, VL_UV), stride, out + offsetof(BSVertexData, uv), dstStride, count);
+
+		if constexpr ((L & VL_NORMAL) != 0)
+			CopyStrided<4>(src + AttributeOffset(L, VL_NORMAL), stride, out + offsetof(BSVertexData, normal), dstStride, count);
+
+		if constexpr ((L & VL_TANGENT) != 0)
+			CopyStrided<4>(src + AttributeOffset(L, VL_TANGENT), stride, out + offsetof(BSVertexData, tangent), dstStride, count);
+
+		if constexpr ((L & VL_COLORS) != 0)
+			CopyStrided<4>(src + AttributeOffset(L, VL_COLORS), stride, out + offsetof(BSVertexData, colorData), dstStride, count);
+
+		if constexpr ((L & VL_SKINNED) != 0) {
+			HalfToFloatStrided<4>(src + AttributeOffset(L, VL_SKINNED), stride, out + offsetof(BSVertexData, weights), dstStride, count);
+			CopyStrided<4>(src + AttributeOffset(L, VL_SKINNED) + 8, stride, out + offsetof(BSVertexData, weightBones), dstStride, count);
+		}
+
+		if constexpr ((L & VL_EYEDATA) != 0)
+			CopyStrided<4>(src + AttributeOffset(L, VL_EYEDATA), stride, out + offsetof(BSVertexData, eyeData), dstStride, count);
+	}
+
+	template<uint L>
+	void EncodeLayout(const BSVertexData* src, char* dst, const size_t count) {
+		constexpr size_t stride = LayoutSize(L);
+		constexpr size_t srcStride = sizeof(BSVertexData);
+		const char* in = (const char*)src;
+
+		if constexpr ((L & VL_VERTEX) && (L & VL_FULLPREC))
+			CopyStrided<16>(in + offsetof(BSVertexData, vert), srcStride, dst + AttributeOffset(L, VL_VERTEX), stride, count);
+		else if constexpr ((L & VL_VERTEX) != 0)
+			FloatToHalfStrided<4>(in + offsetof(BSVertexData, vert), srcStride, dst + AttributeOffset(L, VL_VERTEX), stride, count);
+
+		if constexpr ((L & VL_UV) != 0)
+			FloatToHalfStrided<2>(in + offsetof(BSVertexData, uv), srcStride, dst + AttributeOffset(L, VL_UV), stride, count);
+
+		if constexpr ((L & VL_NORMAL) != 0)
+			CopyStrided<4>(in + offsetof(BSVertexData, normal), srcStride, dst + AttributeOffset(L, VL_NORMAL), stride, count);
+
+		if constexpr ((L & VL_TANGENT) != 0)
+			CopyStrided<4>(in + offsetof(BSVertexData, tangent), srcStride, dst + AttributeOffset(L, VL_TANGENT), stride, count);
+
+		if constexpr ((L & VL_COLORS) != 0)
+			CopyStrided<4>(in + offsetof(BSVertexData, colorData), srcStride, dst + AttributeOffset(L, VL_COLORS), stride, count);
+
+		if constexpr ((L & VL_SKINNED) != 0) {
+			FloatToHalfStrided<4>(in + offsetof(BSVertexData, weights), srcStride, dst + AttributeOffset(L, VL_SKINNED), stride, count);
+			CopyStrided<4>(in + offsetof(BSVertexData, weightBones), srcStride, dst + AttributeOffset(L, VL_SKINNED) + 8, stride, count);
+		}
+
+		if constexpr ((L & VL_EYEDATA) != 0)
+			CopyStrided<4>(in + offsetof(BSVertexData, eyeData), srcStride, dst + AttributeOffset(L, VL_EYEDATA), stride, count);
+	}
+
+	typedef void (*DecodeFunc)(const char*, BSVertexData*, const size_t);
+	typedef void (*EncodeFunc)(const BSVertexData*, char*, const size_t);
+
+	template<uint... L>
+	constexpr std::array<DecodeFunc, VERTEX_LAYOUT_COUNT> MakeDecoders(std::integer_sequence<uint, L...>) {
+		return { { &DecodeLayout<L>... } };
+	}
+
+	template<uint... L>
+	constexpr std::array<EncodeFunc, VERTEX_LAYOUT_COUNT> MakeEncoders(std::integer_sequence<uint, L...>) {
+		return { { &EncodeLayout<L>... } };
+	}
+
+	constexpr auto decoders = MakeDecoders(std::make_integer_sequence<uint, VERTEX_LAYOUT_COUNT>());
+	constexpr auto encoders = MakeEncoders(std::make_integer_sequence<uint, VERTEX_LAYOUT_COUNT>());
+}
+
+byte GetVertexLayout(VertexDesc& desc, const bool fullPrecision) {
+	byte layout = 0;
+
+	if (desc.HasFlag(VF_VERTEX)) {
+		layout |= VL_VERTEX;
+		if (fullPrecision)
+			layout |= VL_FULLPREC;
+	}
+
+	if (desc.HasFlag(VF_UV))
+		layout |= VL_UV;
+
+	if (desc.HasFlag(VF_NORMAL)) {
+		layout |= VL_NORMAL;
+		if (desc.HasFlag(VF_TANGENT))
+			layout |= VL_TANGENT;
+	}
+
+	if (desc.HasFlag(VF_COLORS))
+		layout |= VL_COLORS;
+
+	if (desc.HasFlag(VF_SKINNED))
+		layout |= VL_SKINNED;
+
+	if (desc.HasFlag(VF_EYEDATA))
+		layout |= VL_EYEDATA;
+
+	return layout;
+}
+
+uint GetVertexLayoutSize(const byte layout) {
+	return LayoutSize(layout);
+}
+
+void DecodeVertices(const byte layout, const char* src, BSVertexData* dst, const size_t count) {
+	decoders[layout](src, dst, count);
+}
+
+void EncodeVertices(const byte layout, const BSVertexData* src, char* dst, const size_t count) {
+	encoders[layout](src, dst, count);
+}
+
+void HalfToFloat(const ushort* src, float* dst, const size_t count) {
+#ifdef VERTEX_CODEC_F16C
+	if (hasF16C) {
+		HalfToFloat_F16C(src, dst, count);
+		return;
+	}
+#endif
+
+	for (size_t i = 0; i < count; i++)
+		dst[i] = HalfBitsToFloat(src[i]);
+}
+
+void FloatToHalf(const float* src, ushort* dst, const size_t count) {
+	for (size_t i = 0; i < count; i++)
+		dst[i] = FloatToHalfBits(src[i]);
+}
@@ -0,0 +1,42 @@
+/*
+BodySlide and Outfit Studio
+See the included LICENSE file
+*/
+
+#pragma once
+
+#include "VertexData.h"
+
+// Attribute set of a packed BSTriShape vertex stream.
+// Unlike VertexFlags this also encodes whether positions are stored in full precision.
+enum VertexLayout : byte {
+	VL_VERTEX = 1 << 0,
+	VL_UV = 1 << 1,
+	VL_NORMAL = 1 << 2,
+	VL_TANGENT = 1 << 3,
+	VL_COLORS = 1 << 4,
+	VL_SKINNED = 1 << 5,
+	VL_EYEDATA = 1 << 6,
+	VL_FULLPREC = 1 << 7
+};
+
+const uint VERTEX_LAYOUT_COUNT = 1 << 8;
+
+// Returns the stream layout for a vertex description.
+// Tangents are only stored together with normals, full precision only applies to positions.
+byte GetVertexLayout(VertexDesc& desc, const bool fullPrecision);
+
+// Size in bytes of a single packed vertex with the given layout
+uint GetVertexLayoutSize(const byte layout);
+
+// Decodes count packed vertices from src into dst
+void DecodeVertices(const byte layout, const char* src, BSVertexData* dst, const size_t count);
+
+// Encodes count vertices from src into packed vertices at dst
+void EncodeVertices(const byte layout, const BSVertexData* src, char* dst, const size_t count);
+
+// Converts contiguous half-precision values to single-precision
+void HalfToFloat(const ushort* src, float* dst, const size_t count);
+
+// Converts contiguous single-precision values to half-precision, rounding like half_float::half
+void FloatToHalf(const float* src, ushort* dst, const size_t count);
@@ -17,8 +17,8 @@ void NiCollisionObject::Put(NiStream& stream) {
 	targetRef.Put(stream);
 }
 
-void NiCollisionObject::GetPtrs(std::set<Ref*>& ptrs) {
-	NiObject::GetPtrs(ptrs);
+void NiCollisionObject::VisitPtrs(RefSink<Ref>& ptrs) {
+	NiObject::VisitPtrs(ptrs);
 
 	ptrs.insert(&targetRef);
 }
@@ -118,8 +118,8 @@ void bhkNiCollisionObject::Put(NiStream& stream) {
 	bodyRef.Put(stream);
 }
 
-void bhkNiCollisionObject::GetChildRefs(std::set<Ref*>& refs) {
-	NiCollisionObject::GetChildRefs(refs);
+void bhkNiCollisionObject::VisitChildRefs(RefSink<Ref>& refs) {
+	NiCollisionObject::VisitChildRefs(refs);
 
 	refs.insert(&bodyRef);
 }
@@ -272,8 +272,7 @@ void bhkMultiSphereShape::Get(NiStream& stream) {
 
 	stream >> numSpheres;
 	spheres.resize(numSpheres);
-	for (int i = 0; i < numSpheres; i++)
-		stream >> spheres[i];
+	stream.readArray(spheres.data(), numSpheres);
 }
 
 void bhkMultiSphereShape::Put(NiStream& stream) {
@@ -283,8 +282,7 @@ void bhkMultiSphereShape::Put(NiStream& stream) {
 	stream << unkFloat2;
 
 	stream << numSpheres;
-	for (int i = 0; i < numSpheres; i++)
-		stream << spheres[i];
+	stream.writeArray(spheres.data(), numSpheres);
 }
 
 
@@ -314,8 +312,8 @@ void bhkConvexListShape::Put(NiStream& stream) {
 	stream << unkFloat2;
 }
 
-void bhkConvexListShape::GetChildRefs(std::set<Ref*>& refs) {
-	bhkShape::GetChildRefs(refs);
+void bhkConvexListShape::VisitChildRefs(RefSink<Ref>& refs) {
+	bhkShape::VisitChildRefs(refs);
 
 	shapeRefs.GetIndexPtrs(refs);
 }
@@ -339,13 +337,11 @@ void bhkConvexVerticesShape::Get(NiStream& stream) {
 
 	stream >> numVerts;
 	verts.resize(numVerts);
-	for (int i = 0; i < numVerts; i++)
-		stream >> verts[i];
+	stream.readArray(verts.data(), numVerts);
 
 	stream >> numNormals;
 	normals.resize(numNormals);
-	for (int i = 0; i < numNormals; i++)
-		stream >> normals[i];
+	stream.readArray(normals.data(), numNormals);
 }
 
 void bhkConvexVerticesShape::Put(NiStream& stream) {
@@ -355,12 +351,10 @@ void bhkConvexVerticesShape::Put(NiStream& stream) {
 	stream << normalsProp;
 
 	stream << numVerts;
-	for (int i = 0; i < numVerts; i++)
-		stream << verts[i];
+	stream.writeArray(verts.data(), numVerts);
 
 	stream << numNormals;
-	for (int i = 0; i < numNormals; i++)
-		stream << normals[i];
+	stream.writeArray(normals.data(), numNormals);
 }
 
 
@@ -401,8 +395,8 @@ void bhkTransformShape::Put(NiStream& stream) {
 	stream << xform;
 }
 
-void bhkTransformShape::GetChildRefs(std::set<Ref*>& refs) {
-	bhkShape::GetChildRefs(refs);
+void bhkTransformShape::VisitChildRefs(RefSink<Ref>& refs) {
+	bhkShape::VisitChildRefs(refs);
 
 	refs.insert(&shapeRef);
 }
@@ -450,8 +444,7 @@ void bhkMoppBvTreeShape::Get(NiStream& stream) {
 		stream >> buildType;
 
 	data.resize(dataSize);
-	for (int i = 0; i < dataSize; i++)
-		stream >> data[i];
+	stream.readArray(data.data(), dataSize);
 }
 
 void bhkMoppBvTreeShape::Put(NiStream& stream) {
@@ -468,12 +461,11 @@ void bhkMoppBvTreeShape::Put(NiStream& stream) {
 	if (stream.GetVersion().User() >= 12)
 		stream << buildType;
 
-	for (int i = 0; i < dataSize; i++)
-		stream << data[i];
+	stream.writeArray(data.data(), dataSize);
 }
 
-void bhkMoppBvTreeShape::GetChildRefs(std::set<Ref*>& refs) {
-	bhkBvTreeShape::GetChildRefs(refs);
+void bhkMoppBvTreeShape::VisitChildRefs(RefSink<Ref>& refs) {
+	bhkBvTreeShape::VisitChildRefs(refs);
 
 	refs.insert(&shapeRef);
 }
@@ -503,8 +495,7 @@ void bhkNiTriStripsShape::Get(NiStream& stream) {
 
 	stream >> numFilters;
 	filters.resize(numFilters);
-	for (int i = 0; i < numFilters; i++)
-		stream >> filters[i];
+	stream.readArray(filters.data(), numFilters);
 }
 
 void bhkNiTriStripsShape::Put(NiStream& stream) {
@@ -523,12 +514,11 @@ void bhkNiTriStripsShape::Put(NiStream& stream) {
 	partRefs.Put(stream);
 
 	stream << numFilters;
-	for (int i = 0; i < numFilters; i++)
-		stream << filters[i];
+	stream.writeArray(filters.data(), numFilters);
 }
 
-void bhkNiTriStripsShape::GetChildRefs(std::set<Ref*>& refs) {
-	bhkShape::GetChildRefs(refs);
+void bhkNiTriStripsShape::VisitChildRefs(RefSink<Ref>& refs) {
+	bhkShape::VisitChildRefs(refs);
 
 	partRefs.GetIndexPtrs(refs);
 }
@@ -556,8 +546,7 @@ void bhkListShape::Get(NiStream& stream) {
 	stream >> numUnkInts;
 	unkInts.resize(numUnkInts);
 
-	for (int i = 0; i < numUnkInts; i++)
-		stream >> unkInts[i];
+	stream.readArray(unkInts.data(), numUnkInts);
 }
 
 void bhkListShape::Put(NiStream& stream) {
@@ -570,12 +559,11 @@ void bhkListShape::Put(NiStream& stream) {
 	stream << childFilterProp;
 
 	stream << numUnkInts;
-	for (int i = 0; i < numUnkInts; i++)
-		stream << unkInts[i];
+	stream.writeArray(unkInts.data(), numUnkInts);
 }
 
-void bhkListShape::GetChildRefs(std::set<Ref*>& refs) {
-	bhkShapeCollection::GetChildRefs(refs);
+void bhkListShape::VisitChildRefs(RefSink<Ref>& refs) {
+	bhkShapeCollection::VisitChildRefs(refs);
 
 	subShapeRefs.GetIndexPtrs(refs);
 }
@@ -598,13 +586,11 @@ void hkPackedNiTriStripsData::Get(NiStream& stream) {
 
 	if (stream.GetVersion().Stream() > 11) {
 		triData.resize(keyCount);
-		for (int i = 0; i < keyCount; i++)
-			stream >> triData[i];
+		stream.readArray(triData.data(), keyCount);
 	}
 	else {
 		triNormData.resize(keyCount);
-		for (int i = 0; i < keyCount; i++)
-			stream >> triNormData[i];
+		stream.readArray(triNormData.data(), keyCount);
 	}
 
 	stream >> numVerts;
@@ -613,14 +599,12 @@ void hkPackedNiTriStripsData::Get(NiStream& stream) {
 		stream >> unkByte;
 
 	compressedVertData.resize(numVerts);
-	for (int i = 0; i < numVerts; i++)
-		stream >> compressedVertData[i];
+	stream.readArray(compressedVertData.data(), numVerts);
 
 	if (stream.GetVersion().Stream() > 11) {
 		stream >> partCount;
 		data.resize(partCount);
-		for (int i = 0; i < partCount; i++)
-			stream >> data[i];
+		stream.readArray(data.data(), partCount);
 	}
 }
 
@@ -630,12 +614,10 @@ void hkPackedNiTriStripsData::Put(NiStream& stream) {
 	stream << keyCount;
 
 	if (stream.GetVersion().Stream() > 11) {
-		for (int i = 0; i < keyCount; i++)
-			stream << triData[i];
+		stream.writeArray(triData.data(), keyCount);
 	}
 	else {
-		for (int i = 0; i < keyCount; i++)
-			stream << triNormData[i];
+		stream.writeArray(triNormData.data(), keyCount);
 	}
 
 	stream << numVerts;
@@ -643,13 +625,11 @@ void hkPackedNiTriStripsData::Put(NiStream& stream) {
 	if (stream.GetVersion().Stream() > 11)
 		stream << unkByte;
 
-	for (int i = 0; i < numVerts; i++)
-		stream << compressedVertData[i];
+	stream.writeArray(compressedVertData.data(), numVerts);
 
 	if (stream.GetVersion().Stream() > 11) {
 		stream << partCount;
-		for (int i = 0; i < partCount; i++)
-			stream << data[i];
+		stream.writeArray(data.data(), partCount);
 	}
 }
 
@@ -660,8 +640,7 @@ void bhkPackedNiTriStripsShape::Get(NiStream& stream) {
 	if (stream.GetVersion().Stream() <= 11) {
 		stream >> partCount;
 		data.resize(partCount);
-		for (int i = 0; i < partCount; i++)
-			stream >> data[i];
+		stream.readArray(data.data(), partCount);
 	}
 
 	stream >> userData;
@@ -679,8 +658,7 @@ void bhkPackedNiTriStripsShape::Put(NiStream& stream) {
 
 	if (stream.GetVersion().Stream() <= 11) {
 		stream << partCount;
-		for (int i = 0; i < partCount; i++)
-			stream << data[i];
+		stream.writeArray(data.data(), partCount);
 	}
 
 	stream << userData;
@@ -693,8 +671,8 @@ void bhkPackedNiTriStripsShape::Put(NiStream& stream) {
 	dataRef.Put(stream);
 }
 
-void bhkPackedNiTriStripsShape::GetChildRefs(std::set<Ref*>& refs) {
-	bhkShapeCollection::GetChildRefs(refs);
+void bhkPackedNiTriStripsShape::VisitChildRefs(RefSink<Ref>& refs) {
+	bhkShapeCollection::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -759,8 +737,8 @@ void bhkOrientHingedBodyAction::Put(NiStream& stream) {
 	stream << padding2;
 }
 
-void bhkOrientHingedBodyAction::GetPtrs(std::set<Ref*>& ptrs) {
-	bhkSerializable::GetPtrs(ptrs);
+void bhkOrientHingedBodyAction::VisitPtrs(RefSink<Ref>& ptrs) {
+	bhkSerializable::VisitPtrs(ptrs);
 
 	ptrs.insert(&bodyRef);
 }
@@ -788,8 +766,8 @@ void bhkWorldObject::Put(NiStream& stream) {
 	stream << prop;
 }
 
-void bhkWorldObject::GetChildRefs(std::set<Ref*>& refs) {
-	bhkSerializable::GetChildRefs(refs);
+void bhkWorldObject::VisitChildRefs(RefSink<Ref>& refs) {
+	bhkSerializable::VisitChildRefs(refs);
 
 	refs.insert(&shapeRef);
 }
@@ -849,8 +827,8 @@ void bhkConstraint::Put(NiStream& stream) {
 	stream << priority;
 }
 
-void bhkConstraint::GetPtrs(std::set<Ref*>& ptrs) {
-	bhkSerializable::GetPtrs(ptrs);
+void bhkConstraint::VisitPtrs(RefSink<Ref>& ptrs) {
+	bhkSerializable::VisitPtrs(ptrs);
 
 	entityRefs.GetIndexPtrs(ptrs);
 }
@@ -1012,7 +990,7 @@ void ConstraintData::Put(NiStream& stream) {
 	stream << strength;
 }
 
-void ConstraintData::GetPtrs(std::set<Ref*>& ptrs) {
+void ConstraintData::VisitPtrs(RefSink<Ref>& ptrs) {
 	entityRefs.GetIndexPtrs(ptrs);
 }
 
@@ -1035,10 +1013,10 @@ void bhkBreakableConstraint::Put(NiStream& stream) {
 	stream << removeWhenBroken;
 }
 
-void bhkBreakableConstraint::GetPtrs(std::set<Ref*>& ptrs) {
-	bhkConstraint::GetPtrs(ptrs);
+void bhkBreakableConstraint::VisitPtrs(RefSink<Ref>& ptrs) {
+	bhkConstraint::VisitPtrs(ptrs);
 
-	subConstraint.GetPtrs(ptrs);
+	subConstraint.VisitPtrs(ptrs);
 }
 
 
@@ -1168,8 +1146,7 @@ void bhkBallSocketConstraintChain::Get(NiStream& stream) {
 
 	stream >> numPivots;
 	pivots.resize(numPivots);
-	for (int i = 0; i < numPivots; i++)
-		stream >> pivots[i];
+	stream.readArray(pivots.data(), numPivots);
 
 	stream >> tau;
 	stream >> damping;
@@ -1204,8 +1181,8 @@ void bhkBallSocketConstraintChain::Put(NiStream& stream) {
 	stream << priority;
 }
 
-void bhkBallSocketConstraintChain::GetPtrs(std::set<Ref*>& ptrs) {
-	bhkSerializable::GetPtrs(ptrs);
+void bhkBallSocketConstraintChain::VisitPtrs(RefSink<Ref>& ptrs) {
+	bhkSerializable::VisitPtrs(ptrs);
 
 	entityARefs.GetIndexPtrs(ptrs);
 	ptrs.insert(&entityARef);
@@ -1345,8 +1322,8 @@ void bhkRigidBody::Put(NiStream& stream) {
 		stream << unkShort3;
 }
 
-void bhkRigidBody::GetChildRefs(std::set<Ref*>& refs) {
-	bhkEntity::GetChildRefs(refs);
+void bhkRigidBody::VisitChildRefs(RefSink<Ref>& refs) {
+	bhkEntity::VisitChildRefs(refs);
 
 	constraintRefs.GetIndexPtrs(refs);
 }
@@ -1377,35 +1354,29 @@ void bhkCompressedMeshShapeData::Get(NiStream& stream) {
 
 	stream >> numMat32;
 	mat32.resize(numMat32);
-	for (int i = 0; i < numMat32; i++)
-		stream >> mat32[i];
+	stream.readArray(mat32.data(), numMat32);
 
 	stream >> numMat16;
 	mat16.resize(numMat16);
-	for (int i = 0; i < numMat16; i++)
-		stream >> mat16[i];
+	stream.readArray(mat16.data(), numMat16);
 
 	stream >> numMat8;
 	mat8.resize(numMat8);
-	for (int i = 0; i < numMat8; i++)
-		stream >> mat8[i];
+	stream.readArray(mat8.data(), numMat8);
 
 	stream >> numMaterials;
 	materials.resize(numMaterials);
-	for (int i = 0; i < numMaterials; i++)
-		stream >> materials[i];
+	stream.readArray(materials.data(), numMaterials);
 
 	stream >> numNamedMat;
 
 	stream >> numTransforms;
 	transforms.resize(numTransforms);
-	for (int i = 0; i < numTransforms; i++)
-		stream >> transforms[i];
+	stream.readArray(transforms.data(), numTransforms);
 
 	stream >> numBigVerts;
 	bigVerts.resize(numBigVerts);
-	for (int i = 0; i < numBigVerts; i++)
-		stream >> bigVerts[i];
+	stream.readArray(bigVerts.data(), numBigVerts);
 
 	stream >> numBigTris;
 	bigTris.resize(numBigTris);
@@ -1422,23 +1393,19 @@ void bhkCompressedMeshShapeData::Get(NiStream& stream) {
 
 		stream >> chunks[i].numVerts;
 		chunks[i].verts.resize(chunks[i].numVerts);
-		for (int j = 0; j < chunks[i].numVerts; j++)
-			stream >> chunks[i].verts[j];
+		stream.readArray(chunks[i].verts.data(), chunks[i].numVerts);
 
 		stream >> chunks[i].numIndices;
 		chunks[i].indices.resize(chunks[i].numIndices);
-		for (int j = 0; j < chunks[i].numIndices; j++)
-			stream >> chunks[i].indices[j];
+		stream.readArray(chunks[i].indices.data(), chunks[i].numIndices);
 
 		stream >> chunks[i].numStrips;
 		chunks[i].strips.resize(chunks[i].numStrips);
-		for (int j = 0; j < chunks[i].numStrips; j++)
-			stream >> chunks[i].strips[j];
+		stream.readArray(chunks[i].strips.data(), chunks[i].numStrips);
 
 		stream >> chunks[i].numWeldingInfo;
 		chunks[i].weldingInfo.resize(chunks[i].numWeldingInfo);
-		for (int j = 0; j < chunks[i].numWeldingInfo; j++)
-			stream >> chunks[i].weldingInfo[j];
+		stream.readArray(chunks[i].weldingInfo.data(), chunks[i].numWeldingInfo);
 	}
 
 	stream >> numConvexPieceA;
@@ -1458,30 +1425,24 @@ void bhkCompressedMeshShapeData::Put(NiStream& stream) {
 	stream << materialType;
 
 	stream << numMat32;
-	for (int i = 0; i < numMat32; i++)
-		stream << mat32[i];
+	stream.writeArray(mat32.data(), numMat32);
 
 	stream << numMat16;
-	for (int i = 0; i < numMat16; i++)
-		stream << mat16[i];
+	stream.writeArray(mat16.data(), numMat16);
 
 	stream << numMat8;
-	for (int i = 0; i < numMat8; i++)
-		stream << mat8[i];
+	stream.writeArray(mat8.data(), numMat8);
 
 	stream << numMaterials;
-	for (int i = 0; i < numMaterials; i++)
-		stream << materials[i];
+	stream.writeArray(materials.data(), numMaterials);
 
 	stream << numNamedMat;
 
 	stream << numTransforms;
-	for (int i = 0; i < numTransforms; i++)
-		stream << transforms[i];
+	stream.writeArray(transforms.data(), numTransforms);
 
 	stream << numBigVerts;
-	for (int i = 0; i < numBigVerts; i++)
-		stream << bigVerts[i];
+	stream.writeArray(bigVerts.data(), numBigVerts);
 
 	stream << numBigTris;
 	for (int i = 0; i < numBigTris; i++)
@@ -1495,20 +1456,16 @@ void bhkCompressedMeshShapeData::Put(NiStream& stream) {
 		stream << chunks[i].transformIndex;
 
 		stream << chunks[i].numVerts;
-		for (int j = 0; j < chunks[i].numVerts; j++)
-			stream << chunks[i].verts[j];
+		stream.writeArray(chunks[i].verts.data(), chunks[i].numVerts);
 
 		stream << chunks[i].numIndices;
-		for (int j = 0; j < chunks[i].numIndices; j++)
-			stream << chunks[i].indices[j];
+		stream.writeArray(chunks[i].indices.data(), chunks[i].numIndices);
 
 		stream << chunks[i].numStrips;
-		for (int j = 0; j < chunks[i].numStrips; j++)
-			stream << chunks[i].strips[j];
+		stream.writeArray(chunks[i].strips.data(), chunks[i].numStrips);
 
 		stream << chunks[i].numWeldingInfo;
-		for (int j = 0; j < chunks[i].numWeldingInfo; j++)
-			stream << chunks[i].weldingInfo[j];
+		stream.writeArray(chunks[i].weldingInfo.data(), chunks[i].numWeldingInfo);
 	}
 
 	stream << numConvexPieceA;
@@ -1541,8 +1498,8 @@ void bhkCompressedMeshShape::Put(NiStream& stream) {
 	dataRef.Put(stream);
 }
 
-void bhkCompressedMeshShape::GetChildRefs(std::set<Ref*>& refs) {
-	bhkShape::GetChildRefs(refs);
+void bhkCompressedMeshShape::VisitChildRefs(RefSink<Ref>& refs) {
+	bhkShape::VisitChildRefs(refs);
 
 	refs.insert(&dataRef);
 }
@@ -1553,8 +1510,8 @@ void bhkCompressedMeshShape::GetChildIndices(std::vector<int>& indices) {
 	indices.push_back(dataRef.GetIndex());
 }
 
-void bhkCompressedMeshShape::GetPtrs(std::set<Ref*>& ptrs) {
-	bhkShape::GetPtrs(ptrs);
+void bhkCompressedMeshShape::VisitPtrs(RefSink<Ref>& ptrs) {
+	bhkShape::VisitPtrs(ptrs);
 
 	ptrs.insert(&targetRef);
 }
@@ -1586,8 +1543,8 @@ void bhkPoseArray::Put(NiStream& stream) {
 		poses[i].Put(stream);
 }
 
-void bhkPoseArray::GetStringRefs(std::set<StringRef*>& refs) {
-	NiObject::GetStringRefs(refs);
+void bhkPoseArray::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiObject::VisitStringRefs(refs);
 
 	for (auto &b : bones)
 		refs.insert(&b);
@@ -1608,8 +1565,8 @@ void bhkRagdollTemplate::Put(NiStream& stream) {
 	boneRefs.Put(stream);
 }
 
-void bhkRagdollTemplate::GetChildRefs(std::set<Ref*>& refs) {
-	NiExtraData::GetChildRefs(refs);
+void bhkRagdollTemplate::VisitChildRefs(RefSink<Ref>& refs) {
+	NiExtraData::VisitChildRefs(refs);
 
 	boneRefs.GetIndexPtrs(refs);
 }
@@ -1656,8 +1613,8 @@ void bhkRagdollTemplateData::Put(NiStream& stream) {
 		constraints[i].Put(stream);
 }
 
-void bhkRagdollTemplateData::GetStringRefs(std::set<StringRef*>& refs) {
-	NiObject::GetStringRefs(refs);
+void bhkRagdollTemplateData::VisitStringRefs(RefSink<StringRef>& refs) {
+	NiObject::VisitStringRefs(refs);
 
 	refs.insert(&name);
 }
@@ -269,7 +269,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	NiCollisionObject* Clone() { return new NiCollisionObject(*this); }
 };
 
@@ -382,7 +382,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	bhkNiCollisionObject* Clone() { return new bhkNiCollisionObject(*this); }
 };
@@ -559,7 +559,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	bhkConvexListShape* Clone() { return new bhkConvexListShape(*this); }
 
@@ -623,7 +623,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	bhkTransformShape* Clone() { return new bhkTransformShape(*this); }
 };
@@ -674,7 +674,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	bhkMoppBvTreeShape* Clone() { return new bhkMoppBvTreeShape(*this); }
 };
@@ -704,7 +704,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	bhkNiTriStripsShape* Clone() { return new bhkNiTriStripsShape(*this); }
 
@@ -729,7 +729,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	bhkListShape* Clone() { return new bhkListShape(*this); }
 
@@ -795,7 +795,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	bhkPackedNiTriStripsShape* Clone() { return new bhkPackedNiTriStripsShape(*this); }
 };
@@ -837,7 +837,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	bhkOrientHingedBodyAction* Clone() { return new bhkOrientHingedBodyAction(*this); }
 };
 
@@ -853,7 +853,7 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	bhkWorldObject* Clone() { return new bhkWorldObject(*this); }
 };
@@ -904,7 +904,7 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 
 	BlockRefArray<bhkEntity>& GetEntities();
 };
@@ -953,7 +953,7 @@ private:
 public:
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 
 	BlockRefArray<bhkEntity>& GetEntities();
 };
@@ -969,7 +969,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	bhkBreakableConstraint* Clone() { return new bhkBreakableConstraint(*this); }
 };
 
@@ -1061,7 +1061,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	bhkBallSocketConstraintChain* Clone() { return new bhkBallSocketConstraintChain(*this); }
 
 	BlockRefArray<bhkEntity>& GetEntitiesA();
@@ -1126,7 +1126,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	bhkRigidBody* Clone() { return new bhkRigidBody(*this); }
 
@@ -1205,9 +1205,9 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
-	void GetPtrs(std::set<Ref*>& ptrs);
+	void VisitPtrs(RefSink<Ref>& ptrs);
 	bhkCompressedMeshShape* Clone() { return new bhkCompressedMeshShape(*this); }
 };
 
@@ -1249,7 +1249,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
 	bhkPoseArray* Clone() { return new bhkPoseArray(*this); }
 };
 
@@ -1264,7 +1264,7 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetChildRefs(std::set<Ref*>& refs);
+	void VisitChildRefs(RefSink<Ref>& refs);
 	void GetChildIndices(std::vector<int>& indices);
 	bhkRagdollTemplate* Clone() { return new bhkRagdollTemplate(*this); }
 
@@ -1288,6 +1288,6 @@ public:
 
 	void Get(NiStream& stream);
 	void Put(NiStream& stream);
-	void GetStringRefs(std::set<StringRef*>& refs);
+	void VisitStringRefs(RefSink<StringRef>& refs);
 	bhkRagdollTemplateData* Clone() { return new bhkRagdollTemplateData(*this); }
 };
@@ -0,0 +1,188 @@
+/*
+BodySlide and Outfit Studio
+See the included LICENSE file
+*/
+
+#include "LegacySkinPartitions.h"
+
+#include <limits>
+#include <set>
+#include <unordered_map>
+
+// UpdateSkinPartitions as it was before the rewrite with flat arrays and bone bitsets,
+// kept unchanged apart from types so the check can compare the two.
+void LegacyUpdateSkinPartitions(NifFile& nif, NiShape* shape) {
+	auto& hdr = nif.GetHeader();
+	NiSkinData* skinData = nullptr;
+	NiSkinPartition* skinPart = nullptr;
+	auto skinInst = hdr.GetBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
+	if (skinInst) {
+		skinData = hdr.GetBlock<NiSkinData>(skinInst->GetDataRef());
+		skinPart = hdr.GetBlock<NiSkinPartition>(skinInst->GetSkinPartitionRef());
+
+		if (!skinData || !skinPart)
+			return;
+	}
+	else
+		return;
+
+	std::vector<Triangle> tris;
+	if (!shape->GetTriangles(tris))
+		return;
+
+	auto bsdSkinInst = dynamic_cast<BSDismemberSkinInstance*>(skinInst);
+	auto bsTriShape = dynamic_cast<BSTriShape*>(shape);
+	if (bsTriShape)
+		bsTriShape->CalcDataSizes(hdr.GetVersion());
+
+	// Align triangles for comparisons
+	for (auto &t : tris)
+		t.rot();
+
+	// Make maps of vertices to bones and weights
+	std::unordered_map<ushort, std::vector<SkinWeight>> vertBoneWeights;
+	int boneIndex = 0;
+	for (auto &bone : skinData->bones) {
+		for (auto &bw : bone.vertexWeights)
+			vertBoneWeights[bw.index].push_back(SkinWeight(boneIndex, bw.weight));
+
+		boneIndex++;
+	}
+
+	// Sort weights and corresponding bones
+	for (auto &bw : vertBoneWeights)
+		sort(bw.second.begin(), bw.second.end(), BoneWeightsSort());
+
+	// Enforce maximum vertex bone weight count
+	size_t maxBonesPerVertex = 4;
+
+	for (auto &bw : vertBoneWeights)
+		if (bw.second.size() > maxBonesPerVertex)
+			bw.second.resize(maxBonesPerVertex);
+
+	skinPart->PrepareTriParts(tris);
+	std::vector<int> &triParts = skinPart->triParts;
+
+	size_t maxBonesPerPartition = std::numeric_limits<size_t>::max();
+	if (hdr.GetVersion().IsFO3())
+		maxBonesPerPartition = 18;
+	else if (hdr.GetVersion().IsSSE())
+		maxBonesPerPartition = 80;
+
+	// Make a list of the bones used by each partition.  If any partition
+	// has too many bones, split it.
+	std::vector<std::set<int>> partBones(skinPart->partitions.size());
+	for (int triIndex = 0; triIndex < (int)tris.size(); ++triIndex) {
+		int partInd = triParts[triIndex];
+		if (partInd < 0)
+			continue;
+
+		Triangle tri = tris[triIndex];
+
+		// Get associated bones for the current tri
+		std::set<int> triBones;
+		for (int i = 0; i < 3; i++)
+			for (auto &tb : vertBoneWeights[tri[i]])
+				triBones.insert(tb.index);
+
+		// How many new bones are in the tri's bone list?
+		size_t newBoneCount = 0;
+		for (auto &tb : triBones)
+			if (partBones[partInd].find(tb) == partBones[partInd].end())
+				newBoneCount++;
+
+		if (partBones[partInd].size() + newBoneCount > maxBonesPerPartition) {
+			// Too many bones for this partition, make a new partition starting with this triangle
+			for (int j = 0; j < (int)tris.size(); ++j)
+				if (triParts[j] > partInd || (j >= triIndex && triParts[j] >= partInd))
+					++triParts[j];
+
+			partBones.insert(partBones.begin() + partInd + 1, std::set<int>());
+
+			if (bsdSkinInst) {
+				auto partInfo = bsdSkinInst->GetPartitions();
+
+				BSDismemberSkinInstance::PartitionInfo info;
+				info.flags = PF_EDITOR_VISIBLE;
+				info.partID = partInfo[partInd].partID;
+				partInfo.insert(partInfo.begin() + partInd + 1, info);
+
+				bsdSkinInst->SetPartitions(partInfo);
+			}
+
+			++partInd;
+		}
+
+		partBones[partInd].insert(triBones.begin(), triBones.end());
+	}
+
+	// Re-create partitions
+	BlockVector<NiSkinPartition::PartitionBlock> partitions(partBones.size(), skinPart->partitions.get_allocator());
+	for (size_t partInd = 0; partInd < partBones.size(); partInd++) {
+		NiSkinPartition::PartitionBlock &part = partitions[partInd];
+		part.hasBoneIndices = true;
+		part.hasFaces = true;
+		part.hasVertexMap = true;
+		part.hasVertexWeights = true;
+		part.numWeightsPerVertex = maxBonesPerVertex;
+	}
+	skinPart->numPartitions = partitions.size();
+	skinPart->partitions = std::move(partitions);
+
+	// Re-create trueTriangles, vertexMap, and triangles for each partition
+	skinPart->GenerateTrueTrianglesFromTriParts(tris);
+	skinPart->PrepareVertexMapsAndTriangles();
+
+	for (uint partInd = 0; partInd < skinPart->numPartitions; ++partInd) {
+		NiSkinPartition::PartitionBlock &part = skinPart->partitions[partInd];
+
+		// Copy relevant data from shape to partition
+		if (bsTriShape)
+			part.vertexDesc = bsTriShape->vertexDesc;
+
+		std::unordered_map<int, int> boneLookup;
+		boneLookup.reserve(partBones[partInd].size());
+		part.numBones = partBones[partInd].size();
+		part.bones.reserve(part.numBones);
+
+		for (auto &b : partBones[partInd]) {
+			part.bones.push_back(b);
+			boneLookup[b] = part.bones.size() - 1;
+		}
+
+		for (auto &v : part.vertexMap) {
+			BoneIndices b;
+			VertexWeight vw;
+
+			byte* pb = &b.i1;
+			float* pw = &vw.w1;
+
+			float tot = 0.0f;
+			for (size_t bi = 0; bi < vertBoneWeights[v].size(); bi++) {
+				if (bi == 4)
+					break;
+
+				pb[bi] = boneLookup[vertBoneWeights[v][bi].index];
+				pw[bi] = vertBoneWeights[v][bi].weight;
+				tot += pw[bi];
+			}
+
+			if (tot != 0.0f)
+				for (int bi = 0; bi < 4; bi++)
+					pw[bi] /= tot;
+
+			part.boneIndices.push_back(b);
+			part.vertexWeights.push_back(vw);
+		}
+	}
+
+	if (bsTriShape) {
+		skinPart->numVertices = bsTriShape->GetNumVertices();
+		skinPart->dataSize = bsTriShape->dataSize;
+		skinPart->vertexSize = bsTriShape->vertexSize;
+		skinPart->vertData = bsTriShape->vertData;
+		skinPart->vertexDesc = bsTriShape->vertexDesc;
+	}
+
+	nif.UpdatePartitionFlags(shape);
+}
@@ -0,0 +1,11 @@
+/*
+BodySlide and Outfit Studio
+See the included LICENSE file
+*/
+
+#pragma once
+
+#include "NifFile.h"
+
+// The previous implementation of NifFile::UpdateSkinPartitions
+void LegacyUpdateSkinPartitions(NifFile& nif, NiShape* shape);
@@ -0,0 +1,239 @@
+/*
+BodySlide and Outfit Studio
+See the included LICENSE file
+*/
+
+// Builds skinned meshes, partitions them with both the current and the legacy
+// UpdateSkinPartitions and reports the first difference in their output.
+
+#include "LegacySkinPartitions.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+
+struct CheckCase {
+	const char* name;
+	NiVersion version;
+	bool bsTriShape;
+	int grid;
+	int numBones;
+	int numParts;
+};
+
+std::string SaveToString(NifFile& nif) {
+	std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+	nif.Save(stream);
+	return stream.str();
+}
+
+// A grid of vertices with up to six random weights each, enough bones to force
+// the per-partition bone limits and a number of dismember partitions
+NifFile CreateSkinnedMesh(const CheckCase& c, const unsigned int seed) {
+	NifFile nif;
+	NiVersion version = c.version;
+	version.SetFile(V20_2_0_7);
+	nif.Create(version);
+
+	std::vector<Vector3> verts;
+	std::vector<Vector2> uvs;
+	std::vector<Vector3> norms;
+	for (int y = 0; y < c.grid; y++) {
+		for (int x = 0; x < c.grid; x++) {
+			verts.emplace_back(x, y, std::sin(x * 0.3f));
+			uvs.emplace_back(x / float(c.grid), y / float(c.grid));
+			norms.emplace_back(0.0f, 0.0f, 1.0f);
+		}
+	}
+
+	std::vector<Triangle> tris;
+	for (int y = 0; y + 1 < c.grid; y++) {
+		for (int x = 0; x + 1 < c.grid; x++) {
+			int i = y * c.grid + x;
+			tris.emplace_back(i, i + 1, i + c.grid);
+			tris.emplace_back(i + 1, i + c.grid + 1, i + c.grid);
+		}
+	}
+
+	auto& hdr = nif.GetHeader();
+	NiShape* shape = nullptr;
+	if (c.bsTriShape) {
+		auto triShape = new BSTriShape();
+		triShape->Create(&verts, &tris, &uvs, &norms);
+		shape = triShape;
+	}
+	else {
+		auto shapeData = new NiTriShapeData();
+		shapeData->Create(&verts, &tris, &uvs, &norms);
+
+		auto triShape = new NiTriShape();
+		triShape->SetDataRef(hdr.AddBlock(shapeData));
+		triShape->SetGeomData(shapeData);
+		shape = triShape;
+	}
+
+	shape->SetName("Skinned");
+
+	auto root = nif.GetRootNode();
+	hdr.AddBlockRef(nif.GetBlockID(root), root->GetChildren(), hdr.AddBlock(shape));
+	nif.CreateSkinning(shape);
+
+	std::vector<int> boneIds;
+	for (int b = 0; b < c.numBones; b++)
+		boneIds.push_back(nif.GetBlockID(nif.AddNode("Bone" + std::to_string(b), MatTransform())));
+
+	nif.SetShapeBoneIDList(shape, boneIds);
+
+	// Neighbouring vertices share most of their bones, the equal weights test the tie order
+	std::mt19937 rng(seed);
+	std::vector<std::unordered_map<ushort, float>> boneWeights(c.numBones);
+	for (int i = 0; i < (int)verts.size(); i++) {
+		int x = i % c.grid;
+		int y = i / c.grid;
+		int base = (y * c.numBones / c.grid + x * 5 / c.grid) % c.numBones;
+
+		int numWeights = 1 + rng() % 6;
+		for (int w = 0; w < numWeights; w++) {
+			int b = (base + w + rng() % 3) % c.numBones;
+			boneWeights[b][i] = (rng() % 3 == 0) ? 0.25f : (rng() % 100) / 100.0f + 0.01f;
+		}
+	}
+
+	for (int b = 0; b < c.numBones; b++)
+		nif.SetShapeBoneWeights("Skinned", b, boneWeights[b]);
+
+	if (c.numParts > 1) {
+		std::vector<BSDismemberSkinInstance::PartitionInfo> partInfo(c.numParts);
+		for (int p = 0; p < c.numParts; p++) {
+			partInfo[p].flags = PF_EDITOR_VISIBLE;
+			partInfo[p].partID = 30 + p;
+		}
+
+		std::vector<int> triParts(tris.size());
+		for (size_t t = 0; t < tris.size(); t++)
+			triParts[t] = (t / 7 + t % 3) % c.numParts;
+
+		nif.SetShapePartitions(shape, partInfo, triParts);
+	}
+
+	return nif;
+}
+
+template<typename T, typename A>
+bool SameElements(const std::vector<T, A>& a, const std::vector<T, A>& b) {
+	return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+NiSkinPartition* GetSkinPartition(NifFile& nif, NiShape* shape) {
+	auto& hdr = nif.GetHeader();
+	auto skinInst = hdr.GetBlock<NiSkinInstance>(shape->GetSkinInstanceRef());
+	if (!skinInst)
+		return nullptr;
+
+	return hdr.GetBlock<NiSkinPartition>(skinInst->GetSkinPartitionRef());
+}
+
+// Describes the first difference between the two partitionings or returns an empty string
+std::string ComparePartitions(NifFile& legacyNif, NiShape* legacyShape, NifFile& nif, NiShape* shape) {
+	std::vector<BSDismemberSkinInstance::PartitionInfo> legacyInfo, info;
+	std::vector<int> legacyTriParts, triParts;
+	legacyNif.GetShapePartitions(legacyShape, legacyInfo, legacyTriParts);
+	nif.GetShapePartitions(shape, info, triParts);
+
+	if (legacyInfo.size() != info.size())
+		return "partition count " + std::to_string(legacyInfo.size()) + " != " + std::to_string(info.size());
+
+	for (size_t p = 0; p < info.size(); p++)
+		if (legacyInfo[p].flags != info[p].flags || legacyInfo[p].partID != info[p].partID)
+			return "partition info " + std::to_string(p);
+
+	if (legacyTriParts != triParts)
+		return "triangle partitions";
+
+	auto legacySkinPart = GetSkinPartition(legacyNif, legacyShape);
+	auto skinPart = GetSkinPartition(nif, shape);
+	if (!legacySkinPart || !skinPart)
+		return "missing skin partition";
+
+	if (legacySkinPart->partitions.size() != skinPart->partitions.size())
+		return "skin partition count";
+
+	for (size_t p = 0; p < skinPart->partitions.size(); p++) {
+		auto& legacyPart = legacySkinPart->partitions[p];
+		auto& part = skinPart->partitions[p];
+		std::string where = "partition " + std::to_string(p) + " ";
+
+		if (legacyPart.bones != part.bones)
+			return where + "bones";
+		if (legacyPart.vertexMap != part.vertexMap)
+			return where + "vertex map";
+		if (!SameElements(legacyPart.triangles, part.triangles))
+			return where + "triangles";
+		if (!SameElements(legacyPart.trueTriangles, part.trueTriangles))
+			return where + "true triangles";
+		if (!SameElements(legacyPart.boneIndices, part.boneIndices))
+			return where + "bone indices";
+		if (!SameElements(legacyPart.vertexWeights, part.vertexWeights))
+			return where + "vertex weights";
+	}
+
+	if (SaveToString(legacyNif) != SaveToString(nif))
+		return "saved file";
+
+	return std::string();
+}
+
+}
+
+int main() {
+	const CheckCase cases[] = {
+		{ "SSE", NiVersion(V20_2_0_7, 12, 100), true, 120, 200, 3 },
+		{ "FO3", NiVersion(V20_2_0_7, 11, 34), false, 120, 150, 4 },
+		{ "FO3 single partition", NiVersion(V20_2_0_7, 11, 34), false, 60, 40, 1 },
+		{ "SK", NiVersion(V20_2_0_7, 12, 83), false, 80, 100, 2 },
+	};
+
+	int failures = 0;
+	for (auto& c : cases) {
+		for (unsigned int seed = 1; seed <= 3; seed++) {
+			NifFile source = CreateSkinnedMesh(c, seed);
+			std::string data = SaveToString(source);
+
+			NifFile legacyNif;
+			NifFile nif;
+			legacyNif.Load(data.data(), data.size());
+			nif.Load(data.data(), data.size());
+
+			auto legacyShape = legacyNif.GetShapes().front();
+			auto shape = nif.GetShapes().front();
+			LegacyUpdateSkinPartitions(legacyNif, legacyShape);
+			nif.UpdateSkinPartitions(shape);
+
+			std::string difference = ComparePartitions(legacyNif, legacyShape, nif, shape);
+
+			// The bone limits have to split partitions for the check to cover splitting
+			std::vector<BSDismemberSkinInstance::PartitionInfo> partInfo;
+			std::vector<int> triParts;
+			nif.GetShapePartitions(shape, partInfo, triParts);
+
+			auto& version = nif.GetHeader().GetVersion();
+			if (difference.empty() && (version.IsFO3() || version.IsSSE()) && partInfo.size() <= (size_t)c.numParts)
+				difference = "no partition was split";
+
+			if (difference.empty()) {
+				printf("%s, seed %u: OK\n", c.name, seed);
+			}
+			else {
+				printf("%s, seed %u: FAILED (%s)\n", c.name, seed, difference.c_str());
+				failures++;
+			}
+		}
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,42 @@
+/*
+BodySlide and Outfit Studio
+See the included LICENSE file
+*/
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+private:
+	const char* data = nullptr;
+	size_t size = 0;
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+
+public:
+	MappedFile() {}
+	MappedFile(const std::string& fileName) {
+		Open(fileName);
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile() {
+		Close();
+	}
+
+	// Maps the file, returns false if it couldn't be opened or is empty
+	bool Open(const std::string& fileName);
+	void Close();
+
+	bool IsOpen() const { return data != nullptr; }
+	const char* GetData() const { return data; }
+	size_t GetSize() const { return size; }
+};
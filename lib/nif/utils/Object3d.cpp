@@ -1,13 +1,13 @@
 #include "Object3d.h"
 #include "Miniball.hpp"
 
-BoundingSphere::BoundingSphere(const std::vector<Vector3>& vertices) {
-	if (vertices.empty())
+BoundingSphere::BoundingSphere(const Vector3* vertices, const size_t count) {
+	if (count == 0)
 		return;
 
 	// Convert vertices to list of coordinates
 	std::list<std::vector<float>> lp;
-	for (int i = 0; i < vertices.size(); ++i) {
+	for (size_t i = 0; i < count; ++i) {
 		std::vector<float> p(3);
 		p[0] = vertices[i].x;
 		p[1] = vertices[i].y;
@@ -907,7 +907,8 @@ struct BoundingSphere {
 	}
 
 	// Miniball algorithm
-	BoundingSphere(const std::vector<Vector3>& vertices);
+	BoundingSphere(const Vector3* vertices, const size_t count);
+	BoundingSphere(const std::vector<Vector3>& vertices) : BoundingSphere(vertices.data(), vertices.size()) {}
 };
 
 
@@ -1083,7 +1084,8 @@ struct Triangle {
 		outNormal->z = (vertref[p2].x - vertref[p1].x) * (vertref[p3].y - vertref[p1].y) - (vertref[p2].y - vertref[p1].y) * (vertref[p3].x - vertref[p1].x);
 	}
 
-	void trinormal(const std::vector<Vector3>& vertref, Vector3* outNormal) const {
+	template<typename A>
+	void trinormal(const std::vector<Vector3, A>& vertref, Vector3* outNormal) const {
 		outNormal->x = (vertref[p2].y - vertref[p1].y) * (vertref[p3].z - vertref[p1].z) - (vertref[p2].z - vertref[p1].z) * (vertref[p3].y - vertref[p1].y);
 		outNormal->y = (vertref[p2].z - vertref[p1].z) * (vertref[p3].x - vertref[p1].x) - (vertref[p2].x - vertref[p1].x) * (vertref[p3].z - vertref[p1].z);
 		outNormal->z = (vertref[p2].x - vertref[p1].x) * (vertref[p3].y - vertref[p1].y) - (vertref[p2].y - vertref[p1].y) * (vertref[p3].x - vertref[p1].x);
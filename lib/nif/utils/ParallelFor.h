@@ -0,0 +1,56 @@
+/*
+BodySlide and Outfit Studio
+See the included LICENSE file
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// Calls func(index, threadId) for every index in [0, count) on up to numThreads threads, 0 uses one per core.
+// Indices are handed out one at a time, so uneven work spreads well. The calling thread is thread 0.
+// The first exception thrown on any thread is rethrown on the calling thread once all threads are done.
+template<typename Func>
+void ParallelFor(const size_t count, unsigned int numThreads, Func&& func) {
+	if (numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	numThreads = (unsigned int)std::min<size_t>(numThreads, count);
+	if (numThreads <= 1) {
+		for (size_t i = 0; i < count; i++)
+			func(i, 0u);
+
+		return;
+	}
+
+	std::atomic<size_t> next(0);
+	std::vector<std::exception_ptr> errors(numThreads);
+
+	auto run = [&](const unsigned int threadId) {
+		try {
+			for (size_t i = next++; i < count; i = next++)
+				func(i, threadId);
+		}
+		catch (...) {
+			errors[threadId] = std::current_exception();
+			next = count;
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int t = 1; t < numThreads; t++)
+		threads.emplace_back(run, t);
+
+	run(0);
+
+	for (auto &t : threads)
+		t.join();
+
+	for (auto &e : errors)
+		if (e)
+			std::rethrow_exception(e);
+}
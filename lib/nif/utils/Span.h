@@ -0,0 +1,117 @@
+/*
+BodySlide and Outfit Studio
+See the included LICENSE file
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+// Non-owning view of contiguous elements
+template<typename T>
+class Span {
+private:
+	T* ptr = nullptr;
+	size_t count = 0;
+
+public:
+	Span() {}
+	Span(T* data, const size_t size) : ptr(data), count(size) {}
+
+	template<typename U, typename A>
+	Span(std::vector<U, A>& vec) : ptr(vec.data()), count(vec.size()) {}
+
+	template<typename U, typename A>
+	Span(const std::vector<U, A>& vec) : ptr(vec.data()), count(vec.size()) {}
+
+	// Allows Span<T> to convert to Span<const T>
+	template<typename U>
+	Span(const Span<U>& other) : ptr(other.data()), count(other.size()) {}
+
+	T* data() const { return ptr; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+
+	T* begin() const { return ptr; }
+	T* end() const { return ptr + count; }
+
+	T& operator[](const size_t index) const { return ptr[index]; }
+};
+
+// Non-owning view of elements that are a fixed number of bytes apart,
+// e.g. a single attribute of interleaved vertex data
+template<typename T>
+class StridedSpan {
+private:
+	typedef typename std::conditional<std::is_const<T>::value, const char, char>::type byte_type;
+
+	byte_type* ptr = nullptr;
+	size_t count = 0;
+	size_t stride = sizeof(T);
+
+public:
+	class iterator {
+	private:
+		byte_type* ptr;
+		size_t stride;
+
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef typename std::remove_const<T>::type value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef T* pointer;
+		typedef T& reference;
+
+		iterator(byte_type* p, const size_t s) : ptr(p), stride(s) {}
+
+		T& operator*() const { return *reinterpret_cast<T*>(ptr); }
+		T* operator->() const { return reinterpret_cast<T*>(ptr); }
+
+		iterator& operator++() {
+			ptr += stride;
+			return *this;
+		}
+
+		iterator operator++(int) {
+			iterator it = *this;
+			ptr += stride;
+			return it;
+		}
+
+		bool operator==(const iterator& other) const { return ptr == other.ptr; }
+		bool operator!=(const iterator& other) const { return ptr != other.ptr; }
+	};
+
+	StridedSpan() {}
+	StridedSpan(T* data, const size_t size, const size_t strideBytes = sizeof(T))
+		: ptr(reinterpret_cast<byte_type*>(data)), count(size), stride(strideBytes) {}
+
+	template<typename U>
+	StridedSpan(const Span<U>& span) : StridedSpan(span.data(), span.size()) {}
+
+	template<typename U, typename A>
+	StridedSpan(std::vector<U, A>& vec) : StridedSpan(vec.data(), vec.size()) {}
+
+	template<typename U, typename A>
+	StridedSpan(const std::vector<U, A>& vec) : StridedSpan(vec.data(), vec.size()) {}
+
+	// Allows StridedSpan<T> to convert to StridedSpan<const T>
+	template<typename U>
+	StridedSpan(const StridedSpan<U>& other) : StridedSpan(other.data(), other.size(), other.byte_stride()) {}
+
+	T* data() const { return reinterpret_cast<T*>(ptr); }
+	size_t size() const { return count; }
+	size_t byte_stride() const { return stride; }
+	bool empty() const { return count == 0; }
+
+	// True if the elements are packed without gaps
+	bool contiguous() const { return stride == sizeof(T); }
+
+	iterator begin() const { return iterator(ptr, stride); }
+	iterator end() const { return iterator(ptr + count * stride, stride); }
+
+	T& operator[](const size_t index) const { return *reinterpret_cast<T*>(ptr + index * stride); }
+};
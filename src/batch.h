@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Case insensitive wildcard match, '*' matches any run of characters and '?' a single one
+inline bool glob_match(std::string_view pattern, std::string_view name) {
+	auto lower = [](char c) { return (char)std::tolower((unsigned char)c); };
+
+	size_t p = 0;
+	size_t n = 0;
+	size_t star = std::string_view::npos;
+	size_t resume = 0;
+
+	while (n < name.size()) {
+		if (p < pattern.size() && pattern[p] == '*') {
+			star = p++;
+			resume = n;
+		}
+		else if (p < pattern.size() && (pattern[p] == '?' || lower(pattern[p]) == lower(name[n]))) {
+			p++;
+			n++;
+		}
+		else if (star != std::string_view::npos) {
+			p = star + 1;
+			n = ++resume;
+		}
+		else {
+			return false;
+		}
+	}
+
+	while (p < pattern.size() && pattern[p] == '*') {
+		p++;
+	}
+
+	return p == pattern.size();
+}
+
+// Caps the estimated memory of the jobs in flight, a job larger than the whole budget still runs on its own
+class MemoryBudget {
+public:
+	explicit MemoryBudget(uintmax_t limit) : limit(limit) {}
+
+	void acquire(uintmax_t bytes) {
+		std::unique_lock<std::mutex> lock(mutex);
+		available.wait(lock, [&] { return limit == 0 || used == 0 || used + bytes <= limit; });
+		used += bytes;
+	}
+
+	void release(uintmax_t bytes) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			used -= bytes;
+		}
+
+		available.notify_all();
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable available;
+	uintmax_t limit;
+	uintmax_t used = 0;
+};
+
+// Calls func(index) for every index in [0, count) on num_threads workers (0 for one per core).
+// Indices are dealt out round robin, each worker drains its own queue from the front and steals
+// from the back of the other queues once it runs dry, so a few large files don't stall the pool.
+template<typename Func>
+void run_work_stealing(size_t count, unsigned int num_threads, Func &&func) {
+	if (num_threads == 0) {
+		num_threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	num_threads = (unsigned int)std::min<size_t>(num_threads, std::max<size_t>(count, 1));
+
+	struct WorkQueue {
+		std::mutex mutex;
+		std::deque<size_t> items;
+	};
+
+	std::vector<WorkQueue> queues(num_threads);
+
+	for (size_t i = 0; i < count; i++) {
+		queues[i % num_threads].items.push_back(i);
+	}
+
+	auto take = [&](unsigned int worker, size_t &index) {
+		{
+			auto &own = queues[worker];
+			std::lock_guard<std::mutex> lock(own.mutex);
+
+			if (!own.items.empty()) {
+				index = own.items.front();
+				own.items.pop_front();
+				return true;
+			}
+		}
+
+		for (unsigned int i = 1; i < num_threads; i++) {
+			auto &victim = queues[(worker + i) % num_threads];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+
+			if (!victim.items.empty()) {
+				index = victim.items.back();
+				victim.items.pop_back();
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	auto work = [&](unsigned int worker) {
+		size_t index;
+
+		while (take(worker, index)) {
+			func(index);
+		}
+	};
+
+	std::vector<std::thread> threads;
+
+	for (unsigned int t = 1; t < num_threads; t++) {
+		threads.emplace_back(work, t);
+	}
+
+	work(0);
+
+	for (auto &thread : threads) {
+		thread.join();
+	}
+}
@@ -1,18 +1,26 @@
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <stdio.h>
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <regex>
+#include <set>
+#include <sstream>
 #include <filesystem>
 
 #include <CLI/CLI.hpp>
 #include <fmt/core.h>
 #include <fmt/ostream.h>
-#include <tiny_obj_loader.h>
 
 #include <NifFile.h>
+#include <Skinning.h>
 
+#include "batch.h"
 #include "format.h"
+#include "obj_reader.h"
+#include "obj_writer.h"
 #include "version.h"
 
 namespace fs = std::filesystem;
@@ -26,295 +34,561 @@ struct CLIOptions {
 	fs::path output_file;
 	bool skin;
 	bool overwrite;
+	bool batch;
+	bool interactive;
+	std::string glob;
+	std::string shape_name;
+	std::string shape_regex;
+	std::regex shape_pattern;
+	int shape_index = -1;
+	bool all_shapes;
+	bool split;
+	unsigned int jobs;
+	unsigned int obj_threads = 1;
+	uintmax_t max_memory = 1024;
+};
+
+struct BatchJob {
+	fs::path input;
+	fs::path output;
+	// nif next to an obj input, the obj's attributes are written into it
+	fs::path target;
 };
 
 CLIOptions options = CLIOptions();
 
-Vector3 transform_vertice(Vector3 v, MatTransform t, float w) {
-	return t.rotation * (v * t.scale) + t.translation * w;
-}
+void deform_normals(const LinearBlendSkin &skin, NiShape &shape, bool inverse) {
+	auto view = shape.view_normals();
 
-std::vector<Vector3> skin_vertices(NifFile &nifile, NiShape &shape, bool inverse = false) {
-	auto vertices = *shape.get_vertices();
+	if (view.empty()) {
+		return;
+	}
+
+	std::vector<Vector3> normals(view.begin(), view.end());
+	skin.DeformNormals(normals, inverse);
+	shape.set_normals(normals);
+}
 
-	std::vector<Vector3> transforms;
-	transforms.resize(vertices.size());
+// Reads the obj straight into the vertices and uv of the shape, normals are packed on some shapes so they go through a copy
+bool transfer_attributes(ObjReader &reader, NiShape &shape) {
+	StridedSpan<Vector2> uv;
 
-	std::vector<int> bones;
-	nifile.GetShapeBoneIDList(&shape, bones);
+	if (shape.view_uv().size() == reader.num_uv()) {
+		uv = shape.edit_uv();
+	}
 
-	for (int id : bones) {
-		MatTransform transform;
-		nifile.GetShapeTransformSkinToBone(&shape, id - 1, transform);
+	std::vector<Vector3> normals;
+	auto view = shape.view_normals();
 
-		std::unordered_map<ushort, float> weights;
-		nifile.GetShapeBoneWeights(&shape, id - 1, weights);
+	if (!view.empty() && view.size() == reader.num_normals()) {
+		normals.resize(view.size());
+	}
 
-		for (auto w : weights) {
-			auto v = vertices[w.first];
+	if (!reader.read(shape.edit_vertices(), uv, normals)) {
+		return false;
+	}
 
-			vertices[w.first] = transform_vertice(v, transform, w.second);
-			transforms[w.first] += vertices[w.first] - v;
-		}
+	if (!normals.empty()) {
+		shape.set_normals(normals);
 	}
 
-	return transforms;
+	return true;
 }
 
-// TODO: Optimize with type cast
-void transfer_attributes(const tinyobj::attrib_t &attributes, NiShape &shape) {
-	auto vertices = shape.get_vertices();
+bool has_shape_rule() {
+	return !options.shape_name.empty() || !options.shape_regex.empty() || options.shape_index >= 0;
+}
 
-	if (vertices && vertices->size() == attributes.vertices.size() / 3)
-	{
-		std::vector<Vector3> vertices;
-		vertices.reserve(attributes.vertices.size() / 3);
-
-		for (size_t i = 0; i < attributes.vertices.size(); i += 3) {
-			vertices.emplace_back(
-					attributes.vertices[i],
-					attributes.vertices[i + 1],
-					attributes.vertices[i + 2]);
+// Shapes passing every --shape, --shape-regex and --shape-index rule, the index counts all shapes of the file
+std::vector<NiShape*> match_shapes(const std::vector<NiShape*> &shapes) {
+	std::vector<NiShape*> matched;
+
+	for (size_t i = 0; i < shapes.size(); i++) {
+		auto name = shapes[i]->GetName();
+
+		if (options.shape_index >= 0 && i != (size_t)options.shape_index) {
+			continue;
 		}
 
-		shape.set_vertices(vertices);
+		if (!options.shape_name.empty() && name != options.shape_name) {
+			continue;
+		}
+
+		if (!options.shape_regex.empty() && !std::regex_search(name, options.shape_pattern)) {
+			continue;
+		}
+
+		matched.push_back(shapes[i]);
 	}
 
-	auto normals = shape.get_normals(false);
+	return matched;
+}
 
-	if (normals && normals->size() == attributes.normals.size() / 3) {
-		std::vector<Vector3> normals;
-		normals.reserve(attributes.normals.size() / 3);
+// Picks the only candidate or the one entered on stdin, never asks outside of interactive mode
+NiShape* select_shape(const std::vector<NiShape*> &shapes, const std::string &prompt, std::ostream &log) {
+	if (shapes.size() == 1) {
+		return shapes[0];
+	}
 
-		for (size_t i = 0; i < attributes.normals.size(); i += 3) {
-			normals.emplace_back(
-					attributes.normals[i],
-					attributes.normals[i + 1],
-					attributes.normals[i + 2]);
-		}
+	fmt::print(log, "\n");
 
-		shape.set_normals(normals);
+	for (size_t i = 0; i < shapes.size(); i++) {
+		fmt::print(log, GREEN "{}" WHITE ": {}\n", i, shapes[i]->GetName());
 	}
 
-	auto uv = shape.get_uv();
+	if (!options.interactive) {
+		fmt::print(log, "\nMultiple shapes match, select one with --shape, --shape-regex or --shape-index.\n");
 
-	if (uv && uv->size() == attributes.texcoords.size() / 2) {
-		std::vector<Vector2> uv;
-		uv.reserve(attributes.texcoords.size() / 2);
+		return nullptr;
+	}
 
-		for (size_t i = 0; i < attributes.texcoords.size(); i += 2) {
-			uv.emplace_back(
-					attributes.texcoords[i],
-					1.0 - attributes.texcoords[i + 1]);
-		}
+	fmt::print(log, "\n{}\n", prompt);
+
+	size_t index;
+	std::cin >> index;
 
-		shape.set_uv(uv);
+	if (!std::cin || index >= shapes.size()) {
+		return nullptr;
 	}
+
+	return shapes[index];
 }
 
-void export_shape(NiShape &shape, std::ostream &stream) {
-	const std::vector<Vector3> vertices = *shape.get_vertices();
-	const std::vector<Vector2>* uv = shape.get_uv();
-	const std::vector<Vector3>* normals = shape.get_normals(false);
+// Writes the shapes as separate objects of one OBJ
+void export_shapes(const std::vector<NiShape*> &shapes, std::ostream &stream) {
+	size_t num_vertices = 0;
+	size_t num_uv = 0;
+	size_t num_normals = 0;
+	size_t num_faces = 0;
 
-	std::vector<Triangle> faces;
-	shape.GetTriangles(faces);
+	std::vector<std::vector<Triangle>> faces(shapes.size());
 
-	fmt::print(stream,
-			"# NifHacks 0.2\n\n"
-			"# {} Vertices\n"
-			"# {} Texture coordinates\n"
-			"# {} Normals\n"
-			"# {} Faces\n",
-			vertices.size(),
-			uv ? uv->size() : 0,
-			normals ? normals->size() : 0,
-			faces.size());
+	for (size_t i = 0; i < shapes.size(); i++) {
+		shapes[i]->GetTriangles(faces[i]);
 
-	if (auto name = shape.GetName(); !name.empty()) {
-		fmt::print(stream, "\no {}\n\n", name);
+		num_vertices += shapes[i]->view_vertices().size();
+		num_uv += shapes[i]->view_uv().size();
+		num_normals += shapes[i]->view_normals().size();
+		num_faces += faces[i].size();
 	}
 
-	for (auto v : vertices) {
-		fmt::print(stream, "v {}\n", v);
+	ObjWriter writer(stream, options.obj_threads);
+	writer.header(num_vertices, num_uv, num_normals, num_faces);
+
+	for (size_t i = 0; i < shapes.size(); i++) {
+		writer.object(shapes[i]->GetName(), shapes[i]->view_vertices(), shapes[i]->view_uv(), shapes[i]->view_normals(), faces[i]);
 	}
+}
 
-	fmt::print(stream, "\n");
+// Writes the obj into the nif, the result is saved as export_name
+int obj_to_nif(const std::string &obj_filename, const std::string &nif_filename, const std::string &export_name, std::ostream &log) {
+	ObjReader reader(options.obj_threads);
 
-	std::string f_zero = "{0}";
+	if (!reader.open(obj_filename)) {
+		fmt::print(log, "{}\n", reader.error());
 
-	if (uv) {
-		for (auto &p : *uv) {
-			fmt::print(stream, "vt {} {}\n", p.u, 1.0 - p.v);
-		}
+		return 1;
+	}
+
+	NifLoadOptions load_options;
+	load_options.memoryMap = true;
+	load_options.lazyBlocks = true;
+	load_options.blockArena = true;
+
+	auto nifile = NifFile(nif_filename, load_options);
 
-		fmt::print(stream, "\n");
+	if (!nifile.IsValid()) {
+		fmt::print(log, "Couldn't load {}.\n", nif_filename);
 
-		f_zero += "/{0}";
+		return 1;
+	}
+
+	auto nif_shapes = match_shapes(nifile.GetShapes());
+
+	if (nif_shapes.empty()) {
+		fmt::print(log, "No shape matches the selection.\n");
+
+		return 1;
 	}
 
-	if (normals) {
-		for (auto &p : *normals) {
-			fmt::print(stream, "vn {}\n", p);
+	std::vector<NiShape*> identical_shapes;
+
+	for (auto shape : nif_shapes) {
+		if (shape->view_vertices().size() == reader.num_vertices()) {
+			identical_shapes.emplace_back(shape);
 		}
+	}
 
-		fmt::print(stream, "\n");
+	if (identical_shapes.size() == 0)
+	{
+		fmt::print(log, "Couldn't find a shape with the same ammount of vertices.\nExpected: {}\n", reader.num_vertices());
+
+		return 1;
+	}
+
+	NiShape* shape = select_shape(identical_shapes, "Multiple shapes with the same amount of vertices where found.\nEnter the number of shape, which will acquire all data.", log);
 
-		f_zero += "/{0}";
+	if (!shape) {
+		return 1;
 	}
 
-	auto f_one = f_zero;
-	auto f_two = f_zero;
+	if (!transfer_attributes(reader, *shape)) {
+		fmt::print(log, "{}\n", reader.error());
 
-	std::replace(f_one.begin(), f_one.end(), '0', '1');
-	std::replace(f_two.begin(), f_two.end(), '0', '2');
+		return 1;
+	}
 
-	auto f_format = fmt::format("f {} {} {}\n", f_zero, f_one, f_two);
+	if (options.skin) {
+		LinearBlendSkin skin;
 
-	for (auto &f : faces) {
-		fmt::print(stream, f_format, f.p1+1, f.p2+1, f.p3+1);
+		if (skin.Build(nifile, shape)) {
+			skin.DeformInverse(shape->edit_vertices());
+			deform_normals(skin, *shape, true);
+		}
 	}
 
-	fmt::print(stream, "\n");
+	// Blocks other than the edited shapes are written back as they were
+	NifSaveOptions save_options;
+	save_options.passThrough = true;
+
+	nifile.Save(export_name, save_options);
+
+	fmt::print(log, "Successfully transfered coordinates to " GREEN "{}\n" WHITE, export_name);
+
+	return 0;
 }
 
-int obj_to_nif(const std::string &obj_filename, const std::string &nif_filename) {
-	tinyobj::attrib_t attributes;
-	std::vector<tinyobj::shape_t> obj_shapes;
+// Output of a shape in split mode, the shape name is appended to the file name
+fs::path split_filename(const fs::path &obj_filename, const std::string &name, size_t index, std::set<std::string> &used) {
+	std::string suffix = name.empty() ? fmt::format("{}", index) : name;
 
-	std::string err;
+	for (auto &c : suffix) {
+		if (!std::isalnum((unsigned char)c) && c != '-' && c != '_' && c != '.') {
+			c = '_';
+		}
+	}
 
-	if (!tinyobj::LoadObj(&attributes, &obj_shapes, nullptr, &err, obj_filename.c_str())) {
-		std::cerr << err << std::endl;
+	if (!used.insert(suffix).second) {
+		suffix += fmt::format("_{}", index);
+		used.insert(suffix);
+	}
 
-		return 1;
+	auto filename = obj_filename;
+	filename.replace_filename(fmt::format("{}_{}{}", obj_filename.stem().string(), suffix, obj_filename.extension().string()));
+
+	return filename;
+}
+
+bool write_obj(const std::vector<NiShape*> &shapes, const fs::path &obj_filename, std::ostream &log) {
+	if (fs::exists(obj_filename)) {
+		fmt::print(log, RED "Warning! {} already exists and will be overwritten.\n" WHITE, obj_filename.string());
 	}
 
-	auto nifile = NifFile(nif_filename);
-	auto nif_shapes = nifile.GetShapes();
+	std::ofstream obj_stream(obj_filename, std::ios::out);
 
-	std::vector<NiShape*> identical_shapes;
+	if (!obj_stream) {
+		fmt::print(log, "Couldn't open {} for writing.\n", obj_filename.string());
 
-	for (auto shape : nif_shapes) {
-		auto vertices = shape->get_vertices();
+		return false;
+	}
 
-		if (vertices && vertices->size() == attributes.vertices.size() / 3) {
-			identical_shapes.emplace_back(shape);
-		}
+	export_shapes(shapes, obj_stream);
+
+	if (shapes.size() == 1) {
+		fmt::print(log, "Successfully exported " GREEN "{}" WHITE " to " GREEN "{}\n" WHITE, shapes[0]->GetName(), obj_filename.string());
+	}
+	else {
+		fmt::print(log, "Successfully exported " GREEN "{} shapes" WHITE " to " GREEN "{}\n" WHITE, shapes.size(), obj_filename.string());
 	}
 
-	if (identical_shapes.size() == 0)
-	{
-		fmt::print("Couldn't find a shape with the same ammount of vertices.\nExpected: {}\n", attributes.vertices.size());
+	return true;
+}
+
+int nif_to_obj(const std::string &nif_filename, const std::string &obj_filename, std::ostream &log) {
+	NifLoadOptions load_options;
+	load_options.memoryMap = true;
+	load_options.trimTexturePaths = false;
+	load_options.blockArena = true;
+
+	auto nifile = NifFile(nif_filename, load_options);
+
+	if (!nifile.IsValid()) {
+		fmt::print(log, "Couldn't load {}.\n", nif_filename);
 
 		return 1;
 	}
 
-	NiShape* shape = identical_shapes[0];
+	auto shapes = match_shapes(nifile.GetShapes());
 
-	if (identical_shapes.size() > 1)
-	{
-		fmt::print("\n");
+	if (shapes.size() == 0) {
+		fmt::print(log, has_shape_rule() ? "No shape matches the selection.\n" : "No shapes to export.\n");
+		return 1;
+	}
+
+	if (!options.all_shapes && !options.split) {
+		NiShape* shape = select_shape(shapes, "Enter the number of shape you want to export.", log);
+
+		if (!shape) {
+			return 1;
+		}
+
+		shapes = { shape };
+	}
 
-		for (size_t i = 0; i < identical_shapes.size(); i++) {
-			fmt::print(GREEN "{}" WHITE ": {}\n", i, identical_shapes[i]->GetName());
+	if (options.skin) {
+		LinearBlendSkin skin;
+
+		for (auto shape : shapes) {
+			if (skin.Build(nifile, shape)) {
+				skin.Deform(shape->edit_vertices());
+				deform_normals(skin, *shape, false);
+			}
 		}
+	}
 
-		fmt::print("\nMultiple shapes with the same amount of vertices where found.\nEnter the number of shape, which will acquire all data.\n");
+	if (!options.split) {
+		return write_obj(shapes, obj_filename, log) ? 0 : 1;
+	}
+
+	std::set<std::string> used;
 
-		int index;
-		std::cin >> index;
+	for (size_t i = 0; i < shapes.size(); i++) {
+		auto filename = split_filename(obj_filename, shapes[i]->GetName(), i, used);
 
-		if (index >= 0 && index < identical_shapes.size())
-			shape = identical_shapes[index];
-		else
+		if (!write_obj({ shapes[i] }, filename, log)) {
 			return 1;
+		}
 	}
 
-	auto transforms = skin_vertices(nifile, *shape);
-	transfer_attributes(attributes, *shape);
+	return 0;
+}
 
-	// TODO: Optimize with SIMD
-	if (options.skin) {
-		auto vertices = *shape->get_vertices();
+std::string lowercase_extension(const fs::path &path) {
+	auto extension = path.extension().string();
 
-		for (size_t i = 0; i < transforms.size(); i++) {
-			vertices[i] -= transforms[i];
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+
+	return extension;
+}
+
+// Returns -1 when there is no conversion between the two file types
+int convert(const fs::path &input, const fs::path &output, std::ostream &log) {
+	auto input_ext = lowercase_extension(input);
+	auto output_ext = lowercase_extension(output);
+
+	if (input_ext == ".obj" && output_ext == ".nif") {
+		auto export_name = output.string();
+
+		if (!options.overwrite) {
+			export_name += ".nif";
 		}
 
-		shape->set_vertices(vertices);
+		return obj_to_nif(input.string(), output.string(), export_name, log);
 	}
 
-	auto export_name = nif_filename;
-
-	if (!options.overwrite) {
-		export_name += ".nif";
+	if (input_ext == ".nif" && output_ext == ".obj") {
+		return nif_to_obj(input.string(), output.string(), log);
 	}
 
-	nifile.Save(export_name);
+	return -1;
+}
 
-	fmt::print("Successfully transfered coordinates to " GREEN "{}\n" WHITE, export_name);
+// An obj is written into the nif of the same name next to it, the result goes to the job's output
+int convert_job(const BatchJob &job, std::ostream &log) {
+	if (!job.target.empty()) {
+		return obj_to_nif(job.input.string(), job.target.string(), job.output.string(), log);
+	}
 
-	return 0;
+	return convert(job.input, job.output, log);
 }
 
-int nif_to_obj(const std::string &nif_filename, const std::string &obj_filename) {
-	if (fs::exists(obj_filename)) {
-		fmt::print(RED "Warning! Target already exists and will be overwritten.\n" WHITE);
+// Collects jobs from a directory walk or a manifest with one "input[<TAB>output]" pair per line,
+// outputs that aren't given land in the OUTPUT directory under the input's path relative to the
+// directory or the manifest. Fails if two jobs would write the same output.
+bool collect_batch_jobs(std::vector<BatchJob> &jobs) {
+	auto add_job = [&](const fs::path &input, fs::path output, const fs::path &relative) {
+		auto extension = lowercase_extension(input);
+
+		if (extension != ".nif" && extension != ".obj") {
+			return;
+		}
+
+		if (!options.glob.empty() && !glob_match(options.glob, input.filename().string())) {
+			return;
+		}
+
+		if (output.empty()) {
+			output = options.output_file / relative;
+			output.replace_extension(extension == ".nif" ? ".obj" : ".nif");
+		}
+
+		fs::path target;
+
+		if (extension == ".obj") {
+			target = fs::path(input).replace_extension(".nif");
+		}
+
+		jobs.push_back({ input, output, target });
+	};
+
+	// Two jobs writing the same file would race, report all of them before anything runs
+	auto unique_outputs = [&]() {
+		std::vector<std::pair<fs::path, const BatchJob*>> outputs;
+
+		for (auto &job : jobs) {
+			outputs.emplace_back(job.output.lexically_normal(), &job);
+		}
+
+		std::sort(outputs.begin(), outputs.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+		bool unique = true;
+
+		for (size_t i = 1; i < outputs.size(); i++) {
+			if (outputs[i].first == outputs[i - 1].first) {
+				fmt::print("{} and {} both write {}.\n", outputs[i - 1].second->input.string(), outputs[i].second->input.string(), outputs[i].first.string());
+				unique = false;
+			}
+		}
+
+		return unique;
+	};
+
+	if (fs::is_directory(options.input_file)) {
+		for (auto &entry : fs::recursive_directory_iterator(options.input_file, fs::directory_options::skip_permission_denied)) {
+			if (entry.is_regular_file()) {
+				add_job(entry.path(), {}, fs::relative(entry.path(), options.input_file));
+			}
+		}
+
+		// Directory order is unspecified, keep the report stable between runs
+		std::sort(jobs.begin(), jobs.end(), [](const BatchJob &a, const BatchJob &b) { return a.input < b.input; });
+
+		return unique_outputs();
 	}
 
-	auto nifile = NifFile(nif_filename);
+	std::ifstream manifest(options.input_file);
 
-	auto shapes = nifile.GetShapes();
+	if (!manifest) {
+		fmt::print("Couldn't open manifest {}.\n", options.input_file.string());
 
-	if (shapes.size() == 0) {
-		fmt::print("No shapes to export.\n");
-		return 1;
+		return false;
 	}
 
-	fmt::print("\n");
+	auto base = options.input_file.parent_path();
 
-	int index = 0;
-	if (shapes.size() > 1) {
-		for (size_t i = 0; i < shapes.size(); i++) {
-			fmt::print(GREEN "{}" WHITE ": {}\n", i, shapes[i]->GetName());
+	std::string line;
+	while (std::getline(manifest, line)) {
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
 		}
 
-		fmt::print("\nEnter the number of shape you want to export.\n");
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
 
-		std::cin >> index;
+		auto tab = line.find('\t');
+		fs::path input = base / line.substr(0, tab);
+		fs::path output;
 
-		if (index < 0 || index >= shapes.size()) {
-			return 1;
+		if (tab != std::string::npos) {
+			output = base / line.substr(tab + 1);
+		}
+
+		// Inputs outside of the manifest's directory keep only their name
+		auto relative = input.lexically_normal().lexically_relative(base.lexically_normal());
+
+		if (relative.empty() || *relative.begin() == "..") {
+			relative = input.filename();
 		}
+
+		add_job(input, output, relative);
 	}
 
-	NiShape* shape = shapes[index];
+	return unique_outputs();
+}
 
-	if (!shape) {
-		fmt::print("Couldn't find shape in source file.\n");
+// Estimated peak memory of a job, the files it reads plus their decoded data
+uintmax_t job_footprint(const BatchJob &job) {
+	std::error_code ec;
 
+	uintmax_t bytes = fs::file_size(job.input, ec);
+	if (ec) {
+		bytes = 0;
+	}
+
+	if (!job.target.empty()) {
+		uintmax_t target = fs::file_size(job.target, ec);
+		if (!ec) {
+			bytes += target;
+		}
+	}
+
+	return bytes * 4;
+}
+
+int run_batch() {
+	std::vector<BatchJob> jobs;
+
+	if (!collect_batch_jobs(jobs)) {
 		return 1;
 	}
 
-	// TODO: Optimize with SIMD
-	if (options.skin) {
-		auto transforms = skin_vertices(nifile, *shape);
-		auto vertices = *shape->get_vertices();
+	if (jobs.empty()) {
+		fmt::print("No files to process.\n");
+
+		return 1;
+	}
+
+	MemoryBudget budget(options.max_memory * 1024 * 1024);
+
+	std::mutex report_mutex;
+	size_t finished = 0;
+	std::atomic<size_t> failed = 0;
 
-		for (size_t i = 0; i < transforms.size(); i++) {
-			vertices[i] += transforms[i];
+	run_work_stealing(jobs.size(), options.jobs, [&](size_t i) {
+		const auto &job = jobs[i];
+		auto footprint = job_footprint(job);
+
+		budget.acquire(footprint);
+
+		auto start = std::chrono::steady_clock::now();
+
+		std::ostringstream log;
+		int status;
+
+		try {
+			std::error_code ec;
+			fs::create_directories(job.output.parent_path(), ec);
+
+			status = convert_job(job, log);
+		}
+		catch (const std::exception &e) {
+			fmt::print(log, "{}\n", e.what());
+			status = 1;
 		}
 
-		shape->set_vertices(vertices);
-	}
+		budget.release(footprint);
 
-	std::ofstream obj_stream(obj_filename, std::ios::out);
-	export_shape(*shape, obj_stream);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
 
-	fmt::print("Successfully exported " GREEN "{}" WHITE " to " GREEN "{}\n" WHITE, shape->GetName(), obj_filename);
+		if (status != 0) {
+			failed++;
+		}
 
-	return 0;
+		std::lock_guard<std::mutex> lock(report_mutex);
+		finished++;
+
+		if (status == 0) {
+			fmt::print("[{}/{}] " GREEN "ok" WHITE " {} -> {} ({:.2f}s)\n", finished, jobs.size(), job.input.string(), job.output.string(), elapsed.count());
+		}
+		else {
+			fmt::print("[{}/{}] " RED "failed" WHITE " {} -> {} ({:.2f}s)\n{}", finished, jobs.size(), job.input.string(), job.output.string(), elapsed.count(), log.str());
+		}
+	});
+
+	fmt::print("\nProcessed {} files, {} failed.\n", jobs.size(), failed.load());
+
+	return failed > 0 ? 1 : 0;
 }
 
 int main(int argc, char *argv[]) {
@@ -322,31 +596,49 @@ int main(int argc, char *argv[]) {
 	CLI::App app { "Janky tool that (sometimes) get things done for your nif-needs\n" };
 
 	app.add_option("INPUT", options.input_file)
-		->option_text("    *.nif *.obj")
+		->option_text("    *.nif *.obj DIR MANIFEST")
 		->required(true)
-		->check(CLI::ExistingFile);
+		->check(CLI::ExistingPath);
 
 	app.add_option("OUTPUT", options.output_file)
-		->option_text("   *.obj *.nif")
+		->option_text("   *.obj *.nif DIR")
 		->required(true);
 
 	app.add_flag("-s,--skin", options.skin, "Apply skin transforms to shape");
 	app.add_flag("-i,--in-place", options.overwrite, "Modify file in place");
+	app.add_option("--shape", options.shape_name, "Only use the shape with this name");
+	app.add_option("--shape-regex", options.shape_regex, "Only use shapes whose name matches the regular expression");
+	app.add_option("--shape-index", options.shape_index, "Only use the shape at this position of the file");
+	app.add_flag("-a,--all", options.all_shapes, "Export every selected shape as an object of one obj");
+	app.add_flag("--split", options.split, "Export every selected shape to its own obj named after the shape");
+	app.add_flag("-b,--batch", options.batch, "Convert every file of the INPUT directory or manifest into the OUTPUT directory");
+	app.add_option("-g,--glob", options.glob, "Only convert batch files whose name matches the pattern");
+	app.add_option("-j,--jobs", options.jobs, "Files converted at once in batch mode, 0 for one per core");
+	app.add_option("--obj-threads", options.obj_threads, "Threads reading or writing each obj, 0 for one per core")
+		->capture_default_str();
+	app.add_option("--max-memory", options.max_memory, "Approximate memory limit in MiB for files in flight in batch mode, 0 for none")
+		->capture_default_str();
 	app.set_version_flag("-v,--version", fmt::format("nifhacks {:d}.{:d}.{:d}", NIFHACKS_VERSION_MAJOR, NIFHACKS_VERSION_MINOR, NIFHACKS_VERSION_PATCH));
 
 	CLI11_PARSE(app, argc, argv);
 
-	auto input_ext = options.input_file.extension();
-	auto output_ext = options.output_file.extension();
+	try {
+		options.shape_pattern = std::regex(options.shape_regex);
+	}
+	catch (const std::regex_error &e) {
+		fmt::print(stderr, "Invalid --shape-regex: {}\n", e.what());
 
-	if (input_ext == ".obj" && output_ext == ".nif")
-	{
-		return obj_to_nif(options.input_file.string(), options.output_file.string());
+		return 1;
 	}
 
-	if (input_ext == ".nif" && output_ext == ".obj")
-	{
-		return nif_to_obj(options.input_file.string(), options.output_file.string());
+	if (options.batch || fs::is_directory(options.input_file)) {
+		return run_batch();
+	}
+
+	options.interactive = true;
+
+	if (int status = convert(options.input_file, options.output_file, std::cout); status != -1) {
+		return status;
 	}
 
 	std::cerr << app.help() << std::flush;
@@ -0,0 +1,368 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <MappedFile.h>
+#include <NifFile.h>
+#include <ParallelFor.h>
+
+// Reads the v, vt and vn lines of an OBJ straight into the attribute arrays of a shape.
+// The file is memory mapped and cut into chunks on line boundaries. Opening counts the
+// elements of every chunk, which gives each chunk its first index, so reading can parse
+// all chunks in parallel without any intermediate arrays.
+class ObjReader {
+public:
+	static constexpr size_t min_chunk_size = 1 << 16;
+
+	explicit ObjReader(unsigned int threads = 1) : threads(threads) {
+		if (this->threads == 0) {
+			this->threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+	}
+
+	// Maps the file and counts its elements, false if it can't be read
+	bool open(const std::string &filename) {
+		chunks.clear();
+		totals = Counts();
+
+		if (!file.Open(filename)) {
+			message = fmt::format("Couldn't read {}.", filename);
+
+			return false;
+		}
+
+		const char *data = file.GetData();
+		const char *end = data + file.GetSize();
+
+		size_t num_chunks = 1;
+
+		if (threads > 1) {
+			num_chunks = std::min<size_t>(threads * 4, file.GetSize() / min_chunk_size + 1);
+		}
+
+		const char *begin = data;
+
+		for (size_t i = 1; i <= num_chunks && begin < end; i++) {
+			const char *split = i == num_chunks ? end : data + file.GetSize() * i / num_chunks;
+
+			if (split < begin) {
+				split = begin;
+			}
+
+			auto newline = (const char*)std::memchr(split, '\n', end - split);
+			split = newline ? newline + 1 : end;
+
+			Chunk chunk;
+			chunk.begin = begin;
+			chunk.end = split;
+			chunks.push_back(chunk);
+
+			begin = split;
+		}
+
+		ParallelFor(chunks.size(), threads, [&](const size_t c, const unsigned int) {
+			count(chunks[c]);
+		});
+
+		for (auto &chunk : chunks) {
+			chunk.first = totals;
+
+			totals.vertices += chunk.counts.vertices;
+			totals.uv += chunk.counts.uv;
+			totals.normals += chunk.counts.normals;
+			totals.faces += chunk.counts.faces;
+			totals.lines += chunk.counts.lines;
+		}
+
+		return true;
+	}
+
+	size_t num_vertices() const { return totals.vertices; }
+	size_t num_uv() const { return totals.uv; }
+	size_t num_normals() const { return totals.normals; }
+	size_t num_faces() const { return totals.faces; }
+
+	// Parses the file into the given arrays, an array is skipped if its size doesn't match the count.
+	// Texture coordinates are flipped vertically like the writer does. Faces are only checked for
+	// indices out of range. Returns false on the first malformed line, see error().
+	bool read(StridedSpan<Vector3> vertices, StridedSpan<Vector2> uv, StridedSpan<Vector3> normals) {
+		Target target;
+		target.vertices = vertices.size() == totals.vertices ? vertices : StridedSpan<Vector3>();
+		target.uv = uv.size() == totals.uv ? uv : StridedSpan<Vector2>();
+		target.normals = normals.size() == totals.normals ? normals : StridedSpan<Vector3>();
+
+		ParallelFor(chunks.size(), threads, [&](const size_t c, const unsigned int) {
+			parse(chunks[c], target);
+		});
+
+		for (auto &chunk : chunks) {
+			if (!chunk.error.empty()) {
+				message = chunk.error;
+
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	const std::string &error() const { return message; }
+
+private:
+	enum class Element { None, Vertex, UV, Normal, Face };
+
+	struct Counts {
+		size_t vertices = 0;
+		size_t uv = 0;
+		size_t normals = 0;
+		size_t faces = 0;
+		size_t lines = 0;
+	};
+
+	struct Chunk {
+		const char *begin = nullptr;
+		const char *end = nullptr;
+		Counts counts;
+		Counts first;
+		std::string error;
+	};
+
+	struct Target {
+		StridedSpan<Vector3> vertices;
+		StridedSpan<Vector2> uv;
+		StridedSpan<Vector3> normals;
+	};
+
+	unsigned int threads;
+
+	MappedFile file;
+	std::vector<Chunk> chunks;
+	Counts totals;
+	std::string message;
+
+	static bool is_space(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	static const char *skip_space(const char *p, const char *end) {
+		while (p < end && is_space(*p)) {
+			p++;
+		}
+
+		return p;
+	}
+
+	static const char *line_end(const char *p, const char *end) {
+		auto newline = (const char*)std::memchr(p, '\n', end - p);
+
+		return newline ? newline : end;
+	}
+
+	// Reads the keyword at the start of a line and moves past it
+	static Element element(const char *&p, const char *end) {
+		p = skip_space(p, end);
+
+		const char *word = p;
+
+		while (p < end && !is_space(*p)) {
+			p++;
+		}
+
+		std::string_view keyword(word, p - word);
+
+		if (keyword == "v") {
+			return Element::Vertex;
+		}
+
+		if (keyword == "vt") {
+			return Element::UV;
+		}
+
+		if (keyword == "vn") {
+			return Element::Normal;
+		}
+
+		if (keyword == "f") {
+			return Element::Face;
+		}
+
+		return Element::None;
+	}
+
+	template<typename T>
+	static bool number(const char *&p, const char *end, T &value) {
+		if (p < end && *p == '+') {
+			p++;
+		}
+
+		auto result = std::from_chars(p, end, value);
+
+		if (result.ec != std::errc()) {
+			return false;
+		}
+
+		p = result.ptr;
+
+		return true;
+	}
+
+	template<typename T>
+	static bool numbers(const char *&p, const char *end, T *values, int required, int count) {
+		for (int i = 0; i < count; i++) {
+			p = skip_space(p, end);
+
+			if (p == end && i >= required) {
+				return true;
+			}
+
+			if (!number(p, end, values[i]) || (p < end && !is_space(*p))) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Checks a 1-based or negative relative index against the elements defined so far
+	static bool index(const char *&p, const char *end, size_t before, size_t total) {
+		long long value;
+
+		if (!number(p, end, value) || value == 0) {
+			return false;
+		}
+
+		if (value > 0) {
+			return (unsigned long long)value <= total;
+		}
+
+		return (unsigned long long)-value <= before;
+	}
+
+	static bool face(const char *p, const char *end, const Counts &before, const Counts &total) {
+		int corners = 0;
+
+		for (p = skip_space(p, end); p < end; p = skip_space(p, end)) {
+			if (!index(p, end, before.vertices, total.vertices)) {
+				return false;
+			}
+
+			if (p < end && *p == '/') {
+				p++;
+
+				if (p < end && *p != '/' && !index(p, end, before.uv, total.uv)) {
+					return false;
+				}
+
+				if (p < end && *p == '/') {
+					p++;
+
+					if (!index(p, end, before.normals, total.normals)) {
+						return false;
+					}
+				}
+			}
+
+			if (p < end && !is_space(*p)) {
+				return false;
+			}
+
+			corners++;
+		}
+
+		return corners >= 3;
+	}
+
+	void count(Chunk &chunk) {
+		for (const char *p = chunk.begin; p < chunk.end;) {
+			const char *end = line_end(p, chunk.end);
+
+			switch (element(p, end)) {
+				case Element::Vertex:
+					chunk.counts.vertices++;
+					break;
+				case Element::UV:
+					chunk.counts.uv++;
+					break;
+				case Element::Normal:
+					chunk.counts.normals++;
+					break;
+				case Element::Face:
+					chunk.counts.faces++;
+					break;
+				default:
+					break;
+			}
+
+			chunk.counts.lines++;
+			p = end < chunk.end ? end + 1 : end;
+		}
+	}
+
+	void parse(Chunk &chunk, const Target &target) {
+		Counts at = chunk.first;
+
+		for (const char *p = chunk.begin; p < chunk.end;) {
+			const char *end = line_end(p, chunk.end);
+
+			float values[3] = { 0.0f, 0.0f, 0.0f };
+			double coords[2] = { 0.0, 0.0 };
+			bool valid = true;
+
+			switch (element(p, end)) {
+				case Element::Vertex:
+					valid = numbers(p, end, values, 3, 3);
+
+					if (valid && !target.vertices.empty()) {
+						target.vertices[at.vertices] = Vector3(values[0], values[1], values[2]);
+					}
+
+					at.vertices++;
+					break;
+				case Element::UV:
+					// Flipped in double precision like the writer, so coordinates survive a round trip exactly
+					valid = numbers(p, end, coords, 1, 2);
+
+					if (valid && !target.uv.empty()) {
+						auto &uv = target.uv[at.uv];
+						uv.u = (float)coords[0];
+						uv.v = (float)(1.0 - coords[1]);
+					}
+
+					at.uv++;
+					break;
+				case Element::Normal:
+					valid = numbers(p, end, values, 3, 3);
+
+					if (valid && !target.normals.empty()) {
+						target.normals[at.normals] = Vector3(values[0], values[1], values[2]);
+					}
+
+					at.normals++;
+					break;
+				case Element::Face:
+					valid = face(p, end, at, totals);
+					at.faces++;
+					break;
+				default:
+					break;
+			}
+
+			if (!valid) {
+				chunk.error = fmt::format("Malformed line {}.", at.lines + 1);
+
+				return;
+			}
+
+			at.lines++;
+			p = end < chunk.end ? end + 1 : end;
+		}
+	}
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/compile.h>
+#include <fmt/format.h>
+
+#include <NifFile.h>
+#include <ParallelFor.h>
+
+// Formats OBJ text into a reusable buffer and writes it to the stream in large chunks.
+// With more than one thread, long v/vt/vn/f sections are cut into blocks that are
+// formatted in parallel and written in order, a group of blocks at a time.
+class ObjWriter {
+public:
+	static constexpr size_t chunk_size = 1 << 20;
+	static constexpr size_t block_size = 1 << 15;
+
+	explicit ObjWriter(std::ostream &stream, unsigned int threads = 1) : stream(stream), threads(threads) {
+		if (this->threads == 0) {
+			this->threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		buffer.reserve(chunk_size + 256);
+
+		if (this->threads > 1) {
+			blocks.resize(this->threads);
+		}
+	}
+
+	~ObjWriter() {
+		flush();
+	}
+
+	void header(size_t num_vertices, size_t num_uv, size_t num_normals, size_t num_faces) {
+		fmt::format_to(std::back_inserter(buffer),
+				"# NifHacks 0.2\n\n"
+				"# {} Vertices\n"
+				"# {} Texture coordinates\n"
+				"# {} Normals\n"
+				"# {} Faces\n",
+				num_vertices,
+				num_uv,
+				num_normals,
+				num_faces);
+	}
+
+	// Writes one object, face indices continue after the elements of earlier objects
+	void object(const std::string &name,
+			StridedSpan<const Vector3> vertices,
+			StridedSpan<const Vector2> uv,
+			StridedSpan<const Vector3> normals,
+			const std::vector<Triangle> &faces) {
+		if (!name.empty()) {
+			fmt::format_to(std::back_inserter(buffer), "\no {}\n\n", name);
+		}
+
+		section(vertices.size(), [&](fmt::memory_buffer &out, size_t i) {
+			auto &v = vertices[i];
+			fmt::format_to(std::back_inserter(out), FMT_COMPILE("v {} {} {}\n"), v.x, v.y, v.z);
+		});
+
+		append("\n");
+
+		if (!uv.empty()) {
+			section(uv.size(), [&](fmt::memory_buffer &out, size_t i) {
+				auto &p = uv[i];
+				fmt::format_to(std::back_inserter(out), FMT_COMPILE("vt {} {}\n"), p.u, 1.0 - p.v);
+			});
+
+			append("\n");
+		}
+
+		if (!normals.empty()) {
+			section(normals.size(), [&](fmt::memory_buffer &out, size_t i) {
+				auto &n = normals[i];
+				fmt::format_to(std::back_inserter(out), FMT_COMPILE("vn {} {} {}\n"), n.x, n.y, n.z);
+			});
+
+			append("\n");
+		}
+
+		size_t v = vertices_written + 1;
+		size_t t = uv_written + 1;
+		size_t n = normals_written + 1;
+
+		bool has_uv = !uv.empty();
+		bool has_normals = !normals.empty();
+
+		section(faces.size(), [&](fmt::memory_buffer &out, size_t i) {
+			auto &f = faces[i];
+
+			out.push_back('f');
+			corner(out, f.p1, v, t, n, has_uv, has_normals);
+			corner(out, f.p2, v, t, n, has_uv, has_normals);
+			corner(out, f.p3, v, t, n, has_uv, has_normals);
+			out.push_back('\n');
+		});
+
+		append("\n");
+
+		vertices_written += vertices.size();
+		uv_written += uv.size();
+		normals_written += normals.size();
+	}
+
+	void flush() {
+		if (buffer.size() > 0) {
+			stream.write(buffer.data(), buffer.size());
+			buffer.clear();
+		}
+	}
+
+private:
+	std::ostream &stream;
+	unsigned int threads;
+
+	fmt::memory_buffer buffer;
+	std::vector<fmt::memory_buffer> blocks;
+
+	size_t vertices_written = 0;
+	size_t uv_written = 0;
+	size_t normals_written = 0;
+
+	void append(const std::string &text) {
+		buffer.append(text.data(), text.data() + text.size());
+	}
+
+	static void index(fmt::memory_buffer &out, size_t value) {
+		fmt::format_int formatted(value);
+		out.append(formatted.data(), formatted.data() + formatted.size());
+	}
+
+	// One "v", "v/vt", "v//vn" or "v/vt/vn" corner of a face
+	static void corner(fmt::memory_buffer &out, size_t p, size_t v, size_t t, size_t n, bool has_uv, bool has_normals) {
+		out.push_back(' ');
+		index(out, p + v);
+
+		if (has_uv) {
+			out.push_back('/');
+			index(out, p + t);
+		}
+
+		if (has_normals) {
+			if (!has_uv) {
+				out.push_back('/');
+			}
+
+			out.push_back('/');
+			index(out, p + n);
+		}
+	}
+
+	template<typename Format>
+	void section(size_t count, Format &&format) {
+		if (threads == 1 || count < block_size * 2) {
+			for (size_t i = 0; i < count; i++) {
+				format(buffer, i);
+
+				if (buffer.size() >= chunk_size) {
+					flush();
+				}
+			}
+
+			return;
+		}
+
+		flush();
+
+		size_t num_blocks = (count + block_size - 1) / block_size;
+
+		for (size_t first = 0; first < num_blocks; first += blocks.size()) {
+			size_t group = std::min(blocks.size(), num_blocks - first);
+
+			ParallelFor(group, threads, [&](const size_t b, const unsigned int) {
+				auto &out = blocks[b];
+				out.clear();
+
+				size_t begin = (first + b) * block_size;
+				size_t end = std::min(count, begin + block_size);
+
+				for (size_t i = begin; i < end; i++) {
+					format(out, i);
+				}
+			});
+
+			for (size_t b = 0; b < group; b++) {
+				stream.write(blocks[b].data(), blocks[b].size());
+			}
+		}
+	}
+};